@@ -0,0 +1,204 @@
+/*
+ * vmieventlog.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#include "vmiids/modules/notification/EventLogFormat.h"
+#include "vmiids/util/MappedFile.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Severity names as used in the configuration file. The index is the severity.
+ */
+static const char *severityNames[] = { "DEBUG", "INFO", "WARN", "ERROR", "CRITICAL", "ALERT" };
+/**
+ * Severity prefixes as written by the text based NotificationModules.
+ */
+static const char *severityPrefix[] = {
+		"Debug:       ", "Information: ", "Warning:     ",
+		"Error:       ", "Critical:    ", "Alert:       " };
+#define SEVERITY_COUNT 6
+
+static void usage(const char *name){
+	printf("usage: %s [-m module] [-s severity] [-f from] [-t to] [-r run] <directory>\n", name);
+	printf("  -m module    Only show records of this module.\n");
+	printf("  -s severity  Only show records of at least this severity (DEBUG ... ALERT).\n");
+	printf("  -f from      Only show records not older than this time (seconds since epoch).\n");
+	printf("  -t to        Only show records not newer than this time (seconds since epoch).\n");
+	printf("  -r run       Only show records of this run ID.\n");
+	exit(1);
+}
+
+/**
+ * Find the offset to start reading a segment at.
+ * Skips all records, which are known to be older than from.
+ */
+static uint64_t findStartOffset(const std::string &directory, uint32_t sequence,
+		uint64_t headerSize, uint64_t from){
+	vmi::MappedFile index;
+	if (from == 0 || !index.open(eventLogFileName(directory, sequence, "idx")) ||
+			index.getData() == NULL) {
+		return headerSize;
+	}
+	const EventLogIndexEntry *entries = (const EventLogIndexEntry *) index.getData();
+	size_t count = index.getSize() / sizeof(EventLogIndexEntry);
+
+	// maxTime is not decreasing. Find the last entry with maxTime < from.
+	size_t lower = 0;
+	size_t upper = count;
+	while (lower < upper) {
+		size_t middle = (lower + upper) / 2;
+		if (entries[middle].maxTime < from) {
+			lower = middle + 1;
+		} else {
+			upper = middle;
+		}
+	}
+	return (lower == 0) ? headerSize : entries[lower - 1].offset;
+}
+
+int
+main (int argc, char *argv[])
+{
+	std::string moduleFilter;
+	int minSeverity = 0;
+	uint64_t from = 0;
+	uint64_t to = (uint64_t) -1;
+	bool runFilter = false;
+	uint32_t runId = 0;
+
+	int option;
+	while ((option = getopt(argc, argv, "m:s:f:t:r:")) != -1) {
+		switch (option) {
+		case 'm':
+			moduleFilter = optarg;
+			break;
+		case 's':
+			for (minSeverity = 0; minSeverity < SEVERITY_COUNT; minSeverity++) {
+				if (strcasecmp(optarg, severityNames[minSeverity]) == 0) break;
+			}
+			if (minSeverity == SEVERITY_COUNT) usage(argv[0]);
+			break;
+		case 'f':
+			from = strtoull(optarg, NULL, 10) * 1000000;
+			break;
+		case 't':
+			to = strtoull(optarg, NULL, 10) * 1000000 + 999999;
+			break;
+		case 'r':
+			runFilter = true;
+			runId = strtoul(optarg, NULL, 10);
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (optind + 1 != argc) {
+		usage(argv[0]);
+	}
+	std::string directory = argv[optind];
+
+	// Read the module table.
+	std::vector<std::string> moduleNames;
+	FILE *modules = fopen((directory + "/" + EVENTLOG_MODULEFILE).c_str(), "r");
+	if (modules != NULL) {
+		unsigned int id;
+		char name[256];
+		while (fscanf(modules, "%u %255s", &id, name) == 2) {
+			if (id >= EVENTLOG_UNKNOWN_MODULE) continue;
+			if (id >= moduleNames.size()) moduleNames.resize(id + 1);
+			moduleNames[id] = name;
+		}
+		fclose(modules);
+	}
+	uint32_t moduleId = EVENTLOG_UNKNOWN_MODULE;
+	if (!moduleFilter.empty()) {
+		std::vector<std::string>::iterator it = std::find(moduleNames.begin(), moduleNames.end(), moduleFilter);
+		if (it == moduleNames.end()) {
+			// The module never logged anything.
+			return 0;
+		}
+		moduleId = it - moduleNames.begin();
+	}
+
+	// Find all segments.
+	std::vector<uint32_t> segments;
+	DIR *dir = opendir(directory.c_str());
+	if (dir == NULL) {
+		perror(directory.c_str());
+		return 1;
+	}
+	struct dirent *entry;
+	uint32_t sequence;
+	while ((entry = readdir(dir)) != NULL) {
+		if (eventLogParseSegmentName(entry->d_name, sequence)) {
+			segments.push_back(sequence);
+		}
+	}
+	closedir(dir);
+	std::sort(segments.begin(), segments.end());
+
+	uint32_t severityMask = ~((1u << minSeverity) - 1);
+	vmi::MappedFile segment;
+	for (std::vector<uint32_t>::iterator it = segments.begin(); it != segments.end(); ++it) {
+		if (!segment.open(eventLogFileName(directory, *it, "log")) ||
+				segment.getSize() < sizeof(EventLogSegmentHeader)) {
+			continue;
+		}
+		const EventLogSegmentHeader *header = (const EventLogSegmentHeader *) segment.getData();
+		if (memcmp(header->magic, EVENTLOG_MAGIC, sizeof(header->magic)) != 0 ||
+				header->version != EVENTLOG_VERSION) {
+			std::cerr << "Skipping invalid segment " << *it << std::endl;
+			continue;
+		}
+		// Skip whole segments by their summary.
+		if (header->recordCount == 0 || (header->severityMask & severityMask) == 0 ||
+				header->lastTime < from || header->firstTime > to) {
+			continue;
+		}
+
+		uint64_t dataEnd = std::min<uint64_t>(header->dataEnd, segment.getSize());
+		uint64_t offset = findStartOffset(directory, *it, header->headerSize, from);
+		while (offset + sizeof(EventLogRecordHeader) <= dataEnd) {
+			const EventLogRecordHeader *record = (const EventLogRecordHeader *) (segment.getData() + offset);
+			if (record->length < sizeof(EventLogRecordHeader) || offset + record->length > dataEnd) {
+				std::cerr << "Corrupted record in segment " << *it << std::endl;
+				break;
+			}
+			offset += record->length;
+
+			if (record->severity < minSeverity || record->severity >= SEVERITY_COUNT ||
+					record->time < from || record->time > to ||
+					(moduleId != EVENTLOG_UNKNOWN_MODULE && record->moduleId != moduleId) ||
+					(runFilter && record->runId != runId)) {
+				continue;
+			}
+
+			char timeString[32];
+			time_t seconds = record->time / 1000000;
+			struct tm localTime;
+			strftime(timeString, sizeof(timeString), "%Y-%m-%d %H:%M:%S", localtime_r(&seconds, &localTime));
+			printf("%s.%06u [%u] %s%s: ", timeString, (unsigned int) (record->time % 1000000), record->runId,
+					severityPrefix[record->severity],
+					(record->moduleId < moduleNames.size()) ? moduleNames[record->moduleId].c_str() : "?");
+			fwrite(record + 1, 1, record->payloadLength, stdout);
+			if (record->payloadLength == 0 || ((const char *) (record + 1))[record->payloadLength - 1] != '\n') {
+				putchar('\n');
+			}
+		}
+	}
+
+	return 0;
+}
@@ -6,26 +6,231 @@
  */
 
 #include "vmiids/rpc/RpcClient.h"
+#include "vmiids/modules/notification/EventStreamFormat.h"
 #include <iostream>
+#include <map>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/**
+ * Severity names as used in the configuration file. The index is the severity.
+ */
+static const char *severityNames[] = { "DEBUG", "INFO", "WARN", "ERROR", "CRITICAL", "ALERT" };
+#define SEVERITY_COUNT 6
+
+#define DEFAULT_SCHEDULE 60  //!< Schedule (in s) used by the a and d commands, if none is given.
+
+/**
+ * Read exactly length bytes from a socket.
+ */
+static bool readFully(int fd, void *buffer, size_t length){
+	size_t done = 0;
+	while (done < length) {
+		ssize_t received = read(fd, (char *) buffer + done, length - done);
+		if (received <= 0) return false;
+		done += received;
+	}
+	return true;
+}
+
+/**
+ * Subscribe to the EventStreamNotificationModule and print the events until the IDS stops.
+ */
+static int watchEvents(const char *severity, const char *modules){
+	EventStreamSubscription subscription;
+	memset(&subscription, 0, sizeof(subscription));
+	memcpy(subscription.magic, EVENTSTREAM_MAGIC, sizeof(subscription.magic));
+	subscription.version = EVENTSTREAM_VERSION;
+	if (severity != NULL) {
+		while (subscription.minSeverity < SEVERITY_COUNT &&
+				strcasecmp(severity, severityNames[subscription.minSeverity]) != 0) {
+			subscription.minSeverity++;
+		}
+		if (subscription.minSeverity == SEVERITY_COUNT) {
+			printf("Unknown severity %s\n", severity);
+			return 1;
+		}
+	}
+	subscription.moduleLength = (modules != NULL) ? strlen(modules) : 0;
+
+	const char *path = getenv("VMIIDS_EVENTSTREAM");
+	if (path == NULL) path = EVENTSTREAM_DEFAULT_SOCKET;
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0 || connect(fd, (struct sockaddr *) &address, sizeof(address)) != 0 ||
+			write(fd, &subscription, sizeof(subscription)) != sizeof(subscription) ||
+			(modules != NULL && write(fd, modules, subscription.moduleLength) != (ssize_t) subscription.moduleLength)) {
+		perror(path);
+		return 1;
+	}
+
+	EventStreamFrameHeader header;
+	std::string payload;
+	while (readFully(fd, &header, sizeof(header))) {
+		if (header.length < sizeof(header)) break;
+		payload.resize(header.length - sizeof(header));
+		if (!payload.empty() && !readFully(fd, &payload[0], payload.size())) break;
+
+		if (header.type == EVENTSTREAM_DROPPED) {
+			printf("%u events dropped\n", header.messageLength);
+			continue;
+		}
+		if (header.type != EVENTSTREAM_EVENT || header.severity >= SEVERITY_COUNT ||
+				(size_t) header.moduleLength + header.messageLength > payload.size()) {
+			continue;
+		}
+		char timeString[32];
+		time_t seconds = header.time / 1000000;
+		struct tm localTime;
+		strftime(timeString, sizeof(timeString), "%H:%M:%S", localtime_r(&seconds, &localTime));
+		printf("%s [%u] %-8s %.*s: %.*s\n", timeString, header.runId, severityNames[header.severity],
+				(int) header.moduleLength, payload.data(),
+				(int) header.messageLength, payload.data() + header.moduleLength);
+		fflush(stdout);
+	}
+	close(fd);
+	return 0;
+}
+
+/**
+ * Run DetectionModules in parallel and print their output while they run.
+ */
+static void runDetectionModules(int count, char *modules[]){
+	std::map<uint32_t, std::string> jobs;
+	for (int i = 0; i < count; i++) {
+		uint32_t jobId = vmi::RpcClient::getInstance()->submitDetectionModule(modules[i]);
+		if (jobId == 0) {
+			printf("Could not run module %s\n", modules[i]);
+			continue;
+		}
+		printf("Run module %s (job %u)\n", modules[i], jobId);
+		jobs[jobId] = modules[i];
+	}
+	while (!jobs.empty()) {
+		// Query all jobs in one round trip.
+		std::vector<uint32_t> jobIds;
+		std::vector<int> states;
+		std::vector<std::string> outputs;
+		for (std::map<uint32_t, std::string>::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+			jobIds.push_back(it->first);
+		}
+		vmi::RpcClient::getInstance()->getJobResults(jobIds, states, outputs);
+		for (size_t i = 0; i < jobIds.size(); i++) {
+			std::cout << outputs[i] << std::flush;
+			if (states[i] == vmi::JOB_PENDING || states[i] == vmi::JOB_RUNNING) {
+				continue;
+			}
+			if (states[i] != vmi::JOB_FINISHED) {
+				printf("Module %s failed\n", jobs[jobIds[i]].c_str());
+			}
+			jobs.erase(jobIds[i]);
+		}
+		if (!jobs.empty()) usleep(100000);
+	}
+}
+
+/**
+ * Print the runtime counters of a module or schedule.
+ */
+static void printRuntimeStatus(const vmi::rpcRuntimeStatus &runs){
+	printf("runs %u, failed %u, waiting %u, running %u, last %.1f ms, avg %.1f ms, p99 %.1f ms\n",
+			runs.runs, runs.failures, runs.waiting, runs.running, runs.lastRuntime / 1000.0,
+			runs.averageRuntime / 1000.0, runs.p99Runtime / 1000.0);
+}
+
+/**
+ * Print a status snapshot of the framework.
+ */
+static int printStatus(){
+	vmi::rpcStatus status;
+	try {
+		vmi::RpcClient::getInstance()->getStatus(status);
+	} catch (vmi::RpcException &e) {
+		e.printException();
+		return 1;
+	}
+	printf("Global threat level: %.3f\n", status.globalThreatLevel);
+	for (size_t i = 0; i < status.schedules.size(); i++) {
+		const vmi::rpcScheduleStatus &schedule = status.schedules[i];
+		long next = (long) ((int64_t) (schedule.nextRun - status.time) / 1000000);
+		printf("Schedule %us%s: threat level %.3f, next run in %lds, overruns %u\n  ",
+				schedule.seconds, schedule.paused ? " (paused)" : "", schedule.threatLevel,
+				(next > 0) ? next : 0, schedule.overruns);
+		printRuntimeStatus(schedule.rounds);
+		for (size_t j = 0; j < schedule.modules.size(); j++) {
+			printf("  %s\n", schedule.modules[j].c_str());
+		}
+	}
+	for (size_t i = 0; i < status.modules.size(); i++) {
+		const vmi::rpcModuleStatus &module = status.modules[i];
+		if (module.reported) {
+			printf("Module %s: threat level %.3f (%lus ago)\n  ", module.name.c_str(), module.threatLevel,
+					(unsigned long) ((status.time - module.threatLevelTime) / 1000000));
+		} else {
+			printf("Module %s: no threat level\n  ", module.name.c_str());
+		}
+		printRuntimeStatus(module.runs);
+	}
+	for (size_t i = 0; i < status.sensors.size(); i++) {
+		printf("Sensor %s\n", status.sensors[i].c_str());
+	}
+	return 0;
+}
 
 int
 main (int argc, char *argv[])
 {
 	if (argc < 2) {
-		printf ("usage: %s [a|d|l|s] <Module>\n", argv[0]);
+		printf ("usage: %s [a|d] <Module> [<Seconds>]\n", argv[0]);
+		printf ("       %s [r|l|s|t|i|h] <Module> [<Module> ...]\n", argv[0]);
+		printf ("       %s c <Seconds> [<Module> ...]\n", argv[0]);
+		printf ("       %s [x|p|u] <Seconds>\n", argv[0]);
+		printf ("       %s m <Seconds> <NewSeconds>\n", argv[0]);
+		printf ("       %s w [<Severity> [<Module>,...]]\n", argv[0]);
 		exit (1);
 	}
 	char *module = argv[2];
+	uint32_t seconds = (argc > 2) ? strtoul(argv[2], NULL, 10) : 0;
 
-	if( argv[1][0] == 'a'){
-		printf("Adding module %s\n", module);
-		vmi::RpcClient::getInstance()->enqueueDetectionModule(module);
-	} else if(argv[1][0] == 'd'){
-		printf("Deleting module %s\n", module);
-		vmi::RpcClient::getInstance()->dequeueDetectionModule(module);
+	if( argv[1][0] == 'a' || argv[1][0] == 'd'){
+		seconds = (argc > 3) ? strtoul(argv[3], NULL, 10) : DEFAULT_SCHEDULE;
+		bool success;
+		if (argv[1][0] == 'a') {
+			printf("Adding module %s to the %us schedule\n", module, seconds);
+			success = vmi::RpcClient::getInstance()->enqueueDetectionModule(module, seconds);
+		} else {
+			printf("Deleting module %s from the %us schedule\n", module, seconds);
+			success = vmi::RpcClient::getInstance()->dequeueDetectionModule(module, seconds);
+		}
+		if (!success) {
+			printf("Failed\n");
+			return 1;
+		}
+	} else if(argv[1][0] == 'c'){
+		std::vector<std::string> modules(argv + 3, argv + argc);
+		printf("Creating the %us schedule\n", seconds);
+		return vmi::RpcClient::getInstance()->addSchedule(seconds, modules) ? 0 : 1;
+	} else if(argv[1][0] == 'x'){
+		printf("Removing the %us schedule\n", seconds);
+		return vmi::RpcClient::getInstance()->removeSchedule(seconds) ? 0 : 1;
+	} else if(argv[1][0] == 'm' && argc > 3){
+		printf("Changing the %us schedule to %lus\n", seconds, strtoul(argv[3], NULL, 10));
+		return vmi::RpcClient::getInstance()->retimeSchedule(seconds, strtoul(argv[3], NULL, 10)) ? 0 : 1;
+	} else if(argv[1][0] == 'p' || argv[1][0] == 'u'){
+		printf("%s the %us schedule\n", (argv[1][0] == 'p') ? "Pausing" : "Resuming", seconds);
+		return vmi::RpcClient::getInstance()->pauseSchedule(seconds, argv[1][0] == 'p') ? 0 : 1;
 	} else if(argv[1][0] == 'r'){
-		printf("Run module %s\n", module);
-		std::cout << vmi::RpcClient::getInstance()->runSingleDetectionModule(module);
+		runDetectionModules(argc - 2, argv + 2);
 	} else if(argv[1][0] == 'l'){
 		printf("Loading shared object %s\n", module);
 		if(vmi::RpcClient::getInstance()->loadSharedObject(module)){
@@ -38,10 +243,19 @@ main (int argc, char *argv[])
 		std::list<std::string> detectionModules =
 				vmi::RpcClient::getInstance()->getListOfDetectionModules();
 		while(!detectionModules.empty()){
-			std::cout << detectionModules.front();
+			std::cout << detectionModules.front() << std::endl;
 			detectionModules.pop_front();
 		}
 		printf("Done\n");
+	} else if(argv[1][0] == 't'){
+		std::cout << vmi::RpcClient::getInstance()->getThreatLevel();
+	} else if(argv[1][0] == 'h'){
+		printf("Reloading the configuration\n");
+		return vmi::RpcClient::getInstance()->reloadConfiguration() ? 0 : 1;
+	} else if(argv[1][0] == 'i'){
+		return printStatus();
+	} else if(argv[1][0] == 'w'){
+		return watchEvents((argc > 2) ? argv[2] : NULL, (argc > 3) ? argv[3] : NULL);
 	} else printf("Unknown task\n");
 
 	return 0;
@@ -7,6 +7,12 @@
 
 #include "DetectionModuleWidget.h"
 
+#include "vmiids/rpc/RpcClient.h"
+
+#include <vector>
+
+#define JOB_POLL_INTERVAL 200  //!< Time (in ms) between two polls of the running jobs.
+
 DetectionModuleWidget::DetectionModuleWidget(QWidget *parent) : QWidget(parent) {
 	QVBoxLayout *layout = new QVBoxLayout();
 
@@ -22,11 +28,23 @@ DetectionModuleWidget::DetectionModuleWidget(QWidget *parent) : QWidget(parent)
 	layout->addWidget(deleteButton);
 	QObject::connect(deleteButton, SIGNAL(clicked()), this, SLOT(deleteClicked()));
 
+	QPushButton* runButton = new QPushButton(tr("run", "&Run"));
+	layout->addWidget(runButton);
+	QObject::connect(runButton, SIGNAL(clicked()), this, SLOT(runClicked()));
+
 	m_plv = new QListWidget(this);
+	m_plv->setSelectionMode(QAbstractItemView::ExtendedSelection);
 	m_plv->addItems(this->getListOfDetectionModules());
 	m_plv->sortItems();
 	layout->addWidget(m_plv);
 
+	m_output = new QTextEdit(this);
+	m_output->setReadOnly(true);
+	layout->addWidget(m_output);
+
+	m_pollTimer = new QTimer(this);
+	QObject::connect(m_pollTimer, SIGNAL(timeout()), this, SLOT(pollJobs()));
+
 	this->setLayout(layout);
 
 }
@@ -53,6 +71,64 @@ void DetectionModuleWidget::deleteClicked() {
 	m_plv->takeItem(m_plv->currentRow());
 }
 
+void DetectionModuleWidget::appendOutput(const QString &text) {
+	m_output->moveCursor(QTextCursor::End);
+	m_output->insertPlainText(text);
+	m_output->moveCursor(QTextCursor::End);
+}
+
+void DetectionModuleWidget::runClicked() {
+	QList<QListWidgetItem *> items = m_plv->selectedItems();
+	for (int i = 0; i < items.size(); i++) {
+		QString module = items[i]->text();
+		try {
+			uint32_t jobId = vmi::RpcClient::getInstance()->submitDetectionModule(module.toStdString());
+			if (jobId == 0) {
+				appendOutput(tr("Could not run module %1\n").arg(module));
+				continue;
+			}
+			m_jobs[jobId] = module;
+			items[i]->setBackground(QBrush(Qt::yellow));
+		} catch (vmi::RpcException &e) {
+			appendOutput(tr("Could not connect to VmiIDS\n"));
+			return;
+		}
+	}
+	if (!m_jobs.isEmpty() && !m_pollTimer->isActive()) {
+		m_pollTimer->start(JOB_POLL_INTERVAL);
+	}
+}
+
+void DetectionModuleWidget::pollJobs() {
+	// Query all jobs in one round trip.
+	std::vector<uint32_t> jobIds;
+	std::vector<int> states;
+	std::vector<std::string> outputs;
+	for (QMap<uint32_t, QString>::iterator it = m_jobs.begin(); it != m_jobs.end(); ++it) {
+		jobIds.push_back(it.key());
+	}
+	try {
+		vmi::RpcClient::getInstance()->getJobResults(jobIds, states, outputs);
+	} catch (vmi::RpcException &e) {
+		states.assign(jobIds.size(), vmi::JOB_UNKNOWN);
+		outputs.assign(jobIds.size(), std::string());
+	}
+	for (size_t j = 0; j < jobIds.size(); j++) {
+		appendOutput(QString::fromStdString(outputs[j]));
+		if (states[j] == vmi::JOB_PENDING || states[j] == vmi::JOB_RUNNING) {
+			continue;
+		}
+		QList<QListWidgetItem *> items = m_plv->findItems(m_jobs[jobIds[j]], Qt::MatchExactly);
+		for (int i = 0; i < items.size(); i++) {
+			items[i]->setBackground(QBrush((states[j] == vmi::JOB_FINISHED) ? Qt::green : Qt::red));
+		}
+		m_jobs.remove(jobIds[j]);
+	}
+	if (m_jobs.isEmpty()) {
+		m_pollTimer->stop();
+	}
+}
+
 QStringList DetectionModuleWidget::getListOfDetectionModules(){
 	QStringList stringList;
 	stringList.append("ProcessListDetectionModule");
@@ -10,12 +10,23 @@
 
 #include <QtGui>
 
+#include <stdint.h>
+
+/**
+ * Widget listing DetectionModules. Selected modules can be run in parallel,
+ * their output is shown while they run.
+ */
 class DetectionModuleWidget: public QWidget {
 	Q_OBJECT
 
 private:
 	QListWidget* m_plv;
 	QLineEdit* m_ple;
+	QTextEdit* m_output;          //!< Output of the running modules.
+	QTimer* m_pollTimer;          //!< Polls the running jobs.
+	QMap<uint32_t, QString> m_jobs;  //!< Running jobs and the names of their modules.
+
+	void appendOutput(const QString &text);
 
 	QStringList getListOfDetectionModules();
 
@@ -26,6 +37,8 @@ public:
 public slots:
 	void insertClicked(void);
 	void deleteClicked(void);
+	void runClicked(void);
+	void pollJobs(void);
 
 };
 
@@ -6,45 +6,122 @@
  */
 
 #include "DetectionModule.h"
+#include "ThreatLevelService.h"
 
 #include "vmiids/util/MutexLocker.h"
 
+#include <algorithm>
+
 namespace vmi {
 
-std::map<std::string, vmi::DetectionModule *> vmi::DetectionModule::modules;
-vmi::Mutex vmi::DetectionModule::mutex;
+vmi::SnapshotRegistry<std::string, vmi::DetectionModule> vmi::DetectionModule::modules;
+vmi::HandleTable<vmi::DetectionModule> vmi::DetectionModule::handles;
 
 vmi::DetectionModule::DetectionModule(std::string moduleName) :
 	vmi::Module(moduleName), vmi::OutputModule(moduleName) {
 	threatLevel = false;
+	pins = 0;
 
 	debug << "Loading Module" << std::endl;
 
-	mutex.lock();
-	modules[moduleName] = this;
-	mutex.unlock();
+	handle = handles.acquire(this);
+	if (!handle.isValid()) {
+		warn << "Too many modules loaded, module can not be scheduled" << std::endl;
+	}
+	modules.insert(moduleName, this);
 }
 ;
 
 vmi::DetectionModule::~DetectionModule() {
 	debug << "Unloading Module" << std::endl;
-	vmi::MutexLocker lock(&mutex);
-	for (std::map<std::string, DetectionModule*>::iterator it =
-			this->modules.begin(); it != this->modules.end(); ++it) {
-		if (it->first.compare(this->getName()) == 0) {
-			this->modules.erase(it);
-		}
+	this->unload();
+	ThreatLevelService::removeModule(handle);
+}
+
+void vmi::DetectionModule::unload() {
+	handles.release(handle);
+	{
+		// Publishing a snapshot waits for all read sections, including pin() calls,
+		// which resolved the handle before it was released.
+		SnapshotRegistry<std::string, DetectionModule>::Writer writer(modules);
+		writer.erase(this->getName(), this);
+		writer.commit();
+	}
+	while (this->pins != 0) {
+		Thread::sleep(10);
 	}
 }
 ;
 
 vmi::DetectionModule *vmi::DetectionModule::getDetectionModule(
 		std::string moduleName) {
-	vmi::MutexLocker lock(&mutex);
-	if (modules.find(moduleName) == modules.end()) {
-		return NULL;
+	return modules.find(moduleName);
+}
+
+vmi::DetectionModule *vmi::DetectionModule::getDetectionModule(
+		const DetectionModuleHandle &handle) {
+	return handles.resolve(handle);
+}
+
+vmi::DetectionModule *vmi::DetectionModule::pin(
+		const DetectionModuleHandle &handle) {
+	SnapshotRegistry<std::string, DetectionModule>::Reader reader(modules);
+	DetectionModule *module = handles.resolve(handle);
+	if (module != NULL) {
+		__sync_add_and_fetch(&module->pins, 1);
+	}
+	return module;
+}
+
+void vmi::DetectionModule::unpin() {
+	__sync_sub_and_fetch(&this->pins, 1);
+}
+
+vmi::DetectionModuleHandle vmi::DetectionModule::getDetectionModuleHandle(
+		std::string moduleName) {
+	if (modules.find(moduleName) == NULL) {
+		ModuleRegistry::getInstance()->activate(moduleName);
 	}
-	return modules[moduleName];
+	SnapshotRegistry<std::string, DetectionModule>::Reader reader(modules);
+	DetectionModule *module = reader.find(moduleName);
+	if (module == NULL) {
+		return DetectionModuleHandle();
+	}
+	return module->handle;
+}
+
+bool vmi::DetectionModule::isDetectionModule(std::string moduleName) {
+	if (modules.find(moduleName) != NULL) {
+		return true;
+	}
+	std::list<std::string> registered =
+			ModuleRegistry::getInstance()->getModuleNames(MODULE_DETECTION);
+	return std::find(registered.begin(), registered.end(), moduleName) != registered.end();
+}
+
+const vmi::DetectionModuleHandle &vmi::DetectionModule::getHandle() const {
+	return handle;
+}
+
+bool vmi::DetectionModule::execute() {
+	statistics.enter();
+	vmi::MutexLocker lock(&runMutex);
+	uint64_t start = RuntimeStatistics::now();
+	statistics.start(start);
+	this->start();
+	this->join();
+	bool failed = this->hasFailed();
+	statistics.finish(start, RuntimeStatistics::now(), failed);
+	return !failed;
+}
+
+const vmi::RuntimeStatistics &vmi::DetectionModule::getStatistics() const {
+	return statistics;
+}
+
+bool vmi::DetectionModule::applyConfiguration(const std::set<std::string> &options) {
+	vmi::MutexLocker lock(&runMutex);
+	return this->reconfigure(options);
 }
 
 float vmi::DetectionModule::getThreatLevel() {
@@ -52,31 +129,41 @@ float vmi::DetectionModule::getThreatLevel() {
 }
 
 void vmi::DetectionModule::killInstances() {
-	while (!modules.empty()) {
-		delete modules.begin()->second;
+	while (true) {
+		DetectionModule *module;
+		{
+			SnapshotRegistry<std::string, DetectionModule>::Reader reader(modules);
+			if (reader.getEntries().empty()) {
+				break;
+			}
+			module = reader.getEntries().front().second;
+		}
+		module->unload();
+		delete module;
 	}
 }
 
 std::list<std::string> vmi::DetectionModule::getListOfDetectionModules() {
-	vmi::MutexLocker lock(&mutex);
-	std::list<std::string> detectionModules;
-	for (std::map<std::string, DetectionModule*>::iterator it =
-		modules.begin(); it != modules.end(); ++it) {
-		detectionModules.push_back(it->first);
+	// Registered modules are constructed on their first use.
+	std::list<std::string> registered =
+			ModuleRegistry::getInstance()->getModuleNames(MODULE_DETECTION);
+	std::set<std::string> detectionModules(registered.begin(), registered.end());
+	{
+		SnapshotRegistry<std::string, DetectionModule>::Reader reader(modules);
+		for (SnapshotRegistry<std::string, DetectionModule>::Entries::const_iterator it =
+			reader.getEntries().begin(); it != reader.getEntries().end(); ++it) {
+			detectionModules.insert(it->first);
+		}
 	}
-	detectionModules.sort();
-	return detectionModules;
+	return std::list<std::string>(detectionModules.begin(), detectionModules.end());
+}
+
+const vmi::SnapshotRegistry<std::string, vmi::DetectionModule> &vmi::DetectionModule::getRegistry() {
+	return modules;
 }
 
 float vmi::DetectionModule::getGlobalThreatLevel() {
-	vmi::MutexLocker lock(&mutex);
-	float threatLevel = 0;
-	for (std::map<std::string, DetectionModule*>::iterator it =
-			modules.begin(); it
-			!= modules.end(); ++it) {
-		threatLevel += (it->second)->getThreatLevel();
-	}
-	return threatLevel / modules.size();
+	return ThreatLevelService::getGlobalThreatLevel();
 }
 
 }
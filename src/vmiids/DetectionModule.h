@@ -13,13 +13,24 @@
 #include "vmiids/util/Thread.h"
 
 #include "vmiids/util/Mutex.h"
+#include "vmiids/util/SnapshotRegistry.h"
+#include "vmiids/util/HandleTable.h"
+#include "vmiids/util/RuntimeStatistics.h"
 
 #include <string>
 #include <map>
 #include <list>
+#include <set>
 
 namespace vmi {
 
+class DetectionModule;
+
+/**
+ * Stable handle of a loaded DetectionModule. Becomes stale when the module is unloaded.
+ */
+typedef vmi::Handle<DetectionModule> DetectionModuleHandle;
+
 /**
  * @class DetectionModule DetectionModule.h "vmiids/DetectionModule.h"
  * @brief Detection Modules - The frameworks active component.
@@ -45,18 +56,27 @@ namespace vmi {
 class DetectionModule : public vmi::Module, protected OutputModule, public Thread{
 	private:
 		/**
-		 * Map of DetectionModules currently loaded into the framework. The modules are hashed with
-		 * the name of the detectionModule as key. This map is static and contains a list of all
-		 * instances of this class. The detectionModules are enqueued in the Constructor.
+		 * Registry of DetectionModules currently loaded into the framework. The modules are keyed with
+		 * the name of the detectionModule. This registry is static and contains all
+		 * instances of this class. The detectionModules are registered in the Constructor.
+		 * Lookups do not lock, so the scheduler never contends with loading modules.
 		 *
 		 * TODO Currently modules can not be unloaded.
 		 */
-		static std::map<std::string, vmi::DetectionModule *> modules;
+		static vmi::SnapshotRegistry<std::string, vmi::DetectionModule> modules;
 
 		/**
-		 * Mutex for the modules map. Allow multithreaded access to different detection modules.
+		 * Handles of the loaded DetectionModules. Resolving a handle does not lock.
 		 */
-		static vmi::Mutex mutex;
+		static vmi::HandleTable<vmi::DetectionModule> handles;
+
+		DetectionModuleHandle handle;  //!< Handle of this module.
+
+		vmi::Mutex runMutex;  //!< Serializes runs of this module. The module thread can only run once at a time.
+
+		volatile unsigned int pins;  //!< Number of callers, which pinned the module with pin().
+
+		vmi::RuntimeStatistics statistics;  //!< Runtime counters of execute().
 
 	protected:
 		/**
@@ -90,18 +110,95 @@ class DetectionModule : public vmi::Module, protected OutputModule, public Threa
 		 */
 		static vmi::DetectionModule *getDetectionModule(std::string detectionModuleName);
 
+		/**
+		 * Request a pointer to a special DetectionModule by its handle. Lock-free.
+		 * The module may be unloaded while the pointer is used. Use pin() to run the module.
+		 * @param handle Handle of the requested DetectionModule.
+		 * @return Pointer to the DetectionModule. NULL, if the handle is stale.
+		 */
+		static vmi::DetectionModule *getDetectionModule(const DetectionModuleHandle &handle);
+
+		/**
+		 * Resolve a handle and pin the module. unload() waits until the module is unpinned,
+		 * so the module is not deleted while it is used. Lock-free.
+		 * @param handle Handle of the requested DetectionModule.
+		 * @return Pinned DetectionModule. Must be released with unpin(). NULL, if the handle is stale.
+		 */
+		static vmi::DetectionModule *pin(const DetectionModuleHandle &handle);
+
+		/**
+		 * Release a module pinned by pin().
+		 */
+		void unpin();
+
+		/**
+		 * Make the module unreachable and wait until it is not pinned anymore.
+		 * All handles become stale and lookups by name fail. Called before the module is deleted.
+		 * The destructor calls it, if it was not called before.
+		 */
+		virtual void unload();
+
+		/**
+		 * Request the handle of a special DetectionModule.
+		 * A registered module, which is not constructed yet, is constructed.
+		 * @param detectionModuleName Name of the requested DetectionModule.
+		 * @return Handle of the DetectionModule. Invalid, if the module is not loaded.
+		 */
+		static DetectionModuleHandle getDetectionModuleHandle(std::string detectionModuleName);
+
+		/**
+		 * Check, if a DetectionModule is loaded or registered. Does not construct the module.
+		 * @param detectionModuleName Name of the requested DetectionModule.
+		 * @return True, if the module is constructed or can be constructed by getDetectionModuleHandle().
+		 */
+		static bool isDetectionModule(std::string detectionModuleName);
+
+		/**
+		 * @return Handle of the current DetectionModule.
+		 */
+		const DetectionModuleHandle &getHandle() const;
+
 		/**
 		 * Request a list of currently loaded DetectionModules. The list does not contain pointers
-		 * to DetectionModule instances, but the names of the modules loaded.
+		 * to DetectionModule instances, but the names of the modules loaded. Registered modules,
+		 * which are not constructed yet, are included.
 		 * @return List of Names of currently loaded detection modules.
 		 */
 		static std::list<std::string> getListOfDetectionModules();
 
+		/**
+		 * Request the registry of currently loaded DetectionModules, e.g. to iterate the modules
+		 * within a SnapshotRegistry::Reader. A read section must not load or unload modules.
+		 * @return Registry of DetectionModules.
+		 */
+		static const vmi::SnapshotRegistry<std::string, vmi::DetectionModule> &getRegistry();
+
 		/**
 		 * Delete all currently loaded DetectionModule instances.
 		 */
 		static void killInstances();
 
+		/**
+		 * Run the current DetectionModule once and wait for it to finish.
+		 * Runs requested concurrently (e.g. by a schedule and a rpc job) are executed one after the other.
+		 * The run inherits the run ID of the calling thread.
+		 * @return False, if the run was aborted by an exception.
+		 */
+		bool execute();
+
+		/**
+		 * Request the runtime counters of the current DetectionModule. Lock-free.
+		 * @return Counters of all runs started by execute().
+		 */
+		const vmi::RuntimeStatistics &getStatistics() const;
+
+		/**
+		 * Call reconfigure() while the module does not run. A run requested meanwhile waits.
+		 * @param options Names of the options, which were added, removed or changed.
+		 * @return False, if the module has to be reloaded to apply the changes.
+		 */
+		bool applyConfiguration(const std::set<std::string> &options);
+
 		/**
 		 * Request the threadLevel of the current DetectionModule.
 		 * @return Thread level calculated by the current detection module.
@@ -109,8 +206,9 @@ class DetectionModule : public vmi::Module, protected OutputModule, public Threa
 		float getThreatLevel();
 
 		/**
-		 * Request the threadLevel of the current DetectionModule.
-		 * @return Thread level calculated by the current detection module.
+		 * Request the global threat level.
+		 * @sa ThreatLevelService::getGlobalThreatLevel()
+		 * @return Decayed average threat level of all detection modules, which have run.
 		 */
 		static float getGlobalThreatLevel();
 };
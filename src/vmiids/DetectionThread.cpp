@@ -6,6 +6,7 @@
  */
 
 #include "DetectionThread.h"
+#include "ThreatLevelService.h"
 
 #include "vmiids/util/MutexLocker.h"
 
@@ -14,15 +15,21 @@
 namespace vmi {
 
 DetectionThread::DetectionThread(time_t seconds)
-		: m_seconds(seconds){
+		: m_seconds(seconds), m_scheduleVersion(0), lastRun(time(NULL)), overruns(0){
 	pthread_mutex_init(&threadMutex, NULL);
 	this->threadActive = true;
+	this->paused = false;
 }
 
 DetectionThread::DetectionThread(time_t seconds, std::set<std::string> detectionModules)
-		: m_seconds(seconds), m_detectionModules(detectionModules){
+		: m_seconds(seconds), m_scheduleVersion(0), lastRun(time(NULL)), overruns(0){
 	pthread_mutex_init(&threadMutex, NULL);
 	this->threadActive = true;
+	this->paused = false;
+	for (std::set<std::string>::iterator it = detectionModules.begin();
+			it != detectionModules.end(); ++it) {
+		this->enqueueModule(*it);
+	}
 }
 
 DetectionThread::~DetectionThread() {
@@ -33,55 +40,175 @@ DetectionThread::~DetectionThread() {
 	pthread_mutex_destroy(&threadMutex);
 }
 
-bool DetectionThread::enqueueModule(std::string moduleName){
+void DetectionThread::updateSchedule(){
+	this->m_schedule.clear();
+	for (std::map<std::string, DetectionModuleHandle>::iterator it = this->m_detectionModules.begin();
+			it != this->m_detectionModules.end(); ++it) {
+		if (it->second.isValid()) {
+			this->m_schedule.push_back(it->second);
+		}
+	}
+	__sync_add_and_fetch(&this->m_scheduleVersion, 1);
+}
+
+void DetectionThread::resolvePendingModules(){
+	std::vector<std::string> pending;
 	pthread_mutex_lock(&threadMutex);
-	this->m_detectionModules.insert(moduleName);
+	for (std::map<std::string, DetectionModuleHandle>::iterator it = this->m_detectionModules.begin();
+			it != this->m_detectionModules.end(); ++it) {
+		if (!it->second.isValid()) {
+			pending.push_back(it->first);
+		}
+	}
 	pthread_mutex_unlock(&threadMutex);
+
+	for (std::vector<std::string>::iterator name = pending.begin(); name != pending.end(); ++name) {
+		// Constructing the module may take a while, the lock is not held meanwhile.
+		DetectionModuleHandle handle = DetectionModule::getDetectionModuleHandle(*name);
+		MutexLocker lock(&threadMutex);
+		std::map<std::string, DetectionModuleHandle>::iterator it = this->m_detectionModules.find(*name);
+		if (it == this->m_detectionModules.end() || it->second.isValid()) {
+			// Dequeued meanwhile.
+			continue;
+		}
+		if (handle.isValid()) {
+			it->second = handle;
+		} else {
+			std::cout << "DetectionModule " << *name << " could not be loaded, not scheduled" << std::endl;
+			this->m_detectionModules.erase(it);
+		}
+		this->updateSchedule();
+	}
+}
+
+bool DetectionThread::enqueueModule(std::string moduleName){
+	if (!DetectionModule::isDetectionModule(moduleName)) {
+		return false;
+	}
+	MutexLocker lock(&threadMutex);
+	if (this->m_detectionModules.find(moduleName) != this->m_detectionModules.end()) {
+		return true;
+	}
+	// Resolved by the thread before its next round.
+	this->m_detectionModules[moduleName] = DetectionModuleHandle();
+	this->updateSchedule();
 	return true;
 }
 
 bool DetectionThread::dequeueModule(std::string moduleName){
-	pthread_mutex_lock(&threadMutex);
-	this->m_detectionModules.erase(moduleName);
-	pthread_mutex_unlock(&threadMutex);
+	MutexLocker lock(&threadMutex);
+	if (this->m_detectionModules.erase(moduleName) == 0) {
+		return false;
+	}
+	this->updateSchedule();
 	return true;
 }
 
+void DetectionThread::removeStaleModule(const DetectionModuleHandle &handle){
+	MutexLocker lock(&threadMutex);
+	for (std::map<std::string, DetectionModuleHandle>::iterator it = this->m_detectionModules.begin();
+			it != this->m_detectionModules.end(); ++it) {
+		if (it->second == handle) {
+			this->m_detectionModules.erase(it);
+			this->updateSchedule();
+			return;
+		}
+	}
+}
+
 size_t DetectionThread::getModuleCount(){
 	MutexLocker lock(&threadMutex);
 	return this->m_detectionModules.size();
 }
 
+time_t DetectionThread::getInterval() const {
+	return this->m_seconds;
+}
+
+std::vector<std::string> DetectionThread::getModuleNames(){
+	std::vector<std::string> names;
+	MutexLocker lock(&threadMutex);
+	for (std::map<std::string, DetectionModuleHandle>::iterator it = this->m_detectionModules.begin();
+			it != this->m_detectionModules.end(); ++it) {
+		names.push_back(it->first);
+	}
+	return names;
+}
+
+const RuntimeStatistics &DetectionThread::getStatistics() const {
+	return this->statistics;
+}
+
+uint32_t DetectionThread::getOverrunCount() const {
+	return this->overruns;
+}
+
+void DetectionThread::setInterval(time_t seconds){
+	this->m_seconds = seconds;
+}
+
+void DetectionThread::setPaused(bool paused){
+	this->paused = paused;
+}
+
+bool DetectionThread::isPaused() const {
+	return this->paused;
+}
+
+time_t DetectionThread::getNextRun() const {
+	return this->lastRun + this->m_seconds;
+}
+
+bool DetectionThread::executeRound(const std::vector<DetectionModuleHandle> &schedule){
+	DetectionModule * module;
+
+	uint64_t roundStart = RuntimeStatistics::now();
+	this->statistics.enter();
+	this->statistics.start(roundStart);
+	bool roundFailed = false;
+	for ( std::vector<DetectionModuleHandle>::const_iterator it=schedule.begin() ;
+			it != schedule.end(); it++ ){
+	    if(!this->threadActive){
+	    	this->statistics.finish(roundStart, RuntimeStatistics::now(), roundFailed);
+	    	return false;
+	    }
+	    module = DetectionModule::pin(*it);
+	    if(module == NULL){
+			this->removeStaleModule(*it);
+	    }else{
+	    	Thread::setCurrentRunId(Thread::createRunId());
+	    	roundFailed |= !module->execute();
+	    	ThreatLevelService::report(module, m_seconds);
+	    	module->unpin();
+	    }
+	}
+	this->statistics.finish(roundStart, RuntimeStatistics::now(), roundFailed);
+	return true;
+}
+
 void DetectionThread::run(){
 
 	this->lastRun = time (NULL);
 
-	std::set<std::string> detectionModules;
+	std::vector<DetectionModuleHandle> schedule;
+	unsigned int scheduleVersion = 0;
 
 	while (this->threadActive) {
 
-		pthread_mutex_lock(&threadMutex);
-		detectionModules = this->m_detectionModules;
-		pthread_mutex_unlock(&threadMutex);
-
-		DetectionModule * module;
-
-		for ( std::set<std::string>::iterator it=detectionModules.begin() ;
-				it != detectionModules.end(); it++ ){
-		    if(!this->threadActive){
-		    	return;
-		    }
-		    module = DetectionModule::getDetectionModule(*it);
-		    if(module == NULL){
-				pthread_mutex_lock(&threadMutex);
-				this->m_detectionModules.erase(*it);
-				pthread_mutex_unlock(&threadMutex);
-		    }else{
-		    	module->start();
-		    	module->join();
-		    }
+		if (scheduleVersion != this->m_scheduleVersion) {
+			// Only copy the schedule, if it changed since the last iteration.
+			this->resolvePendingModules();
+			pthread_mutex_lock(&threadMutex);
+			schedule = this->m_schedule;
+			scheduleVersion = this->m_scheduleVersion;
+			pthread_mutex_unlock(&threadMutex);
+		}
+
+		if(!this->paused && !this->executeRound(schedule)){
+			return;
 		}
 		if(time(NULL) > this->lastRun + m_seconds){
+			__sync_add_and_fetch(&this->overruns, 1);
 			std::cout << "Execution took longer than estimated" << std::endl;
 			this->lastRun = time (NULL);
 			continue;
@@ -93,6 +220,10 @@ void DetectionThread::run(){
 			this->sleep(1000);
 	    }
 		this->lastRun += m_seconds;
+		if(this->lastRun + 1 < time(NULL)){
+			// The interval was shortened while waiting.
+			this->lastRun = time (NULL);
+		}
 	}
 	return;
 }
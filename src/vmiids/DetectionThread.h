@@ -9,9 +9,13 @@
 #define DETECTIONTHREAD_H_
 
 #include "vmiids/util/Thread.h"
+#include "vmiids/DetectionModule.h"
+#include "vmiids/util/RuntimeStatistics.h"
 
+#include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 namespace vmi {
 
@@ -28,20 +32,33 @@ namespace vmi {
  *
  * Each detection module itself is executed within a single, separated thread.
  *
- * A list of module names is contained in an internal set.
- * The modules are executed one after the other.
+ * The modules are resolved to handles by the thread itself, before the next round. A module,
+ * which is not constructed yet, is thus constructed by the schedule and not by the caller of
+ * enqueueModule(). A module, which can not be constructed, is removed from the schedule.
+ * The modules are executed one after the other, ordered by name. A module, which has been unloaded, is detected
+ * by its stale handle and removed from the schedule. A module is pinned while it runs, so unloading
+ * it waits for the run to finish.
  * If the execution of all modules takes longer, than the time specified between two
  * executions, reexecution is triggered immediately.
+ *
+ * The time between two executions can be changed and the schedule can be paused while the
+ * thread runs. Changes take effect at the next trigger and never interrupt a running module.
  */
 class DetectionThread : public Thread{
 private:
 	pthread_mutex_t threadMutex; //!< Mutex for the m_detectionModules data structure.
-	bool threadActive;   //!< Flag indicating if the thread is currently running.
+	volatile bool threadActive;   //!< Flag indicating if the thread is currently running.
+	volatile bool paused;         //!< Flag indicating if the execution of the modules is suspended.
+
+	volatile time_t m_seconds;   //!< Time between triggered executions.
+	std::map<std::string, DetectionModuleHandle> m_detectionModules;  //!< Detection modules which are executed. Invalid handles are not resolved yet.
+	std::vector<DetectionModuleHandle> m_schedule;  //!< Resolved handles of m_detectionModules in execution order.
+	volatile unsigned int m_scheduleVersion;  //!< Incremented whenever m_schedule changes.
 
-	time_t m_seconds;   //!< Time between triggered executions.
-	std::set<std::string> m_detectionModules;  //! Set containing detection modules which are executed.
+	volatile time_t lastRun;   //! Time of the last trigger. Used to calculate idle time between two triggers.
 
-	time_t lastRun;   //! Time of the last trigger. Used to calculate idle time between two triggers.
+	vmi::RuntimeStatistics statistics;  //!< Runtime counters of the rounds (one execution of all modules).
+	volatile uint32_t overruns;         //!< Number of rounds, which took longer than m_seconds.
 
 	/**
 	 * @internal
@@ -52,6 +69,30 @@ private:
 	 */
 	virtual void run();
 
+	/**
+	 * Rebuild m_schedule from m_detectionModules. Must be called with threadMutex held.
+	 */
+	void updateSchedule();
+
+	/**
+	 * Resolve the handles of the modules enqueued since the last round. Constructs the modules,
+	 * which are not constructed yet. Must be called without threadMutex held.
+	 */
+	void resolvePendingModules();
+
+	/**
+	 * Execute all modules of the schedule once.
+	 * @param schedule Handles of the modules in execution order.
+	 * @return False, if the thread was stopped during the round.
+	 */
+	bool executeRound(const std::vector<DetectionModuleHandle> &schedule);
+
+	/**
+	 * Remove a module from the schedule, whose handle became stale.
+	 * @param handle Stale handle.
+	 */
+	void removeStaleModule(const DetectionModuleHandle &handle);
+
 public:
 	/**
 	 * Constructor
@@ -80,8 +121,10 @@ public:
 	/**
 	 * Enqueue a detection module into the current scheduler.
 	 *
+	 * The module is not constructed by the caller. It is resolved by the scheduler before its next round.
+	 *
 	 * @param moduleName Name of the detection module to enqueue.
-	 * @return True, if the detection module could be enqueued.
+	 * @return True, if the detection module could be enqueued. False, if it is neither loaded nor registered.
 	 */
 	bool enqueueModule(std::string moduleName);
 
@@ -89,7 +132,7 @@ public:
 	 * Dequeue a detection module from the current scheduler.
 	 *
 	 * @param moduleName Name of the detection module to dequeue.
-	 * @return True, if the detection module could be dequeued.
+	 * @return True, if the detection module could be dequeued. False, if it was not enqueued.
 	 */
 	bool dequeueModule(std::string moduleName);
 
@@ -99,6 +142,49 @@ public:
 	 */
 	size_t getModuleCount();
 
+	/**
+	 * @return Time between two execution triggers.
+	 */
+	time_t getInterval() const;
+
+	/**
+	 * Change the time between two execution triggers. Takes effect at the next trigger.
+	 * @param seconds Time between two execution triggers.
+	 */
+	void setInterval(time_t seconds);
+
+	/**
+	 * Suspend or resume the execution of the modules. A running module is not interrupted.
+	 * @param paused True to suspend the execution, false to resume it.
+	 */
+	void setPaused(bool paused);
+
+	/**
+	 * @return True, if the execution of the modules is suspended.
+	 */
+	bool isPaused() const;
+
+	/**
+	 * @return Names of the modules enqueued, in execution order.
+	 */
+	std::vector<std::string> getModuleNames();
+
+	/**
+	 * Request the runtime counters of the rounds. Lock-free.
+	 * @return Counters of all rounds, each executing all enqueued modules once.
+	 */
+	const vmi::RuntimeStatistics &getStatistics() const;
+
+	/**
+	 * @return Number of rounds, which took longer than the time between two execution triggers.
+	 */
+	uint32_t getOverrunCount() const;
+
+	/**
+	 * @return Time of the next execution trigger (s since epoch).
+	 */
+	time_t getNextRun() const;
+
 	/**
 	 * Stop execution of scheduler.
 	 */
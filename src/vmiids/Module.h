@@ -8,6 +8,7 @@
 #ifndef MODULE_H_
 #define MODULE_H_
 
+#include <set>
 #include <string>
 #include <sstream>
 #include <iostream>
@@ -15,6 +16,8 @@
 #include "vmiids/util/Exception.h"
 #include "vmiids/util/Settings.h"
 
+#include "ModuleRegistry.h"
+
 #define STR(s) #s              /*!< Do not interpret s. Return as char* */
 #define QUOTE(s) STR(s)        /*!< In case s contains spaces the STR() is wrapped. */
 #define CONCAT(a, b) a ## b    /*!< Concatinate a and b. */
@@ -84,6 +87,10 @@ public:
  *
  * The base class contains the modules name.
  *
+ * Modules read their options from the section of the configuration named like the module.
+ * When the configuration is reloaded and the section of a module changed, reconfigure() is
+ * called. Modules, which do not implement it, keep their options until they are reloaded.
+ *
  * Modules which should be loadable to the VmiIDS framework must use the \ref LOADMODULE() macro.
  */
 class Module{
@@ -106,38 +113,72 @@ class Module{
 		 * @return Name of the module.
 		 */
 		std::string getName(){ return this->moduleName; };
+		/**
+		 * Apply changed options after the configuration was reloaded. The new values are read
+		 * with the GETOPTION() macro, as in the constructor.
+		 *
+		 * @param options Names of the options, which were added, removed or changed.
+		 * @return False, if not all options could be applied and the module has to be reloaded.
+		 */
+		virtual bool reconfigure(const std::set<std::string> &options){ return options.empty(); };
+		/**
+		 * Called before the module is deleted, while the subclass is still intact.
+		 * Modules used by other threads make themselves unreachable and wait for their users here.
+		 */
+		virtual void unload(){};
 };
 
+class SensorModule;
+class DetectionModule;
+class NotificationModule;
+
+/**
+ * Determine the kind of a module from its base class.
+ */
+inline eModuleKind getModuleKind(const SensorModule *){ return MODULE_SENSOR; }
+inline eModuleKind getModuleKind(const DetectionModule *){ return MODULE_DETECTION; }      //!< @sa getModuleKind()
+inline eModuleKind getModuleKind(const NotificationModule *){ return MODULE_NOTIFICATION; }  //!< @sa getModuleKind()
+inline eModuleKind getModuleKind(const void *){ return MODULE_OTHER; }                    //!< @sa getModuleKind()
+
+/**
+ * Called after a module was constructed. Attaches NotificationModules to the dispatcher
+ * (see NotificationModule::attach()), so it never uses a partially constructed module.
+ */
+void attachModule(NotificationModule *module);
+inline void attachModule(const void *){}  //!< @sa attachModule()
+
 /**
  * @class ModuleLoader Module.h "vmiids/Module.h"
  * @brief ModuleLoader class.
  * @sa LOADMODULE
+ * @sa ModuleRegistry
  *
  * VmiIDS is a framework managing different modules.
  * Each module is derived from the Module base class.
  *
- * The ModuleLoader class can be used to auto-load a module.
+ * The ModuleLoader class can be used to auto-load a module. It registers the module with
+ * the ModuleRegistry, which constructs the module, when it is needed.
  */
 template<class Module>
 class ModuleLoader{
 private:
-	Module *module; //! Pointer to the module.
+	/**
+	 * Construct the module. Called by the ModuleRegistry.
+	 */
+	static vmi::Module *create(){
+		Module *module = new Module();
+		attachModule(module);
+		return module;
+	}
 public:
 	/**
-	 * Constructor. Used to load the given module.
-	 * Success or failure is reported to std::cerr.
-	 * @return
+	 * Constructor. Used to register the given module.
+	 * @param name Name of the module.
+	 * @param dependencies Names of the modules used by the module, separated by whitespace.
 	 */
-	ModuleLoader(){
-		try {
-			module = new Module();
-		} catch (vmi::ModuleException &e) {
-			std::cerr << "Loading Module FAILED" << std::endl;
-			e.printException();
-		} catch (std::exception &e) {
-			std::cerr << "Loading Module FAILED" << std::endl;
-			std::cerr << e.what() << std::endl;
-		}
+	ModuleLoader(const char *name, const char *dependencies){
+		vmi::ModuleRegistry::getInstance()->registerModule(name,
+				getModuleKind((Module *) NULL), &ModuleLoader::create, dependencies);
 	}
 	/**
 	 * Empty Destructor.
@@ -157,10 +198,26 @@ public:
  * This macro is used by any module which should be auto-loaded
  * into vmi::VmiIDS. As the instance is static, its constructor
  * is called directly after the object file was loaded with the dl_open function.
+ * The module is registered only. It is constructed later, either at startup, if it is
+ * scheduled or a NotificationModule, or on its first use.
  * @sa vmi::VmiIDS::loadModules().
  */
 #define LOADMODULE(classname) \
-	static vmi::ModuleLoader<classname> CONCAT(classname, p);
+	LOADMODULE_DEPENDS(classname, "")
+
+/**
+ * @brief Macro to auto-load a Module, which uses other modules.
+ *
+ * @def LOADMODULE_DEPENDS
+ * @param classname Class to load. Must be a subclass of vmi::Module.
+ * @param dependencies Names of the modules used by the class, separated by whitespace.
+ *
+ * Like LOADMODULE(). The modules listed are constructed before the class, so independent
+ * modules can be constructed in parallel. Modules requested with GETSENSORMODULE(), which
+ * are not listed, are constructed when they are requested.
+ */
+#define LOADMODULE_DEPENDS(classname, dependencies) \
+	static vmi::ModuleLoader<classname> CONCAT(classname, p)(QUOTE(classname), dependencies);
 }
 
 #endif /* MODULE_H_ */
@@ -0,0 +1,357 @@
+/*
+ * ModuleRegistry.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#include "ModuleRegistry.h"
+
+#include "Module.h"
+
+#include "vmiids/util/MutexLocker.h"
+#include "vmiids/util/ThreadPool.h"
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <sstream>
+
+/**
+ * Maximum number of modules constructed in parallel.
+ */
+#define MODULEREGISTRY_THREADS 8
+
+namespace vmi {
+
+vmi::ModuleRegistry* vmi::ModuleRegistry::instance = NULL;
+
+/**
+ * Modules constructed by activateModules(), which have finished.
+ */
+struct ActivationQueue {
+	pthread_mutex_t mutex;            //!< Protects finished.
+	pthread_cond_t changed;           //!< Signaled when a module has finished.
+	std::deque<std::string> finished; //!< Modules finished, but not processed yet.
+};
+
+/**
+ * Task constructing a single module.
+ */
+class ActivationTask : public ThreadPool::Task {
+private:
+	std::string name;         //!< Module to construct.
+	ActivationQueue *queue;   //!< Queue to report to.
+public:
+	ActivationTask(std::string name, ActivationQueue *queue) : name(name), queue(queue) {}
+	virtual void run(void){
+		ModuleRegistry::getInstance()->activate(name);
+		MutexLocker lock(&queue->mutex);
+		queue->finished.push_back(name);
+		pthread_cond_signal(&queue->changed);
+	}
+};
+
+ModuleRegistry::ModuleRegistry() : constructors(0) {
+	pthread_mutex_init(&registryMutex, NULL);
+	pthread_cond_init(&constructed, NULL);
+}
+
+ModuleRegistry::~ModuleRegistry() {
+	pthread_cond_destroy(&constructed);
+	pthread_mutex_destroy(&registryMutex);
+}
+
+ModuleRegistry *ModuleRegistry::getInstance(){
+	if (!instance)
+		instance = new ModuleRegistry();
+	return instance;
+}
+
+void ModuleRegistry::registerModule(std::string name, eModuleKind kind, Factory factory,
+		std::string dependencies){
+	MutexLocker lock(&registryMutex);
+	if (entries.find(name) != entries.end()) {
+		return;
+	}
+	Entry &entry = entries[name];
+	entry.kind = kind;
+	entry.factory = factory;
+	entry.state = MODULE_REGISTERED;
+	entry.module = NULL;
+
+	std::stringstream names(dependencies);
+	std::string dependency;
+	while (names >> dependency) {
+		entry.dependencies.push_back(dependency);
+	}
+}
+
+bool ModuleRegistry::waitsForSelf(const Entry &entry){
+	pthread_t thread = entry.owner;
+	// Follow the chain of constructors waiting for each other. It is at most as long as the
+	// number of waiting threads.
+	for (size_t steps = 0; steps <= waiting.size(); steps++) {
+		size_t i = 0;
+		while (i < waiting.size() && !pthread_equal(waiting[i].first, thread)) {
+			i++;
+		}
+		if (i == waiting.size()) {
+			return false;
+		}
+		const Entry &next = entries[waiting[i].second];
+		if (next.state != MODULE_CONSTRUCTING) {
+			return false;
+		}
+		if (pthread_equal(next.owner, pthread_self())) {
+			return true;
+		}
+		thread = next.owner;
+	}
+	return false;
+}
+
+void ModuleRegistry::addDependency(const std::string &name){
+	for (ThreadModules::reverse_iterator it = constructing.rbegin(); it != constructing.rend(); ++it) {
+		if (pthread_equal(it->first, pthread_self())) {
+			std::vector<std::string> &dependencies = entries[it->second].dependencies;
+			if (it->second != name &&
+					std::find(dependencies.begin(), dependencies.end(), name) == dependencies.end()) {
+				dependencies.push_back(name);
+			}
+			return;
+		}
+	}
+}
+
+bool ModuleRegistry::activate(std::string name){
+	Factory factory;
+	std::vector<std::string> dependencies;
+	{
+		MutexLocker lock(&registryMutex);
+		Entries::iterator it = entries.find(name);
+		if (it == entries.end()) {
+			return false;
+		}
+		Entry &entry = it->second;
+		while (entry.state == MODULE_CONSTRUCTING) {
+			if (pthread_equal(entry.owner, pthread_self()) || this->waitsForSelf(entry)) {
+				std::cerr << "Cyclic dependency of Module " << name << std::endl;
+				return false;
+			}
+			waiting.push_back(std::make_pair(pthread_self(), name));
+			pthread_cond_wait(&constructed, &registryMutex);
+			for (size_t i = 0; i < waiting.size(); i++) {
+				if (pthread_equal(waiting[i].first, pthread_self())) {
+					waiting.erase(waiting.begin() + i);
+					break;
+				}
+			}
+		}
+		this->addDependency(name);
+		if (entry.state != MODULE_REGISTERED) {
+			return entry.state == MODULE_ACTIVE;
+		}
+		entry.state = MODULE_CONSTRUCTING;
+		entry.owner = pthread_self();
+		factory = entry.factory;
+		dependencies = entry.dependencies;
+		constructing.push_back(std::make_pair(pthread_self(), name));
+		__sync_add_and_fetch(&constructors, 1);
+	}
+
+	// Dependencies, which are missing or failed, are reported by the constructor of the module.
+	for (size_t i = 0; i < dependencies.size(); i++) {
+		this->activate(dependencies[i]);
+	}
+
+	Module *module = NULL;
+	try {
+		module = factory();
+	} catch (vmi::ModuleException &e) {
+		std::cerr << "Loading Module FAILED" << std::endl;
+		e.printException();
+	} catch (std::exception &e) {
+		std::cerr << "Loading Module FAILED" << std::endl;
+		std::cerr << e.what() << std::endl;
+	}
+
+	MutexLocker lock(&registryMutex);
+	for (ThreadModules::iterator it = constructing.begin(); it != constructing.end(); ++it) {
+		if (pthread_equal(it->first, pthread_self()) && it->second == name) {
+			constructing.erase(it);
+			break;
+		}
+	}
+	__sync_sub_and_fetch(&constructors, 1);
+	Entry &entry = entries[name];
+	entry.module = module;
+	entry.state = (module != NULL) ? MODULE_ACTIVE : MODULE_FAILED;
+	pthread_cond_broadcast(&constructed);
+	return module != NULL;
+}
+
+void ModuleRegistry::collectPending(const std::string &name, std::set<std::string> &pending){
+	Entries::iterator it = entries.find(name);
+	if (it == entries.end() || it->second.state != MODULE_REGISTERED ||
+			!pending.insert(name).second) {
+		return;
+	}
+	for (size_t i = 0; i < it->second.dependencies.size(); i++) {
+		this->collectPending(it->second.dependencies[i], pending);
+	}
+}
+
+void ModuleRegistry::activateModules(const std::set<std::string> &names){
+	std::set<std::string> pending;
+	std::map<std::string, std::vector<std::string> > dependencies;
+	{
+		MutexLocker lock(&registryMutex);
+		for (std::set<std::string>::const_iterator it = names.begin(); it != names.end(); ++it) {
+			this->collectPending(*it, pending);
+		}
+		for (Entries::iterator it = entries.begin(); it != entries.end(); ++it) {
+			if (it->second.kind == MODULE_NOTIFICATION) {
+				this->collectPending(it->first, pending);
+			}
+		}
+		for (std::set<std::string>::iterator it = pending.begin(); it != pending.end(); ++it) {
+			dependencies[*it] = entries[*it].dependencies;
+		}
+	}
+
+	if (pending.size() == 1) {
+		this->activate(*pending.begin());
+		return;
+	}
+
+	// Count the dependencies of each module, which are not constructed yet.
+	std::map<std::string, size_t> missing;
+	std::map<std::string, std::vector<std::string> > dependents;
+	for (std::set<std::string>::iterator it = pending.begin(); it != pending.end(); ++it) {
+		std::vector<std::string> &moduleDependencies = dependencies[*it];
+		size_t &count = missing[*it];
+		for (size_t i = 0; i < moduleDependencies.size(); i++) {
+			if (pending.count(moduleDependencies[i]) > 0) {
+				dependents[moduleDependencies[i]].push_back(*it);
+				count++;
+			}
+		}
+	}
+
+	ActivationQueue queue;
+	pthread_mutex_init(&queue.mutex, NULL);
+	pthread_cond_init(&queue.changed, NULL);
+	std::vector<ActivationTask *> tasks;
+	size_t running = 0;
+	{
+		ThreadPool pool(std::min<size_t>(pending.size(), MODULEREGISTRY_THREADS));
+		while (!pending.empty()) {
+			// Start all modules, whose dependencies are constructed.
+			for (std::set<std::string>::iterator it = pending.begin(); it != pending.end();) {
+				if (missing[*it] > 0) {
+					++it;
+					continue;
+				}
+				tasks.push_back(new ActivationTask(*it, &queue));
+				pool.submit(tasks.back());
+				running++;
+				pending.erase(it++);
+			}
+			if (running == 0) {
+				// Cyclic dependency. activate() breaks the cycle.
+				std::cerr << "Cyclic dependency between Modules:";
+				for (std::set<std::string>::iterator it = pending.begin(); it != pending.end(); ++it) {
+					std::cerr << " " << *it;
+				}
+				std::cerr << std::endl;
+				missing[*pending.begin()] = 0;
+				continue;
+			}
+
+			std::string name;
+			{
+				MutexLocker lock(&queue.mutex);
+				while (queue.finished.empty()) {
+					pthread_cond_wait(&queue.changed, &queue.mutex);
+				}
+				name = queue.finished.front();
+				queue.finished.pop_front();
+			}
+			running--;
+			std::vector<std::string> &moduleDependents = dependents[name];
+			for (size_t i = 0; i < moduleDependents.size(); i++) {
+				missing[moduleDependents[i]]--;
+			}
+		}
+		pool.waitForAll();
+	}
+	for (size_t i = 0; i < tasks.size(); i++) {
+		delete tasks[i];
+	}
+	pthread_cond_destroy(&queue.changed);
+	pthread_mutex_destroy(&queue.mutex);
+}
+
+int ModuleRegistry::getDepth(const std::string &name, std::map<std::string, int> &depths){
+	std::map<std::string, int>::iterator known = depths.find(name);
+	if (known != depths.end()) {
+		// A module being visited is part of a cycle. The cycle is cut here.
+		return std::max(known->second, 0);
+	}
+	Entries::iterator it = entries.find(name);
+	if (it == entries.end()) {
+		return 0;
+	}
+	depths[name] = -1;
+	int depth = 0;
+	for (size_t i = 0; i < it->second.dependencies.size(); i++) {
+		if (entries.count(it->second.dependencies[i]) > 0) {
+			depth = std::max(depth, this->getDepth(it->second.dependencies[i], depths) + 1);
+		}
+	}
+	depths[name] = depth;
+	return depth;
+}
+
+void ModuleRegistry::destroyModules(){
+	// Sort key: NotificationModules last, then deepest modules first, then by name.
+	std::map<std::pair<std::pair<bool, int>, std::string>, Module *> order;
+	{
+		MutexLocker lock(&registryMutex);
+		std::map<std::string, int> depths;
+		for (Entries::iterator it = entries.begin(); it != entries.end(); ++it) {
+			if (it->second.state != MODULE_ACTIVE) {
+				continue;
+			}
+			order[std::make_pair(std::make_pair(it->second.kind == MODULE_NOTIFICATION,
+					-this->getDepth(it->first, depths)), it->first)] = it->second.module;
+			it->second.module = NULL;
+			it->second.state = MODULE_REGISTERED;
+		}
+	}
+	for (std::map<std::pair<std::pair<bool, int>, std::string>, Module *>::iterator it = order.begin();
+			it != order.end(); ++it) {
+		it->second->unload();
+		delete it->second;
+	}
+}
+
+eModuleState ModuleRegistry::getState(std::string name){
+	MutexLocker lock(&registryMutex);
+	Entries::iterator it = entries.find(name);
+	return (it != entries.end()) ? it->second.state : MODULE_UNKNOWN;
+}
+
+std::list<std::string> ModuleRegistry::getModuleNames(eModuleKind kind){
+	MutexLocker lock(&registryMutex);
+	std::list<std::string> names;
+	for (Entries::iterator it = entries.begin(); it != entries.end(); ++it) {
+		if (it->second.kind == kind && it->second.state != MODULE_FAILED) {
+			names.push_back(it->first);
+		}
+	}
+	return names;
+}
+
+}
@@ -0,0 +1,187 @@
+/*
+ * ModuleRegistry.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef MODULEREGISTRY_H_
+#define MODULEREGISTRY_H_
+
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+
+namespace vmi {
+
+class Module;
+
+/**
+ * Kind of a module. Determined from its base class by the LOADMODULE() macro.
+ */
+typedef enum {
+	MODULE_OTHER = 0,      //!< Any other subclass of vmi::Module.
+	MODULE_SENSOR,         //!< Subclass of vmi::SensorModule.
+	MODULE_DETECTION,      //!< Subclass of vmi::DetectionModule.
+	MODULE_NOTIFICATION,   //!< Subclass of vmi::NotificationModule.
+} eModuleKind;
+
+/**
+ * State of a registered module.
+ */
+typedef enum {
+	MODULE_UNKNOWN = 0,    //!< Module not registered.
+	MODULE_REGISTERED,     //!< Object file loaded, module not constructed yet.
+	MODULE_CONSTRUCTING,   //!< Constructor is running.
+	MODULE_ACTIVE,         //!< Module constructed.
+	MODULE_FAILED,         //!< Constructor threw an exception. The module is not retried.
+} eModuleState;
+
+/**
+ * @class ModuleRegistry ModuleRegistry.h "vmiids/ModuleRegistry.h"
+ * @brief Manifest of the modules found in the loaded object files.
+ * @sa LOADMODULE
+ *
+ * Loading an object file only registers its modules, together with the names of the modules
+ * they depend on. No module is constructed while the object file is loaded.
+ *
+ * The dependencies form a directed acyclic graph. Modules are constructed by activate(), either
+ * in bulk at startup or lazily on their first use: SensorModule::getSensorModule() and
+ * DetectionModule::getDetectionModuleHandle() construct a registered module, which is not
+ * constructed yet. The dependencies of a module are constructed before the module itself.
+ * activateModules() starts to construct a module in parallel, as soon as its dependencies are
+ * constructed. Modules requested by a constructor, which were not declared, are added to the graph.
+ *
+ * destroyModules() deletes the modules in reverse topological order: a module is deleted before
+ * the modules it depends on. NotificationModules are deleted last.
+ *
+ * A module is constructed once. Threads requesting a module, which is being constructed by another
+ * thread, wait for the constructor to finish. Cyclic dependencies are detected and fail.
+ */
+class ModuleRegistry {
+public:
+	typedef vmi::Module *(*Factory)(void);  //!< Function constructing a module.
+
+private:
+	/**
+	 * Manifest entry of a module.
+	 */
+	struct Entry {
+		eModuleKind kind;                        //!< Kind of the module.
+		Factory factory;                         //!< Constructs the module.
+		std::vector<std::string> dependencies;   //!< Modules to construct before this one.
+		eModuleState state;                      //!< State of the module.
+		pthread_t owner;                         //!< Thread running the constructor.
+		vmi::Module *module;                     //!< Constructed module. NULL, if not active.
+	};
+	typedef std::map<std::string, Entry> Entries;
+	typedef std::vector<std::pair<pthread_t, std::string> > ThreadModules;
+
+	Entries entries;                   //!< Registered modules, keyed by name.
+	ThreadModules waiting;             //!< Threads waiting for a constructor.
+	ThreadModules constructing;        //!< Threads running a constructor, innermost last.
+	volatile unsigned int constructors;  //!< Number of constructors running.
+	pthread_mutex_t registryMutex;     //!< Protects entries, waiting and constructing.
+	pthread_cond_t constructed;        //!< Signaled when a constructor has finished.
+
+	static ModuleRegistry *instance;   //!< Instance of the ModuleRegistry (Singleton)
+
+	/**
+	 * Check, whether waiting for a module constructed by another thread would deadlock.
+	 * Must be called with registryMutex held.
+	 * @param entry Module being constructed.
+	 * @return True, if the constructing thread waits (directly or indirectly) for this thread.
+	 */
+	bool waitsForSelf(const Entry &entry);
+	/**
+	 * Collect a module and its registered dependencies, which are not constructed yet.
+	 * Must be called with registryMutex held.
+	 */
+	void collectPending(const std::string &name, std::set<std::string> &pending);
+	/**
+	 * Add a module requested by the constructor running in this thread to its dependencies.
+	 * Must be called with registryMutex held.
+	 */
+	void addDependency(const std::string &name);
+	/**
+	 * Compute the depth of a module in the dependency graph. Modules without dependencies have
+	 * a depth of zero. Must be called with registryMutex held.
+	 * @param name Name of the module.
+	 * @param depths Depths computed so far. A depth of -1 marks a module being visited.
+	 * @return Depth of the module.
+	 */
+	int getDepth(const std::string &name, std::map<std::string, int> &depths);
+
+	ModuleRegistry();
+	ModuleRegistry(const ModuleRegistry&);
+	ModuleRegistry& operator=(const ModuleRegistry&);
+
+public:
+	virtual ~ModuleRegistry();
+
+	/**
+	 * @return Instance of the ModuleRegistry.
+	 */
+	static ModuleRegistry *getInstance();
+
+	/**
+	 * Register a module. Called by the LOADMODULE() macro, while the object file is loaded.
+	 * A module registered twice keeps its first registration.
+	 *
+	 * @param name Name of the module.
+	 * @param kind Kind of the module.
+	 * @param factory Function constructing the module.
+	 * @param dependencies Names of the modules it depends on, separated by whitespace.
+	 */
+	void registerModule(std::string name, eModuleKind kind, Factory factory,
+			std::string dependencies);
+
+	/**
+	 * Construct a module and its dependencies, if they are not constructed yet.
+	 * Waits, if another thread is constructing the module.
+	 *
+	 * @param name Name of the module.
+	 * @return True, if the module is constructed. False, if it is not registered or failed.
+	 */
+	bool activate(std::string name);
+
+	/**
+	 * Construct a set of modules, their dependencies and all NotificationModules, which are not
+	 * constructed yet. Modules, whose dependencies are constructed, are constructed in parallel.
+	 *
+	 * @param names Names of the modules.
+	 */
+	void activateModules(const std::set<std::string> &names);
+
+	/**
+	 * Delete all constructed modules in reverse topological order. The modules are registered
+	 * afterwards, so they can be constructed again.
+	 */
+	void destroyModules();
+
+	/**
+	 * @return True, if a constructor is running. Lookups should call activate() meanwhile,
+	 *         so the dependencies of the constructed modules are recorded. Lock-free.
+	 */
+	bool isConstructing() const { return constructors > 0; }
+
+	/**
+	 * @param name Name of the module.
+	 * @return State of the module.
+	 */
+	eModuleState getState(std::string name);
+
+	/**
+	 * @param kind Kind of the modules.
+	 * @return Names of the registered modules of a kind, which did not fail. Sorted by name.
+	 */
+	std::list<std::string> getModuleNames(eModuleKind kind);
+};
+
+}
+
+#endif /* MODULEREGISTRY_H_ */
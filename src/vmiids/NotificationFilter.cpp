@@ -0,0 +1,229 @@
+/*
+ * NotificationFilter.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#include "NotificationFilter.h"
+
+#include <cstdio>
+#include <string>
+
+#define FILTER_PROBES        8        //!< Number of entries or buckets searched for a notification.
+#define FILTER_SWEEP_PERIOD  1000000  //!< Time (in us) between two sweeps for expired entries.
+#define FILTER_TOKEN         1000000  //!< Cost of a notification in the token buckets.
+
+namespace vmi {
+
+/**
+ * FNV-1a hash. Used as fingerprint of notifications.
+ */
+static uint64_t fingerprint(uint64_t hash, const char *data, size_t length){
+	for (size_t i = 0; i < length; i++) {
+		hash ^= (unsigned char) data[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+static uint64_t toMicroseconds(const struct timeval &time){
+	return (uint64_t) time.tv_sec * 1000000 + time.tv_usec;
+}
+
+NotificationFilter::NotificationFilter(size_t tableSize, size_t bucketCount) {
+	size_t size = 1;
+	while (size < tableSize) size <<= 1;
+	Entry emptyEntry = { 0, 0, 0, NULL };
+	this->entries.resize(size, emptyEntry);
+
+	size = 1;
+	while (size < bucketCount) size <<= 1;
+	Bucket emptyBucket = { 0, 0, 0, 0, 0, OUTPUT_DEBUG, NULL };
+	this->buckets.resize(size, emptyBucket);
+
+	this->suppressionWindow = 0;
+	this->rateLimit = 0;
+	this->rateBurst = 0;
+	this->exemptLevel = OUTPUT_CRITICAL;
+	this->lastSweep = 0;
+	this->suppressed = 0;
+}
+
+NotificationFilter::~NotificationFilter() {
+	for (std::vector<Entry>::iterator it = this->entries.begin(); it != this->entries.end(); ++it) {
+		NotificationRecord::destroy(it->sample);
+	}
+	for (std::vector<Bucket>::iterator it = this->buckets.begin(); it != this->buckets.end(); ++it) {
+		NotificationRecord::destroy(it->sample);
+	}
+	for (std::vector<NotificationRecord *>::iterator it = this->pending.begin(); it != this->pending.end(); ++it) {
+		NotificationRecord::destroy(*it);
+	}
+}
+
+void NotificationFilter::setPolicy(unsigned int suppressionWindow, unsigned int rateLimit, unsigned int rateBurst,
+		DEBUG_LEVEL exemptLevel){
+	this->suppressionWindow = (uint64_t) suppressionWindow * 1000000;
+	this->rateLimit = rateLimit;
+	this->rateBurst = (rateBurst > 0) ? rateBurst : 1;
+	this->exemptLevel = exemptLevel;
+}
+
+void NotificationFilter::releaseEntry(Entry &entry){
+	if (entry.repeats > 0 && entry.sample != NULL) {
+		char count[64];
+		snprintf(count, sizeof(count), "Last message repeated %u times: ", entry.repeats);
+		std::string message(count);
+		message.append(entry.sample->getMessage(), entry.sample->messageLength);
+		if (message[message.size() - 1] != '\n') message.append("\n");
+		NotificationRecord *summary = NotificationRecord::create(entry.sample->severity,
+				entry.sample->getModule(), entry.sample->moduleLength, message.data(), message.size());
+		if (summary != NULL) this->pending.push_back(summary);
+	}
+	NotificationRecord::destroy(entry.sample);
+	entry.key = 0;
+	entry.firstSeen = 0;
+	entry.repeats = 0;
+	entry.sample = NULL;
+}
+
+void NotificationFilter::releaseBucket(Bucket &bucket){
+	if (bucket.dropped > 0 && bucket.sample != NULL) {
+		char message[96];
+		int length = snprintf(message, sizeof(message), "%u notifications suppressed by rate limit\n", bucket.dropped);
+		NotificationRecord *summary = NotificationRecord::create(bucket.severity,
+				bucket.sample->getModule(), bucket.sample->moduleLength, message, length);
+		if (summary != NULL) this->pending.push_back(summary);
+	}
+	NotificationRecord::destroy(bucket.sample);
+	bucket.dropped = 0;
+	bucket.severity = OUTPUT_DEBUG;
+	bucket.sample = NULL;
+}
+
+NotificationFilter::Bucket &NotificationFilter::findBucket(uint64_t moduleHash){
+	size_t mask = this->buckets.size() - 1;
+	Bucket *target = NULL;
+	for (size_t probe = 0; probe < FILTER_PROBES; probe++) {
+		Bucket &bucket = this->buckets[(moduleHash + probe) & mask];
+		if (bucket.key == moduleHash) {
+			return bucket;
+		}
+		if (target == NULL || bucket.key == 0 ||
+				(target->key != 0 && bucket.lastRefill < target->lastRefill)) {
+			target = &bucket;
+		}
+	}
+	// Take over the bucket. Drops of its previous module are reported now.
+	this->releaseBucket(*target);
+	target->key = moduleHash;
+	target->tokens = 0;
+	target->lastRefill = 0;
+	target->lastSummary = 0;
+	return *target;
+}
+
+bool NotificationFilter::accept(const NotificationRecord &record){
+	if (record.severity >= this->exemptLevel) {
+		return true;
+	}
+
+	uint64_t now = toMicroseconds(record.time);
+	uint64_t moduleHash = fingerprint(0xcbf29ce484222325ULL, record.getModule(), record.moduleLength);
+	if (moduleHash == 0) moduleHash = 1;
+
+	// Entry to start a new suppression window in, once the notification has passed the rate limit.
+	Entry *seed = NULL;
+	uint64_t key = 0;
+	if (this->suppressionWindow > 0) {
+		char severity = record.severity;
+		key = fingerprint(fingerprint(moduleHash, &severity, 1), record.getMessage(), record.messageLength);
+		if (key == 0) key = 1;
+
+		size_t mask = this->entries.size() - 1;
+		Entry *target = NULL;
+		for (size_t probe = 0; probe < FILTER_PROBES; probe++) {
+			Entry &entry = this->entries[(key + probe) & mask];
+			if (entry.key == key) {
+				// Records are created by concurrent threads, so now may be earlier than firstSeen.
+				if (now < entry.firstSeen + this->suppressionWindow) {
+					entry.repeats++;
+					this->suppressed++;
+					return false;
+				}
+				// Window has passed. Report the repetitions and start a new window.
+				target = &entry;
+				break;
+			}
+			if (target == NULL || entry.key == 0 ||
+					(target->key != 0 && entry.firstSeen < target->firstSeen)) {
+				target = &entry;
+			}
+		}
+		seed = target;
+	}
+
+	if (this->rateLimit > 0) {
+		Bucket &bucket = this->findBucket(moduleHash);
+		uint64_t capacity = this->rateBurst * FILTER_TOKEN;
+		if (bucket.lastRefill == 0) {
+			bucket.tokens = capacity;
+		} else if (now > bucket.lastRefill) {
+			uint64_t elapsed = now - bucket.lastRefill;
+			if (elapsed >= capacity / this->rateLimit) {
+				bucket.tokens = capacity;
+			} else {
+				bucket.tokens += elapsed * this->rateLimit;
+				if (bucket.tokens > capacity) bucket.tokens = capacity;
+			}
+		}
+		bucket.lastRefill = now;
+		if (bucket.tokens < FILTER_TOKEN) {
+			if (bucket.sample == NULL) {
+				bucket.sample = NotificationRecord::create(record.severity, record.getModule(),
+						record.moduleLength, "", 0);
+				bucket.lastSummary = now;
+			}
+			if (record.severity > bucket.severity) bucket.severity = record.severity;
+			bucket.dropped++;
+			this->suppressed++;
+			return false;
+		}
+		bucket.tokens -= FILTER_TOKEN;
+	}
+
+	if (seed != NULL) {
+		// Only delivered notifications are sampled, so a summary never repeats a message nobody received.
+		this->releaseEntry(*seed);
+		seed->key = key;
+		seed->firstSeen = now;
+		seed->sample = NotificationRecord::create(record.severity, record.getModule(), record.moduleLength,
+				record.getMessage(), record.messageLength);
+	}
+	return true;
+}
+
+void NotificationFilter::collectSummaries(const struct timeval &now,
+		std::vector<NotificationRecord *> &summaries, bool all){
+	uint64_t time = toMicroseconds(now);
+
+	if (all || time >= this->lastSweep + FILTER_SWEEP_PERIOD) {
+		this->lastSweep = time;
+		for (std::vector<Entry>::iterator it = this->entries.begin(); it != this->entries.end(); ++it) {
+			if (it->key != 0 && (all || time >= it->firstSeen + this->suppressionWindow)) {
+				this->releaseEntry(*it);
+			}
+		}
+		for (std::vector<Bucket>::iterator it = this->buckets.begin(); it != this->buckets.end(); ++it) {
+			if (it->dropped > 0 && (all || time >= it->lastSummary + FILTER_SWEEP_PERIOD)) {
+				this->releaseBucket(*it);
+			}
+		}
+	}
+
+	summaries.insert(summaries.end(), this->pending.begin(), this->pending.end());
+	this->pending.clear();
+}
+
+}
@@ -0,0 +1,142 @@
+/*
+ * NotificationFilter.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef NOTIFICATIONFILTER_H_
+#define NOTIFICATIONFILTER_H_
+
+#include "NotificationModule.h"
+
+#include <vector>
+#include <stdint.h>
+
+namespace vmi {
+
+/**
+ * @class NotificationFilter NotificationFilter.h "vmiids/NotificationFilter.h"
+ * @brief Deduplication and rate limiting of notifications.
+ * @sa NotificationModule
+ *
+ * The filter is applied by the NotificationModule dispatcher before a notification is passed
+ * to the NotificationModules. It is not thread safe; the dispatcher calls it with the
+ * dispatch mutex of NotificationModule.cpp held.
+ *
+ * Deduplication: A notification is identified by its module, severity and message.
+ * The first occurrence, which passes the rate limit, is passed and starts the suppression
+ * window. Repetitions within the window are counted and dropped. When the window has passed, a single summary "Last message repeated N times"
+ * is emitted. Recent notifications are kept in a bounded hash table. If the table is full,
+ * the oldest entry of a bucket is evicted and its summary is emitted early.
+ *
+ * Rate limiting: Each module owns a token bucket, found by the hash of its name in a bounded
+ * table like the deduplication entries. Notifications exceeding the rate are dropped and
+ * reported in a summary once per second. If the probed buckets all belong to other modules,
+ * the least recently used one is taken over and its summary is emitted early.
+ *
+ * Notifications at or above the exempt severity (OUTPUT_CRITICAL by default) are never
+ * deduplicated or rate limited, so every alert is delivered.
+ *
+ * Summaries are emitted by collectSummaries() and are not filtered themselves.
+ */
+class NotificationFilter {
+private:
+	/**
+	 * Entry of the deduplication table.
+	 */
+	struct Entry {
+		uint64_t key;              //!< Fingerprint of module, severity and message. Zero if unused.
+		uint64_t firstSeen;        //!< Time the suppression window started (us).
+		uint32_t repeats;          //!< Number of suppressed repetitions.
+		NotificationRecord *sample; //!< Copy of the first notification. Used for the summary.
+	};
+	/**
+	 * Token bucket of the rate limiter.
+	 */
+	struct Bucket {
+		uint64_t key;              //!< Hash of the module name. Zero if unused.
+		uint64_t tokens;           //!< Available tokens in millionths of a token.
+		uint64_t lastRefill;       //!< Time of the last refill (us).
+		uint64_t lastSummary;      //!< Time of the last rate limit summary (us).
+		uint32_t dropped;          //!< Number of notifications dropped since the last summary.
+		DEBUG_LEVEL severity;      //!< Highest severity dropped since the last summary.
+		NotificationRecord *sample; //!< Copy of the first dropped notification. Used for the summary.
+	};
+
+	std::vector<Entry> entries;    //!< Deduplication table. Size is a power of two.
+	std::vector<Bucket> buckets;   //!< Token buckets. Size is a power of two.
+	std::vector<NotificationRecord *> pending;  //!< Summaries of evicted entries.
+
+	uint64_t suppressionWindow;    //!< Suppression window (us). Zero disables deduplication.
+	uint64_t rateLimit;            //!< Notifications per second and module. Zero disables rate limiting.
+	uint64_t rateBurst;            //!< Maximum burst of notifications per module.
+	DEBUG_LEVEL exemptLevel;       //!< Lowest severity passed without filtering.
+	uint64_t lastSweep;            //!< Time of the last sweep for expired entries (us).
+	uint64_t suppressed;           //!< Number of notifications suppressed since start.
+
+	/**
+	 * Fill the summary of a deduplication entry into pending and reset the entry.
+	 */
+	void releaseEntry(Entry &entry);
+	/**
+	 * Fill the summary of a token bucket into pending.
+	 */
+	void releaseBucket(Bucket &bucket);
+	/**
+	 * Find the token bucket of a module. Takes over the least recently used bucket probed,
+	 * if the module has none.
+	 */
+	Bucket &findBucket(uint64_t moduleHash);
+
+public:
+	/**
+	 * Constructor. The filter is disabled until setPolicy() is called.
+	 *
+	 * @param tableSize Number of entries of the deduplication table. Rounded up to a power of two.
+	 * @param bucketCount Number of token buckets. Rounded up to a power of two.
+	 */
+	NotificationFilter(size_t tableSize = 4096, size_t bucketCount = 256);
+	/**
+	 * Destructor
+	 */
+	virtual ~NotificationFilter();
+
+	/**
+	 * Set the filter policy.
+	 *
+	 * @param suppressionWindow Seconds a repeated notification is suppressed. Zero disables deduplication.
+	 * @param rateLimit Notifications per second and module. Zero disables rate limiting.
+	 * @param rateBurst Maximum burst of notifications per module.
+	 * @param exemptLevel Notifications of this or a higher severity are always passed.
+	 */
+	void setPolicy(unsigned int suppressionWindow, unsigned int rateLimit, unsigned int rateBurst,
+			DEBUG_LEVEL exemptLevel = OUTPUT_CRITICAL);
+
+	/**
+	 * Check whether a notification should be passed to the NotificationModules.
+	 *
+	 * @param record Notification to check.
+	 * @return True, if the notification is passed. False, if it is suppressed.
+	 */
+	bool accept(const NotificationRecord &record);
+
+	/**
+	 * Collect the summaries of suppressed notifications.
+	 * Expired entries are searched at most once per second, unless all is set.
+	 *
+	 * @param now Current time.
+	 * @param summaries Vector to append the summaries to. The caller must destroy them.
+	 * @param all Emit all summaries, even if their suppression window has not passed.
+	 */
+	void collectSummaries(const struct timeval &now, std::vector<NotificationRecord *> &summaries, bool all);
+
+	/**
+	 * @return Number of notifications suppressed since start.
+	 */
+	uint64_t getSuppressedCount() const { return suppressed; }
+};
+
+}
+
+#endif /* NOTIFICATIONFILTER_H_ */
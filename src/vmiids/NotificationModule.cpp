@@ -6,112 +6,521 @@
  */
 
 #include "NotificationModule.h"
+#include "NotificationFilter.h"
 
 #include "vmiids/util/MutexLocker.h"
+#include "vmiids/util/Thread.h"
 
 #include "VmiIDS.h"
 
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define DISPATCHER_NONE    0  //!< Dispatcher not yet started.
+#define DISPATCHER_RUNNING 1  //!< Dispatcher running.
+#define DISPATCHER_STOPPED 2  //!< Dispatcher stopped. Notifications are passed directly.
+
+#define DISPATCHER_BATCH          256    //!< Maximum number of records passed to the modules at once.
+#define DISPATCHER_IDLE_TIMEOUT   10000  //!< Time (in us) the idle dispatcher waits for a signal.
+#define DISPATCHER_FLUSH_PERIOD   1000000  //!< Time (in us) between two periodic flushes of the modules.
+
 namespace vmi {
 
-std::map<std::string, vmi::NotificationModule *> NotificationModule::modules;
+/**
+ * @class NotificationModule::Dispatcher
+ * @brief Thread passing queued notifications to the NotificationModules.
+ */
+class NotificationModule::Dispatcher : public vmi::Thread {
+public:
+	virtual void run(void);
+};
+
+vmi::SnapshotRegistry<std::string, vmi::NotificationModule> NotificationModule::modules;
+vmi::SnapshotRegistry<uint32_t, vmi::NotificationModule> NotificationModule::runModules;
 vmi::Mutex NotificationModule::mutex;
 
+NotificationModule::Dispatcher *NotificationModule::dispatcher = NULL;
+volatile int NotificationModule::dispatcherState = DISPATCHER_NONE;
+
+vmi::MpscQueue<NotificationRecord> NotificationModule::queue;
+volatile size_t NotificationModule::queuedRecords = 0;
+volatile size_t NotificationModule::enqueuedRecords = 0;
+volatile size_t NotificationModule::droppedRecords = 0;
+size_t NotificationModule::queueCapacity = 65536;
+DEBUG_LEVEL NotificationModule::blockSeverity = OUTPUT_WARN;
+volatile unsigned int NotificationModule::severityMask = 0;
+
+static pthread_mutex_t dispatcherMutex = PTHREAD_MUTEX_INITIALIZER;  //!< Protects the dispatcher wake up.
+static pthread_cond_t recordsQueued = PTHREAD_COND_INITIALIZER;      //!< Signaled when the idle dispatcher has work.
+static pthread_cond_t recordsDispatched = PTHREAD_COND_INITIALIZER;  //!< Signaled after each dispatched batch.
+static volatile bool dispatcherIdle = false;   //!< Flag, whether the dispatcher waits for records.
+static size_t dispatchedRecords = 0;           //!< Number of dispatched records. Protected by dispatcherMutex.
+static __thread bool isDispatcherThread = false;  //!< Flag, whether the current thread is the dispatcher.
+
+/**
+ * Serializes dispatch() and the filter. Loading and unloading modules does not take it.
+ */
+static pthread_mutex_t dispatchMutex = PTHREAD_MUTEX_INITIALIZER;
+static NotificationFilter filter;  //!< Deduplication and rate limiting. Protected by dispatchMutex.
+static std::vector<NotificationRecord *> summaries;  //!< Summaries to pass. Protected by dispatchMutex.
+
+typedef SnapshotRegistry<std::string, NotificationModule> NamedModuleRegistry;
+typedef SnapshotRegistry<uint32_t, NotificationModule> RunModuleRegistry;
+
 NotificationModule::NotificationModule(std::string moduleName): Module(moduleName) {
+	this->runId = 0;
+	this->attached = false;
+	this->readDebugLevel();
+};
+
+NotificationModule::NotificationModule(std::string moduleName, uint32_t runId): Module(moduleName) {
+	this->runId = runId;
+	this->attached = false;
+	this->readDebugLevel();
+};
+
+NotificationModule::~NotificationModule(){
+	this->detach();
+}
+
+void NotificationModule::attach(){
+	vmi::MutexLocker lock(&mutex);
+	if (this->attached) {
+		return;
+	}
+	if (this->runId != 0) {
+		runModules.insert(this->runId, this);
+	} else {
+		modules.insert(this->getName(), this);
+	}
+	this->attached = true;
+	updateSeverityMask();
+}
+
+void attachModule(NotificationModule *module){
+	module->attach();
+}
+
+void NotificationModule::detach(){
+	vmi::MutexLocker lock(&mutex);
+	if (!this->attached) {
+		return;
+	}
+	// Erasing waits for the dispatcher to leave its read section.
+	if (this->runId != 0) {
+		runModules.erase(this->runId, this);
+	} else {
+		modules.erase(this->getName(), this);
+	}
+	this->attached = false;
+	updateSeverityMask();
+}
+
+bool NotificationModule::parseDebugLevel(const std::string &name, DEBUG_LEVEL &level){
+	if (name.compare("INFO") == 0) {
+		level = vmi::OUTPUT_INFO;
+	} else if (name.compare("DEBUG") == 0) {
+		level = vmi::OUTPUT_DEBUG;
+	} else if (name.compare("WARN") == 0) {
+		level = vmi::OUTPUT_WARN;
+	} else if (name.compare("ERROR") == 0) {
+		level = vmi::OUTPUT_ERROR;
+	} else if (name.compare("CRITICAL") == 0) {
+		level = vmi::OUTPUT_CRITICAL;
+	} else if (name.compare("ALERT") == 0) {
+		level = vmi::OUTPUT_ALERT;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+void NotificationModule::readDebugLevel(){
 	std::string debugLevelString;
 	try{
 		GETOPTION(debugLevel, debugLevelString);
-		if (debugLevelString.compare("INFO") == 0) {
-			this->debugLevel = vmi::OUTPUT_INFO;
-		} else if (debugLevelString.compare("DEBUG") == 0) {
-			this->debugLevel = vmi::OUTPUT_DEBUG;
-		} else if (debugLevelString.compare("WARN") == 0) {
-			this->debugLevel = vmi::OUTPUT_WARN;
-		} else if (debugLevelString.compare("ERROR") == 0) {
-			this->debugLevel = vmi::OUTPUT_ERROR;
-		} else if (debugLevelString.compare("CRITICAL") == 0) {
-			this->debugLevel = vmi::OUTPUT_CRITICAL;
-		} else if (debugLevelString.compare("ALERT") == 0) {
-			this->debugLevel = vmi::OUTPUT_ALERT;
-		} else {
+		if (!parseDebugLevel(debugLevelString, this->debugLevel)) {
 			this->debugLevel = vmi::OUTPUT_INFO;
 		}
 	}catch(OptionNotFoundException &e){
 		this->debugLevel = vmi::OUTPUT_INFO;
 	}
+}
+
+void NotificationModule::flush(){
+}
 
-	mutex.lock();
-	modules[moduleName] = this;
-	mutex.unlock();
+NotificationModule *NotificationModule::getNotificationModule(std::string notificationModuleName){
+	return modules.find(notificationModuleName);
+}
+
+bool NotificationModule::reconfigure(const std::set<std::string> &options){
+	if (options.count("debugLevel") > 0) {
+		this->readDebugLevel();
+		vmi::MutexLocker lock(&mutex);
+		updateSeverityMask();
+	}
+	return options.size() == options.count("debugLevel");
+}
+
+void NotificationModule::updateSeverityMask(){
+	unsigned int mask = 0;
+	NamedModuleRegistry::Reader reader(modules);
+	for (NamedModuleRegistry::Entries::const_iterator it =
+			reader.getEntries().begin(); it
+			!= reader.getEntries().end(); ++it) {
+		// All severities from the modules debugLevel up to OUTPUT_ALERT.
+		mask |= ((1u << (OUTPUT_ALERT + 1)) - 1) & ~((1u << it->second->debugLevel) - 1);
+	}
+	RunModuleRegistry::Reader runReader(runModules);
+	for (RunModuleRegistry::Entries::const_iterator it =
+			runReader.getEntries().begin(); it
+			!= runReader.getEntries().end(); ++it) {
+		mask |= ((1u << (OUTPUT_ALERT + 1)) - 1) & ~((1u << it->second->debugLevel) - 1);
+	}
+	__sync_lock_test_and_set(&severityMask, mask);
+}
+
+/**
+ * Severity prefixes of the formatted notifications. Each is NOTIFICATION_PREFIX_LENGTH characters long.
+ */
+static const char *severityPrefix[] = {
+		"Debug:       ",
+		"Information: ",
+		"Warning:     ",
+		"Error:       ",
+		"Critical:    ",
+		"Alert:       "
 };
 
-NotificationModule::~NotificationModule(){
-	vmi::MutexLocker lock(&mutex);
-	for (std::map<std::string, NotificationModule*>::iterator it =
-			this->modules.begin(); it
-			!= this->modules.end(); ++it) {
-		if (it->first.compare(this->getName()) == 0) {
-			this->modules.erase(it);
+NotificationRecord *NotificationRecord::create(DEBUG_LEVEL severity, const char *module, size_t moduleLength,
+		const char *message, size_t messageLength){
+	size_t textLength = NOTIFICATION_PREFIX_LENGTH + moduleLength + 2 + messageLength;
+	NotificationRecord *record = (NotificationRecord *) malloc(sizeof(NotificationRecord) + textLength);
+	if (record == NULL) return NULL;
+
+	record->next = NULL;
+	record->severity = severity;
+	gettimeofday(&record->time, NULL);
+	record->runId = Thread::getCurrentRunId();
+	record->moduleLength = moduleLength;
+	record->messageLength = messageLength;
+	record->textLength = textLength;
+
+	char *text = record->text;
+	memcpy(text, severityPrefix[severity], NOTIFICATION_PREFIX_LENGTH);
+	text += NOTIFICATION_PREFIX_LENGTH;
+	memcpy(text, module, moduleLength);
+	text += moduleLength;
+	*text++ = ':';
+	*text++ = ' ';
+	memcpy(text, message, messageLength);
+	text[messageLength] = '\0';
+	return record;
+}
+
+void NotificationRecord::destroy(NotificationRecord *record){
+	free(record);
+}
+
+void NotificationModule::notify(DEBUG_LEVEL severity, const char *module, size_t moduleLength,
+		const char *message, size_t messageLength){
+	if (!isEnabled(severity)) return;
+	NotificationRecord *record = NotificationRecord::create(severity, module, moduleLength, message, messageLength);
+	if (record == NULL) {
+		__sync_add_and_fetch(&droppedRecords, 1);
+		return;
+	}
+	enqueue(record);
+}
+
+void NotificationModule::debug(const std::string &module, const std::string &message){
+	notify(OUTPUT_DEBUG, module.data(), module.size(), message.data(), message.size());
+}
+
+void NotificationModule::info(const std::string &module, const std::string &message){
+	notify(OUTPUT_INFO, module.data(), module.size(), message.data(), message.size());
+}
+
+void NotificationModule::warn(const std::string &module, const std::string &message){
+	notify(OUTPUT_WARN, module.data(), module.size(), message.data(), message.size());
+}
+
+void NotificationModule::error(const std::string &module, const std::string &message){
+	notify(OUTPUT_ERROR, module.data(), module.size(), message.data(), message.size());
+}
+
+void NotificationModule::critical(const std::string &module, const std::string &message){
+	notify(OUTPUT_CRITICAL, module.data(), module.size(), message.data(), message.size());
+}
+
+void NotificationModule::alert(const std::string &module, const std::string &message){
+	notify(OUTPUT_ALERT, module.data(), module.size(), message.data(), message.size());
+}
+
+void NotificationModule::enqueue(NotificationRecord *record){
+	if (dispatcherState == DISPATCHER_NONE &&
+			__sync_bool_compare_and_swap(&dispatcherState, DISPATCHER_NONE, DISPATCHER_RUNNING)) {
+		dispatcher = new Dispatcher();
+		dispatcher->start();
+	}
+
+	if (dispatcherState != DISPATCHER_RUNNING) {
+		// The dispatcher is stopped. Pass the notification directly.
+		vmi::MutexLocker lock(&dispatchMutex);
+		dispatch(&record, 1);
+		NotificationRecord::destroy(record);
+		return;
+	}
+
+	if (__sync_add_and_fetch(&queuedRecords, 1) > queueCapacity) {
+		if (record->severity < blockSeverity || isDispatcherThread) {
+			__sync_sub_and_fetch(&queuedRecords, 1);
+			__sync_add_and_fetch(&droppedRecords, 1);
+			NotificationRecord::destroy(record);
+			return;
+		}
+		while (queuedRecords > queueCapacity && dispatcherState == DISPATCHER_RUNNING) {
+			Thread::sleep(1);
 		}
 	}
+
+	__sync_add_and_fetch(&enqueuedRecords, 1);
+	queue.push(record);
+	if (dispatcherIdle) {
+		pthread_mutex_lock(&dispatcherMutex);
+		pthread_cond_signal(&recordsQueued);
+		pthread_mutex_unlock(&dispatcherMutex);
+	}
 }
 
-void NotificationModule::debug(std::string module, std::string message){
-	vmi::MutexLocker lock(&mutex);
-	for (std::map<std::string, NotificationModule*>::iterator it =
-			modules.begin(); it
-			!= modules.end(); ++it) {
-		it->second->doDebug(module, message);
+void NotificationModule::dispatch(NotificationRecord **records, size_t count){
+	size_t passed = 0;
+	// The modules are used within the read sections only. detach() waits for them.
+	NamedModuleRegistry::Reader reader(modules);
+	RunModuleRegistry::Reader runReader(runModules);
+	const NamedModuleRegistry::Entries &sinks = reader.getEntries();
+	for (size_t i = 0; i < count; i++) {
+		if (records[i]->runId != 0) {
+			// Modules capturing a run receive its notifications unfiltered.
+			NotificationModule *capture = runReader.find(records[i]->runId);
+			if (capture != NULL) {
+				capture->doNotify(*records[i]);
+			}
+		}
+		if (!filter.accept(*records[i])) {
+			continue;
+		}
+		passed++;
+		for (NamedModuleRegistry::Entries::const_iterator it =
+				sinks.begin(); it
+				!= sinks.end(); ++it) {
+			it->second->doNotify(*records[i]);
+		}
+	}
+	passed += dispatchSummaries(false);
+	if (passed == 0) {
+		return;
+	}
+	for (NamedModuleRegistry::Entries::const_iterator it =
+			sinks.begin(); it
+			!= sinks.end(); ++it) {
+		it->second->flush();
 	}
 }
 
-void NotificationModule::info(std::string module, std::string message){
-	vmi::MutexLocker lock(&mutex);
-	for (std::map<std::string, NotificationModule*>::iterator it =
-			modules.begin(); it
-			!= modules.end(); ++it) {
-		it->second->doInfo(module, message);
+size_t NotificationModule::dispatchSummaries(bool all){
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	filter.collectSummaries(now, summaries, all);
+	if (summaries.empty()) {
+		return 0;
 	}
+	size_t count = summaries.size();
+	NamedModuleRegistry::Reader reader(modules);
+	for (std::vector<NotificationRecord *>::iterator record = summaries.begin();
+			record != summaries.end(); ++record) {
+		for (NamedModuleRegistry::Entries::const_iterator it =
+				reader.getEntries().begin(); it
+				!= reader.getEntries().end(); ++it) {
+			it->second->doNotify(**record);
+		}
+		NotificationRecord::destroy(*record);
+	}
+	summaries.clear();
+	return count;
 }
 
-void NotificationModule::warn(std::string module, std::string message){
-	vmi::MutexLocker lock(&mutex);
-	for (std::map<std::string, NotificationModule*>::iterator it =
-			modules.begin(); it
-			!= modules.end(); ++it) {
-		it->second->doWarn(module, message);
+/**
+ * Flush all loaded NotificationModules.
+ */
+static void flushModules(const NamedModuleRegistry &modules){
+	NamedModuleRegistry::Reader reader(modules);
+	for (NamedModuleRegistry::Entries::const_iterator it =
+			reader.getEntries().begin(); it
+			!= reader.getEntries().end(); ++it) {
+		it->second->flush();
 	}
 }
 
-void NotificationModule::error(std::string module, std::string message){
-	vmi::MutexLocker lock(&mutex);
-	for (std::map<std::string, NotificationModule*>::iterator it =
-			modules.begin(); it
-			!= modules.end(); ++it) {
-		it->second->doError(module, message);
+/**
+ * Flush all loaded NotificationModules, if the last periodic flush was at least
+ * DISPATCHER_FLUSH_PERIOD ago. Lets modules retry output they could not write before
+ * (e.g. to a slow receiver), even if no new notification reaches them.
+ * Must be called with the dispatchMutex held.
+ */
+static void flushPeriodically(const NamedModuleRegistry &modules, struct timeval &lastFlush){
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	if ((now.tv_sec - lastFlush.tv_sec) * 1000000 + (now.tv_usec - lastFlush.tv_usec) >= DISPATCHER_FLUSH_PERIOD) {
+		lastFlush = now;
+		flushModules(modules);
 	}
 }
 
-void NotificationModule::critical(std::string module, std::string message){
-	vmi::MutexLocker lock(&mutex);
-	for (std::map<std::string, NotificationModule*>::iterator it =
-			modules.begin(); it
-			!= modules.end(); ++it) {
-		it->second->doCritical(module, message);
+void NotificationModule::Dispatcher::run(){
+	isDispatcherThread = true;
+	// The dispatcher is started by the first thread creating a notification and inherits its run ID.
+	// Drop notices and summaries do not belong to that run.
+	Thread::setCurrentRunId(0);
+
+	NotificationRecord *batch[DISPATCHER_BATCH];
+	size_t reportedDrops = 0;
+	struct timeval lastFlush;
+	gettimeofday(&lastFlush, NULL);
+
+	while (true) {
+		size_t count = 0;
+		while (count < DISPATCHER_BATCH && (batch[count] = queue.pop()) != NULL) {
+			count++;
+		}
+
+		if (count == 0) {
+			if (dispatcherState != DISPATCHER_RUNNING && queuedRecords == 0) {
+				break;
+			}
+			// Queue is empty. Sleep until a producer signals a new record.
+			pthread_mutex_lock(&dispatcherMutex);
+			dispatcherIdle = true;
+			__sync_synchronize();
+			if ((batch[0] = queue.pop()) != NULL) {
+				count = 1;
+			} else if (dispatcherState == DISPATCHER_RUNNING) {
+				struct timeval now;
+				struct timespec timeout;
+				gettimeofday(&now, NULL);
+				timeout.tv_sec = now.tv_sec;
+				timeout.tv_nsec = (now.tv_usec + DISPATCHER_IDLE_TIMEOUT) * 1000;
+				if (timeout.tv_nsec >= 1000000000) {
+					timeout.tv_sec++;
+					timeout.tv_nsec -= 1000000000;
+				}
+				pthread_cond_timedwait(&recordsQueued, &dispatcherMutex, &timeout);
+			}
+			dispatcherIdle = false;
+			pthread_mutex_unlock(&dispatcherMutex);
+			if (count == 0) {
+				// Pass summaries of suppressed notifications, even if nothing new arrives.
+				vmi::MutexLocker lock(&dispatchMutex);
+				dispatch(batch, 0);
+				flushPeriodically(modules, lastFlush);
+				continue;
+			}
+		}
+
+		{
+			vmi::MutexLocker lock(&dispatchMutex);
+			dispatch(batch, count);
+			// Batches, which are filtered entirely, do not flush the modules.
+			flushPeriodically(modules, lastFlush);
+		}
+		for (size_t i = 0; i < count; i++) {
+			NotificationRecord::destroy(batch[i]);
+		}
+		__sync_sub_and_fetch(&queuedRecords, count);
+
+		if (droppedRecords != reportedDrops) {
+			char message[64];
+			int length = snprintf(message, sizeof(message), "%lu notifications dropped, queue full\n",
+					(unsigned long) (droppedRecords - reportedDrops));
+			reportedDrops = droppedRecords;
+			NotificationRecord *dropNotice = NotificationRecord::create(OUTPUT_WARN,
+					"NotificationModule", strlen("NotificationModule"), message, length);
+			if (dropNotice != NULL) {
+				vmi::MutexLocker lock(&dispatchMutex);
+				dispatch(&dropNotice, 1);
+				NotificationRecord::destroy(dropNotice);
+			}
+		}
+
+		pthread_mutex_lock(&dispatcherMutex);
+		dispatchedRecords += count;
+		pthread_cond_broadcast(&recordsDispatched);
+		pthread_mutex_unlock(&dispatcherMutex);
 	}
 }
 
-void NotificationModule::alert(std::string module, std::string message){
-	vmi::MutexLocker lock(&mutex);
-	for (std::map<std::string, NotificationModule*>::iterator it =
-			modules.begin(); it
-			!= modules.end(); ++it) {
-		it->second->doAlert(module, message);
+void NotificationModule::setQueuePolicy(size_t capacity, DEBUG_LEVEL blockSeverity){
+	NotificationModule::queueCapacity = (capacity > 0) ? capacity : 1;
+	NotificationModule::blockSeverity = blockSeverity;
+}
+
+void NotificationModule::waitForDispatch(){
+	if (isDispatcherThread) return;
+	size_t target = enqueuedRecords;
+	pthread_mutex_lock(&dispatcherMutex);
+	while (dispatchedRecords < target && dispatcherState == DISPATCHER_RUNNING) {
+		pthread_cond_wait(&recordsDispatched, &dispatcherMutex);
 	}
+	pthread_mutex_unlock(&dispatcherMutex);
+}
+
+size_t NotificationModule::getDroppedCount(){
+	return droppedRecords;
+}
+
+void NotificationModule::setFilterPolicy(unsigned int suppressionWindow, unsigned int rateLimit, unsigned int rateBurst,
+		DEBUG_LEVEL exemptLevel){
+	vmi::MutexLocker lock(&dispatchMutex);
+	filter.setPolicy(suppressionWindow, rateLimit, rateBurst, exemptLevel);
+}
+
+size_t NotificationModule::getSuppressedCount(){
+	vmi::MutexLocker lock(&dispatchMutex);
+	return filter.getSuppressedCount();
 }
 
 void NotificationModule::killInstances(){
-	while (!modules.empty()) {
-		delete modules.begin()->second;
+	if (__sync_bool_compare_and_swap(&dispatcherState, DISPATCHER_RUNNING, DISPATCHER_STOPPED)) {
+		// Wake up the dispatcher and any thread waiting for it. The dispatcher drains the queue.
+		pthread_mutex_lock(&dispatcherMutex);
+		pthread_cond_signal(&recordsQueued);
+		pthread_cond_broadcast(&recordsDispatched);
+		pthread_mutex_unlock(&dispatcherMutex);
+		dispatcher->join();
+		delete dispatcher;
+		dispatcher = NULL;
+	}
+	__sync_bool_compare_and_swap(&dispatcherState, DISPATCHER_NONE, DISPATCHER_STOPPED);
+
+	{
+		vmi::MutexLocker lock(&dispatchMutex);
+		if (dispatchSummaries(true) > 0) {
+			flushModules(modules);
+		}
+	}
+
+	while (true) {
+		NotificationModule *module;
+		{
+			NamedModuleRegistry::Reader reader(modules);
+			if (reader.getEntries().empty()) {
+				break;
+			}
+			module = reader.getEntries().front().second;
+		}
+		delete module;
 	}
 }
 
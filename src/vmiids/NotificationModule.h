@@ -10,6 +10,8 @@
 
 #include "vmiids/Module.h"
 #include "vmiids/util/Mutex.h"
+#include "vmiids/util/MpscQueue.h"
+#include "vmiids/util/SnapshotRegistry.h"
 
 #include <streambuf>
 #include <ostream>
@@ -17,8 +19,89 @@
 #include <map>
 #include <cstring>
 
+#include <sys/time.h>
+#include <stdint.h>
+
 namespace vmi {
 
+/**
+ * @enum DEBUG_LEVEL
+ *
+ * Different levels of severity.
+ */
+typedef enum {
+	OUTPUT_DEBUG = 0,//!< Debug
+	OUTPUT_INFO,     //!< Information
+	OUTPUT_WARN,     //!< Warning
+	OUTPUT_ERROR,    //!< Error
+	OUTPUT_CRITICAL, //!< Critical
+	OUTPUT_ALERT     //!< Alert
+} DEBUG_LEVEL;
+
+/**
+ * Length of the severity prefix in front of every formatted notification (e.g. "Warning:     ").
+ */
+#define NOTIFICATION_PREFIX_LENGTH 13
+
+/**
+ * Notification passed from an OutputModule to the NotificationModules.
+ *
+ * A record is a single allocation. It contains the notification formatted exactly once
+ * as "<severity prefix><module>: <message>". All NotificationModules share this text.
+ * Module name and message are available as parts of the text.
+ *
+ * @sa NotificationModule
+ */
+struct NotificationRecord {
+	NotificationRecord * volatile next;  //!< Next record in the notification queue.
+	DEBUG_LEVEL severity;    //!< Severity of the notification.
+	struct timeval time;     //!< Time the notification was created.
+	uint32_t runId;          //!< Run ID of the thread creating the notification. See Thread::getCurrentRunId().
+	size_t moduleLength;     //!< Length of the module name.
+	size_t messageLength;    //!< Length of the message.
+	size_t textLength;       //!< Length of the formatted text.
+	char text[1];            //!< Formatted text. Null terminated. Allocated along with the record.
+
+	/**
+	 * @return Formatted notification.
+	 */
+	const char *getText() const { return text; }
+	/**
+	 * @return Name of the module which caused the notification. Not null terminated.
+	 */
+	const char *getModule() const { return text + NOTIFICATION_PREFIX_LENGTH; }
+	/**
+	 * @return Message of the notification. Null terminated.
+	 */
+	const char *getMessage() const { return text + NOTIFICATION_PREFIX_LENGTH + moduleLength + 2; }
+
+	/**
+	 * Allocate and format a record.
+	 *
+	 * @param severity Severity of the notification.
+	 * @param module Name of the module which caused the notification.
+	 * @param moduleLength Length of the module name.
+	 * @param message Message of the notification.
+	 * @param messageLength Length of the message.
+	 * @return New record. Must be released with destroy().
+	 */
+	static NotificationRecord *create(DEBUG_LEVEL severity, const char *module, size_t moduleLength,
+			const char *message, size_t messageLength);
+	/**
+	 * Release a record created by create().
+	 *
+	 * @param record Record to release.
+	 */
+	static void destroy(NotificationRecord *record);
+};
+
+/**
+ * Function receiving the contents of a NotificationModuleStreamBuffer.
+ * See NotificationModule::notify().
+ */
+typedef void (*NotifyFunction)(DEBUG_LEVEL severity, const char *module, size_t moduleLength,
+		const char *message, size_t messageLength);
+
 /**
  * @class NotificationModuleStreamBuffer NotificationModule.h "vmiids/NotificationModule.h"
  * @brief VmiIDS Stream buffer
@@ -41,55 +124,67 @@ public:
 	/**
 	 * Constructor
 	 * @param p_name Name of the module this stream buffer referres to.
+	 * @param p_severity Severity of the output written to this stream buffer.
 	 * @param p_notifyFunction Notify function. See NotificationModule.
 	 */
-	NotificationModuleStreamBuffer(std::string p_name,
-			void (*p_notifyFunction)(std::string, std::string)) :
-    	buf(BUF_SIZE), name(p_name), notifyFunction(p_notifyFunction){
-    	std::basic_streambuf<cT, traits>::setp(&buf[0], &buf[0] + buf.capacity());
-    }
+	NotificationModuleStreamBuffer(const std::string &p_name, DEBUG_LEVEL p_severity,
+			NotifyFunction p_notifyFunction) :
+		name(p_name), severity(p_severity), notifyFunction(p_notifyFunction){
+		std::basic_streambuf<cT, traits>::setp(inlineBuffer, inlineBuffer + BUF_SIZE);
+	}
 protected:
 	/**
 	 * Function called whenever the internal buffer is full.
-	 * This function resizes the underlying buffer and enqueues the last byte,
-	 *  which did not fit into the buffer.
+	 * Moves the contents into a larger buffer and appends the last byte,
+	 * which did not fit into the buffer. The larger buffer is kept for later messages.
 	 * @param c Last byte which did not fit into the buffer.
 	 * @return Returns if the buffer is still writable.
 	 */
-    virtual typename traits::int_type overflow(typename traits::int_type c = traits::eof())
-    {
-    	size_t currentptr = buf.capacity();
-    	buf.resize(buf.capacity()*2);
-    	std::basic_streambuf<cT, traits>::setp(&buf[0], &buf[0] + buf.capacity());
-    	std::basic_streambuf<cT, traits>::pbump(currentptr);
-    	*std::basic_streambuf<cT, traits>::pptr() = c;
-    	std::basic_streambuf<cT, traits>::pbump(1);
-    	return traits::not_eof(c);
-    }
-
-    /**
-     * Function called whenever the buffer is about to be flushed.
-     * This function forwards the buffers contents to the dispatcher inside the NotificationModule class.
-     * @return Zero.
-     */
-    virtual int sync(void)
-    {
-        // Handle output
-        notifyFunction(name, std::string(std::basic_streambuf<cT, traits>::pbase(),
-        		std::basic_streambuf<cT, traits>::pptr()));
-
-        // This tells that buffer is empty again
-    	buf.resize(BUF_SIZE);
-    	memset(&buf[0], 0, buf.capacity());
-    	std::basic_streambuf<cT, traits>::setp(&buf[0], &buf[0] + buf.capacity());
-        return 0;
-    }
+	virtual typename traits::int_type overflow(typename traits::int_type c = traits::eof())
+	{
+		cT * base = std::basic_streambuf<cT, traits>::pbase();
+		size_t used = std::basic_streambuf<cT, traits>::pptr() - base;
+		size_t size = 2 * (std::basic_streambuf<cT, traits>::epptr() - base);
+		if (base == inlineBuffer) {
+			if (spillBuffer.size() < size) spillBuffer.resize(size);
+			traits::copy(&spillBuffer[0], inlineBuffer, used);
+		} else {
+			spillBuffer.resize(size);
+		}
+		std::basic_streambuf<cT, traits>::setp(&spillBuffer[0], &spillBuffer[0] + spillBuffer.size());
+		std::basic_streambuf<cT, traits>::pbump(used);
+		if (!traits::eq_int_type(c, traits::eof())) {
+			*std::basic_streambuf<cT, traits>::pptr() = traits::to_char_type(c);
+			std::basic_streambuf<cT, traits>::pbump(1);
+		}
+		return traits::not_eof(c);
+	}
+
+	/**
+	 * Function called whenever the buffer is about to be flushed.
+	 * This function forwards the buffers contents to the dispatcher inside the NotificationModule class.
+	 * The contents are passed without copying them into a temporary string.
+	 * @return Zero.
+	 */
+	virtual int sync(void)
+	{
+		cT * base = std::basic_streambuf<cT, traits>::pbase();
+		size_t used = std::basic_streambuf<cT, traits>::pptr() - base;
+		if (used > 0) {
+			notifyFunction(severity, name.data(), name.size(), base, used);
+		}
+
+		// This tells that buffer is empty again
+		std::basic_streambuf<cT, traits>::setp(inlineBuffer, inlineBuffer + BUF_SIZE);
+		return 0;
+	}
 private:
-    // Work in buffer mode. It is also possible to work without buffer.
-    static size_t const BUF_SIZE = 64; //!< Size of the internal buffer.
-    std::vector<cT> buf; //!< Internal buffer.
-    std::string name; //!< Name of the module this stream buffer referres to.
-    void (*notifyFunction)(std::string, std::string);  //!< Notify function. See NotificationModule.
+	static size_t const BUF_SIZE = 256; //!< Size of the inline buffer.
+	cT inlineBuffer[BUF_SIZE];  //!< Buffer used for regular messages. Avoids heap allocations.
+	std::vector<cT> spillBuffer;  //!< Buffer used for long messages. Kept for reuse.
+	std::string name; //!< Name of the module this stream buffer referres to.
+	DEBUG_LEVEL severity;  //!< Severity of the output written to this stream buffer.
+	NotifyFunction notifyFunction;  //!< Notify function. See NotificationModule.
 };
 
 /**
@@ -114,12 +209,53 @@ public:
 	/**
 	 * Constructor
 	 * @param name Name of the module this stream buffer referres to.
+	 * @param severity Severity of the output written to this stream.
 	 * @param notifyFunction Notify function. See NotificationModule.
 	 */
-	NotificationModuleStreamTemplate(std::string name, void (*notifyFunction)(std::string, std::string)) :
-    	std::basic_ostream< cT, traits >(&buf), buf(name, notifyFunction){}
+	NotificationModuleStreamTemplate(const std::string &name, DEBUG_LEVEL severity, NotifyFunction notifyFunction) :
+    	std::basic_ostream< cT, traits >(&buf), buf(name, severity, notifyFunction), severity(severity){}
+
+	/**
+	 * Write a value to the stream.
+	 * The value is only formatted, if any NotificationModule accepts the streams severity
+	 * (see NotificationModule::isEnabled()).
+	 * @param value Value to write.
+	 * @return This stream.
+	 */
+	template <class T>
+	NotificationModuleStreamTemplate& operator<<(const T &value);
+
+	/**
+	 * Apply a manipulator (e.g. std::endl) to the stream.
+	 * Manipulators are always applied, so a pending message is flushed.
+	 * @param manipulator Manipulator to apply.
+	 * @return This stream.
+	 */
+	NotificationModuleStreamTemplate& operator<<(std::basic_ostream< cT, traits >& (*manipulator)(std::basic_ostream< cT, traits >&)){
+		manipulator(*this);
+		return *this;
+	}
+	/**
+	 * Apply a manipulator to the stream.
+	 * @param manipulator Manipulator to apply.
+	 * @return This stream.
+	 */
+	NotificationModuleStreamTemplate& operator<<(std::basic_ios< cT, traits >& (*manipulator)(std::basic_ios< cT, traits >&)){
+		manipulator(*this);
+		return *this;
+	}
+	/**
+	 * Apply a manipulator (e.g. std::hex) to the stream.
+	 * @param manipulator Manipulator to apply.
+	 * @return This stream.
+	 */
+	NotificationModuleStreamTemplate& operator<<(std::ios_base& (*manipulator)(std::ios_base&)){
+		manipulator(*this);
+		return *this;
+	}
 private:
     NotificationModuleStreamBuffer<cT> buf;  //!< internal stream buffer
+    DEBUG_LEVEL severity;  //!< Severity of the output written to this stream.
 };
 
 /**
@@ -128,12 +264,6 @@ private:
  * One character is 8 bits long (UTF-8).
  */
 typedef NotificationModuleStreamTemplate<char> NotificationStream;
-/**
- * Typedef for easier internal use.
- * This version is used for wchar_t buffers.
- * One character is 16 bits long (UTF-16).
- */
-typedef NotificationModuleStreamTemplate<wchar_t> wNotificationStream;
 
 
 //Throw away all output - see from:
@@ -190,20 +320,6 @@ typedef basic_onullstream<char> nullstream;
  */
 typedef basic_onullstream<wchar_t> wnullstream;
 
-/**
- * @enum DEBUG_LEVEL
- *
- * Different levels of severity.
- */
-typedef enum {
-	OUTPUT_DEBUG = 0,//!< Debug
-	OUTPUT_INFO,     //!< Information
-	OUTPUT_WARN,     //!< Warning
-	OUTPUT_ERROR,    //!< Error
-	OUTPUT_CRITICAL, //!< Critical
-	OUTPUT_ALERT     //!< Alert
-} DEBUG_LEVEL;
-
 /**
  * @class NotificationModule NotificationModule.h "vmiids/NotificationModule.h"
  *
@@ -212,6 +328,28 @@ typedef enum {
  * Notification modules are the basic output mechanism in VmiIDS.
  * The NotificationModule class is a Singleton (Multiton).
  *
+ * Notifications are not passed to the NotificationModules by the thread creating them.
+ * Instead, they are pushed into a lock-free queue, which is drained by a dispatcher thread.
+ * A slow NotificationModule thus does not stall the detection and sensor threads.
+ * The dispatcher passes the notifications to the NotificationModules in batches and calls
+ * flush() once after every batch, and at least once per second, so modules can retry
+ * output they could not write before.
+ *
+ * The queue is bounded. If it is full, notifications with a severity below the block severity
+ * are dropped and counted. Notifications of higher severity block until there is room in the
+ * queue (see setQueuePolicy()).
+ *
+ * Before notifications reach the NotificationModules, repeated notifications are suppressed
+ * and the rate per module is bounded (see setFilterPolicy() and NotificationFilter).
+ * Suppressed notifications are reported in summaries.
+ *
+ * A module receives notifications only after it was attached (see attach()). ModuleLoader attaches
+ * the modules it constructs.
+ *
+ * A NotificationModule constructed with a run ID is not registered globally. It only receives
+ * the notifications of that run (see Thread::getCurrentRunId()), unfiltered. This is used to
+ * capture the output of a single detection run, e.g. for the RPC interface.
+ *
  * @sa OutputModule
  */
 class NotificationModule : public vmi::Module{
@@ -221,12 +359,70 @@ class NotificationModule : public vmi::Module{
 	private:
 		nullstream nullStream;
 
+		uint32_t runId;  //!< Run captured by this module. Zero for globally registered modules.
+		bool attached;   //!< True, while the module is registered with the dispatcher. Protected by mutex.
+
+		/**
+		 * Registry of all loaded instances of NotificationModule class.
+		 * The ModuleName is used as key. Read by the dispatcher without locking.
+		 */
+		static vmi::SnapshotRegistry<std::string, vmi::NotificationModule> modules;
+		/**
+		 * Registry of all modules capturing a single run.
+		 * The run ID is used as key.
+		 */
+		static vmi::SnapshotRegistry<uint32_t, vmi::NotificationModule> runModules;
+		static vmi::Mutex mutex;  //!< Serializes loading and unloading of modules.
+
+		class Dispatcher;
+		static Dispatcher *dispatcher;  //!< Thread passing queued notifications to the modules.
+		static volatile int dispatcherState;  //!< Dispatcher state. See NotificationModule.cpp.
+
+		static vmi::MpscQueue<NotificationRecord> queue;  //!< Queue of pending notifications.
+		static volatile size_t queuedRecords;    //!< Number of records in the queue.
+		static volatile size_t enqueuedRecords;  //!< Number of records enqueued since start.
+		static volatile size_t droppedRecords;   //!< Number of records dropped since start.
+		static size_t queueCapacity;             //!< Maximum number of records in the queue.
+		static DEBUG_LEVEL blockSeverity;        //!< Lowest severity, which blocks on a full queue.
+
+		/**
+		 * Bit mask of all severities accepted by at least one NotificationModule.
+		 * Bit n is set for severity n. Recomputed whenever a module is loaded or unloaded.
+		 */
+		static volatile unsigned int severityMask;
+
+		/**
+		 * Recompute the severityMask from the debugLevel of all loaded and capturing modules.
+		 * Must be called with the mutex held.
+		 */
+		static void updateSeverityMask();
+
+		/**
+		 * Queue a notification for the dispatcher.
+		 *
+		 * @param record Notification to queue. Released by the dispatcher.
+		 */
+		static void enqueue(NotificationRecord *record);
+		/**
+		 * Pass a batch of notifications to all NotificationModules and flush them.
+		 *
+		 * @param records Notifications to pass.
+		 * @param count Number of notifications.
+		 */
+		static void dispatch(NotificationRecord **records, size_t count);
+		/**
+		 * Pass the summaries of suppressed notifications to all NotificationModules.
+		 * Must be called by the dispatching thread (see dispatch()).
+		 *
+		 * @param all Pass all summaries, even if their suppression window has not passed.
+		 * @return Number of summaries passed.
+		 */
+		static size_t dispatchSummaries(bool all);
+
 		/**
-		 * Map of all loaded instances of NotificationModule class.
-		 * The ModuleName is used as key.
+		 * Read the debugLevel option of the module.
 		 */
-		static std::map<std::string, vmi::NotificationModule *> modules;
-		static vmi::Mutex mutex;  //!< Mutex to handle reentrance.
+		void readDebugLevel();
 
 	public:
 		/**
@@ -238,108 +434,191 @@ class NotificationModule : public vmi::Module{
 		 * @param moduleName Name of the detectionModule
 		 */
 		NotificationModule(std::string moduleName);
+		/**
+		 * Constructor for modules capturing a single run.
+		 *
+		 * The module is not registered globally and only receives notifications tagged with runId, once it is attached.
+		 * Options are read from the section moduleName.
+		 *
+		 * @param moduleName Name of the module.
+		 * @param runId Run to capture. See Thread::createRunId().
+		 */
+		NotificationModule(std::string moduleName, uint32_t runId);
 		/**
 		 * Destructor
 		 */
 		virtual ~NotificationModule();
 
 		/**
-		 * Debug Output function.
-		 * This function must be implemented by NotificationModules.
-		 *
-		 * @param module Name of the module which caused the output.
-		 * @param message Message to output.
+		 * Start passing notifications to the module. Called once the module is fully constructed,
+		 * never by a constructor, as the dispatcher may use the module right away.
 		 */
-		virtual void doDebug(std::string module, std::string message) = 0;
+		void attach();
 
 		/**
-		 * Information Output function.
-		 * This function must be implemented by NotificationModules.
+		 * Stop passing notifications to the module. When the function returns, the dispatcher
+		 * does not use the module anymore.
 		 *
-		 * @param module Name of the module which caused the output.
-		 * @param message Message to output.
+		 * Subclasses call this function first in their destructor, so the dispatcher never calls
+		 * doNotify() or flush() on a partially destroyed module. The destructor calls it, if
+		 * it was not called before.
 		 */
-		virtual void doInfo(std::string module, std::string message) = 0;
+		void detach();
 
 		/**
-		 * WArning Output function.
+		 * Output function.
 		 * This function must be implemented by NotificationModules.
+		 * It is called by the dispatcher thread only.
 		 *
-		 * @param module Name of the module which caused the output.
-		 * @param message Message to output.
+		 * The record is shared by all NotificationModules. Modules must check the
+		 * severity of the record against their debugLevel.
+		 *
+		 * @param record Notification to output.
 		 */
-		virtual void doWarn(std::string module, std::string message) = 0;
+		virtual void doNotify(const NotificationRecord &record) = 0;
 
 		/**
-		 * Error Output function.
-		 * This function must be implemented by NotificationModules.
-		 *
-		 * @param module Name of the module which caused the output.
-		 * @param message Message to output.
+		 * Called after a batch of notifications was passed to the module and at least once per second.
+		 * Modules buffering their output should write it here, instead of after every message.
 		 */
-		virtual void doError(std::string module, std::string message) = 0;
+		virtual void flush();
 
 		/**
-		 * Critical Output function.
-		 * This function must be implemented by NotificationModules.
+		 * Apply a changed debugLevel. Subclasses handle their own options and pass the
+		 * remaining ones to this function.
+		 * @sa Module::reconfigure()
+		 */
+		virtual bool reconfigure(const std::set<std::string> &options);
+
+		/**
+		 * Queue a notification for all NotificationModules.
+		 * Used by the streams of the OutputModule.
 		 *
+		 * @param severity Severity of the notification.
 		 * @param module Name of the module which caused the output.
+		 * @param moduleLength Length of the module name.
 		 * @param message Message to output.
+		 * @param messageLength Length of the message.
 		 */
-		virtual void doCritical(std::string module, std::string message) = 0;
+		static void notify(DEBUG_LEVEL severity, const char *module, size_t moduleLength,
+				const char *message, size_t messageLength);
 
 		/**
-		 * Alert Output function.
-		 * This function must be implemented by NotificationModules.
+		 * Check, whether any NotificationModule accepts notifications of a severity.
+		 * Used to skip formatting of messages nobody would output.
 		 *
-		 * @param module Name of the module which caused the output.
-		 * @param message Message to output.
+		 * @param severity Severity to check.
+		 * @return True, if notifications of this severity are output.
 		 */
-		virtual void doAlert(std::string module, std::string message) = 0;
+		static bool isEnabled(DEBUG_LEVEL severity){
+			return (severityMask & (1u << severity)) != 0;
+		}
 
 		/**
 		 * Dispatcher for Debug output
 		 * @param module Name of the module which caused the output.
 		 * @param message Message to output
 		 */
-		static void debug(std::string module, std::string message);
+		static void debug(const std::string &module, const std::string &message);
 		/**
 		 * Dispatcher for Info output
 		 * @param module Name of the module which caused the output.
 		 * @param message Message to output
 		 */
-		static void info(std::string module, std::string message);
+		static void info(const std::string &module, const std::string &message);
 		/**
 		 * Dispatcher for Warn output
 		 * @param module Name of the module which caused the output.
 		 * @param message Message to output
 		 */
-		static void warn(std::string module, std::string message);
+		static void warn(const std::string &module, const std::string &message);
 		/**
 		 * Dispatcher for Error output
 		 * @param module Name of the module which caused the output.
 		 * @param message Message to output
 		 */
-		static void error(std::string module, std::string message);
+		static void error(const std::string &module, const std::string &message);
 		/**
 		 * Dispatcher for Critical output
 		 * @param module Name of the module which caused the output.
 		 * @param message Message to output
 		 */
-		static void critical(std::string module, std::string message);
+		static void critical(const std::string &module, const std::string &message);
 		/**
 		 * Dispatcher for Alert output
 		 * @param module Name of the module which caused the output.
 		 * @param message Message to output
 		 */
-		static void alert(std::string module, std::string message);
+		static void alert(const std::string &module, const std::string &message);
+
+		/**
+		 * Set the bounds of the notification queue.
+		 *
+		 * @param capacity Maximum number of notifications in the queue.
+		 * @param blockSeverity Notifications of at least this severity wait for room in a full queue.
+		 *                      Notifications of lower severity are dropped.
+		 */
+		static void setQueuePolicy(size_t capacity, DEBUG_LEVEL blockSeverity);
+
+		/**
+		 * Block until all notifications created before the call were passed to the NotificationModules.
+		 */
+		static void waitForDispatch();
+
+		/**
+		 * @return Number of notifications dropped because the queue was full.
+		 */
+		static size_t getDroppedCount();
+
+		/**
+		 * Set the deduplication and rate limiting policy (see NotificationFilter).
+		 *
+		 * @param suppressionWindow Seconds a repeated notification is suppressed. Zero disables deduplication.
+		 * @param rateLimit Notifications per second and module passed to the NotificationModules.
+		 *                  Zero disables rate limiting.
+		 * @param rateBurst Maximum burst of notifications per module.
+		 * @param exemptLevel Notifications of this or a higher severity are never filtered.
+		 */
+		static void setFilterPolicy(unsigned int suppressionWindow, unsigned int rateLimit, unsigned int rateBurst,
+				DEBUG_LEVEL exemptLevel = OUTPUT_CRITICAL);
+
+		/**
+		 * Convert the name of a severity, as used in the configuration file, to a DEBUG_LEVEL.
+		 *
+		 * @param name Name of the severity ("DEBUG", "INFO", "WARN", "ERROR", "CRITICAL" or "ALERT").
+		 * @param level Receives the severity. Untouched, if the name is unknown.
+		 * @return True, if the name is known.
+		 */
+		static bool parseDebugLevel(const std::string &name, DEBUG_LEVEL &level);
+
+		/**
+		 * @return Number of notifications suppressed by deduplication and rate limiting.
+		 */
+		static size_t getSuppressedCount();
+
+		/**
+		 * Request a pointer to a loaded NotificationModule.
+		 * @param notificationModuleName Name of the requested NotificationModule.
+		 * @return Pointer to the NotificationModule. NULL, if the module is not loaded.
+		 */
+		static vmi::NotificationModule *getNotificationModule(std::string notificationModuleName);
 
 		/**
 		 * Clear list of active NotificationModules.
+		 * Pending notifications are passed to the modules before.
 		 */
 		static void killInstances();
 };
 
+template <class cT, class traits>
+template <class T>
+NotificationModuleStreamTemplate<cT, traits>& NotificationModuleStreamTemplate<cT, traits>::operator<<(const T &value){
+	if (NotificationModule::isEnabled(severity)) {
+		static_cast<std::basic_ostream< cT, traits >&>(*this) << value;
+	}
+	return *this;
+}
+
 }
 
 #endif /* NOTIFICATIONMODULE_H_ */
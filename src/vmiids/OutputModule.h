@@ -11,6 +11,7 @@
 #include "NotificationModule.h"
 #include <cstdio>
 #include <cstdarg>
+#include <vector>
 
 
 namespace vmi {
@@ -25,8 +26,12 @@ namespace vmi {
  * To output data, a Module must extend this class.
  *
  * Each message is prepended with the Name of the module causing the message.
+ * Output of a severity no NotificationModule accepts is discarded before it is formatted.
  */
 class OutputModule {
+	private:
+	std::string moduleName; //!< Name to be prepended in front of any output.
+
 	protected:
 	/**
 	 * Debug stream
@@ -53,6 +58,34 @@ class OutputModule {
 	 */
 	vmi::NotificationStream alert;
 
+	/**
+	 * Format a message and pass it to the NotificationModules.
+	 *
+	 * Short messages are formatted on the stack, longer messages are not truncated.
+	 * The message is passed to the NotificationModules without using the streams,
+	 * so the functions may be called concurrently.
+	 *
+	 * @param severity Severity of the message.
+	 * @param format Format string
+	 * @param args Arguments of the format string.
+	 */
+	void print(DEBUG_LEVEL severity, const char * format, va_list args){
+	  if(!vmi::NotificationModule::isEnabled(severity)) return;
+	  char string[256];
+	  va_list argsCopy;
+	  va_copy (argsCopy, args);
+	  int length = vsnprintf(string, sizeof(string), format, argsCopy);
+	  va_end (argsCopy);
+	  if(length <= 0) return;
+	  if((size_t) length < sizeof(string)){
+	    vmi::NotificationModule::notify(severity, moduleName.data(), moduleName.size(), string, length);
+	    return;
+	  }
+	  std::vector<char> longString(length + 1);
+	  vsnprintf(&longString[0], longString.size(), format, args);
+	  vmi::NotificationModule::notify(severity, moduleName.data(), moduleName.size(), &longString[0], length);
+	}
+
 	/**
 	 * C-style debug function.
 	 *
@@ -64,11 +97,7 @@ class OutputModule {
 	void printDebug(const char * format, ...){
 	  va_list args;
 	  va_start (args, format);
-	  char string[1024] = {0};
-	  int length = vsnprintf(string, 1024, format, args);
-	  if(length == 0) return;
-	  debug << string;
-	  debug.flush();
+	  print(vmi::OUTPUT_DEBUG, format, args);
 	  va_end (args);
 	}
 
@@ -83,11 +112,7 @@ class OutputModule {
 	void printInfo(const char * format, ...){
 	  va_list args;
 	  va_start (args, format);
-	  char string[1024] = {0};
-	  int length = vsnprintf(string, 1024, format, args);
-	  if(length == 0) return;
-	  info << string;
-	  info.flush();
+	  print(vmi::OUTPUT_INFO, format, args);
 	  va_end (args);
 	}
 
@@ -102,10 +127,7 @@ class OutputModule {
 	void printWarn(const char * format, ...){
 	  va_list args;
 	  va_start (args, format);
-	  char string[1024] = {0};
-	  int length = vsnprintf(string, 1024, format, args);
-	  if(length == 0) return;
-	  warn << string;
+	  print(vmi::OUTPUT_WARN, format, args);
 	  va_end (args);
 	}
 
@@ -120,11 +142,7 @@ class OutputModule {
 	void printError(const char * format, ...){
 	  va_list args;
 	  va_start (args, format);
-	  char string[1024] = {0};
-	  int length = vsnprintf(string, 1024, format, args);
-	  if(length == 0) return;
-	  error << string;
-	  error.flush();
+	  print(vmi::OUTPUT_ERROR, format, args);
 	  va_end (args);
 	}
 
@@ -139,11 +157,7 @@ class OutputModule {
 	void printCritical(const char * format, ...){
 	  va_list args;
 	  va_start (args, format);
-	  char string[1024] = {0};
-	  int length = vsnprintf(string, 1024, format, args);
-	  if(length == 0) return;
-	  critical << string;
-	  critical.flush();
+	  print(vmi::OUTPUT_CRITICAL, format, args);
 	  va_end (args);
 	}
 
@@ -158,11 +172,7 @@ class OutputModule {
 	void printAlert(const char * format, ...){
 	  va_list args;
 	  va_start (args, format);
-	  char string[1024] = {0};
-	  int length = vsnprintf(string, 1024, format, args);
-	  if(length == 0) return;
-	  alert << string;
-	  alert.flush();
+	  print(vmi::OUTPUT_ALERT, format, args);
 	  va_end (args);
 	}
 
@@ -172,12 +182,13 @@ class OutputModule {
 	 * @param moduleName Name to be prepended in front of any output.
 	 */
 	OutputModule(std::string moduleName) :
-			debug(moduleName, vmi::NotificationModule::debug),
-			info(moduleName, vmi::NotificationModule::info),
-			warn(moduleName, vmi::NotificationModule::warn),
-			error(moduleName, vmi::NotificationModule::error),
-			critical(moduleName, vmi::NotificationModule::critical),
-			alert(moduleName, vmi::NotificationModule::alert){};
+			moduleName(moduleName),
+			debug(moduleName, vmi::OUTPUT_DEBUG, vmi::NotificationModule::notify),
+			info(moduleName, vmi::OUTPUT_INFO, vmi::NotificationModule::notify),
+			warn(moduleName, vmi::OUTPUT_WARN, vmi::NotificationModule::notify),
+			error(moduleName, vmi::OUTPUT_ERROR, vmi::NotificationModule::notify),
+			critical(moduleName, vmi::OUTPUT_CRITICAL, vmi::NotificationModule::notify),
+			alert(moduleName, vmi::OUTPUT_ALERT, vmi::NotificationModule::notify){};
 
 	/**
 	 * Destructor
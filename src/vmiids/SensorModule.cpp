@@ -7,12 +7,10 @@
 
 #include "SensorModule.h"
 
-#include "vmiids/util/MutexLocker.h"
-
 namespace vmi {
 
-std::map<std::string, vmi::SensorModule *> vmi::SensorModule::modules;
-vmi::Mutex vmi::SensorModule::mutex;
+vmi::SnapshotRegistry<std::string, vmi::SensorModule> vmi::SensorModule::modules;
+vmi::HandleTable<vmi::SensorModule> vmi::SensorModule::handles;
 
 vmi::SensorModule::SensorModule(std::string moduleName) :
 					vmi::Module(moduleName),
@@ -20,34 +18,68 @@ vmi::SensorModule::SensorModule(std::string moduleName) :
 
 	debug << "Loading Module" << std::endl;
 
-	mutex.lock();
-	modules[moduleName] = this;
-	mutex.unlock();
+	handle = handles.acquire(this);
+	modules.insert(moduleName, this);
 };
 
 vmi::SensorModule::~SensorModule(){
 	debug << "Unloading Module" << std::endl;
-	vmi::MutexLocker lock(&mutex);
-	for (std::map<std::string, SensorModule*>::iterator it =
-			this->modules.begin(); it
-			!= this->modules.end(); ++it) {
-		if (it->first.compare(this->getName()) == 0) {
-			this->modules.erase(it);
-		}
-	}
+	handles.release(handle);
+	modules.erase(this->getName(), this);
 };
 
 vmi::SensorModule *vmi::SensorModule::getSensorModule(std::string moduleName) {
-	vmi::MutexLocker lock(&mutex);
-    if(modules.find(moduleName) == modules.end()){
-    	return NULL;
-    }
-   	return modules[moduleName];
+	SensorModule *module = modules.find(moduleName);
+	// While a constructor runs, the request is passed to the registry to record the dependency.
+	if ((module == NULL || ModuleRegistry::getInstance()->isConstructing()) &&
+			ModuleRegistry::getInstance()->activate(moduleName)) {
+		module = modules.find(moduleName);
+	}
+	return module;
+}
+
+vmi::SensorModule *vmi::SensorModule::getSensorModule(const SensorModuleHandle &handle) {
+	return handles.resolve(handle);
+}
+
+vmi::SensorModuleHandle vmi::SensorModule::getSensorModuleHandle(std::string moduleName) {
+	if (modules.find(moduleName) == NULL || ModuleRegistry::getInstance()->isConstructing()) {
+		ModuleRegistry::getInstance()->activate(moduleName);
+	}
+	SnapshotRegistry<std::string, SensorModule>::Reader reader(modules);
+	SensorModule *module = reader.find(moduleName);
+	if (module == NULL) {
+		return SensorModuleHandle();
+	}
+	return module->handle;
+}
+
+const vmi::SensorModuleHandle &vmi::SensorModule::getHandle() const {
+	return handle;
+}
+
+std::list<std::string> SensorModule::getListOfSensorModules(){
+	SnapshotRegistry<std::string, SensorModule>::Reader reader(modules);
+	std::list<std::string> sensorModules;
+	// The snapshot is sorted by name.
+	for (SnapshotRegistry<std::string, SensorModule>::Entries::const_iterator it =
+		reader.getEntries().begin(); it != reader.getEntries().end(); ++it) {
+		sensorModules.push_back(it->first);
+	}
+	return sensorModules;
 }
 
 void SensorModule::killInstances(){
-	while (!modules.empty()) {
-		delete modules.begin()->second;
+	while (true) {
+		SensorModule *module;
+		{
+			SnapshotRegistry<std::string, SensorModule>::Reader reader(modules);
+			if (reader.getEntries().empty()) {
+				break;
+			}
+			module = reader.getEntries().front().second;
+		}
+		delete module;
 	}
 }
 
@@ -11,9 +11,21 @@
 #include "Module.h"
 #include "OutputModule.h"
 
-#include "vmiids/util/Mutex.h"
+#include "vmiids/util/SnapshotRegistry.h"
+#include "vmiids/util/HandleTable.h"
+
+#include <list>
+#include <string>
 
 namespace vmi {
+
+class SensorModule;
+
+/**
+ * Stable handle of a loaded SensorModule. Becomes stale when the module is unloaded.
+ */
+typedef vmi::Handle<SensorModule> SensorModuleHandle;
+
 /**
  * @class SensorModule SensorModule.h "vmiids/SensorModule.h"
  * @brief Sensor modules - Generate a view from the monitored machines state.
@@ -29,17 +41,20 @@ namespace vmi {
 class SensorModule : public vmi::Module, protected OutputModule{
 private:
 	/**
-	 * Map of SensorModules currently loaded into the framework. The modules are hashed with
-	 * the name of the sensor module as key. This map is static and contains a list of all
-	 * instances of this class. Detection modules are enqueued in the Constructor.
+	 * Registry of SensorModules currently loaded into the framework. The modules are keyed with
+	 * the name of the sensor module. This registry is static and contains all
+	 * instances of this class. Sensor modules are registered in the Constructor.
+	 * Lookups do not lock.
 	 *
 	 * TODO Currently modules can not be unloaded.
 	 */
-	static std::map<std::string, vmi::SensorModule *> modules;
+	static vmi::SnapshotRegistry<std::string, vmi::SensorModule> modules;
 	/**
-	 * Mutex for the modules map. Allow multithreaded access to different sensor modules.
+	 * Handles of the loaded SensorModules. Resolving a handle does not lock.
 	 */
-	static vmi::Mutex mutex;
+	static vmi::HandleTable<vmi::SensorModule> handles;
+
+	SensorModuleHandle handle;  //!< Handle of this module.
 public:
 		/**
 		 * Constructor
@@ -57,11 +72,39 @@ public:
 
 		/**
 		 * Request a pointer to a special SensorModules.
+		 * A registered module, which is not constructed yet, is constructed.
 		 * @param sensorModuleName Name of the requested SensorModule.
 		 * @return Pointer to the SensorModule.
 		 */
 		static vmi::SensorModule *getSensorModule(std::string sensorModuleName);
 
+		/**
+		 * Request a pointer to a special SensorModule by its handle. Lock-free.
+		 * Modules holding a handle instead of a pointer detect an unloaded dependency.
+		 * @param handle Handle of the requested SensorModule.
+		 * @return Pointer to the SensorModule. NULL, if the handle is stale.
+		 */
+		static vmi::SensorModule *getSensorModule(const SensorModuleHandle &handle);
+
+		/**
+		 * Request the handle of a special SensorModule.
+		 * A registered module, which is not constructed yet, is constructed.
+		 * @param sensorModuleName Name of the requested SensorModule.
+		 * @return Handle of the SensorModule. Invalid, if the module is not loaded.
+		 */
+		static SensorModuleHandle getSensorModuleHandle(std::string sensorModuleName);
+
+		/**
+		 * @return Handle of the current SensorModule.
+		 */
+		const SensorModuleHandle &getHandle() const;
+
+		/**
+		 * Request a list of currently loaded SensorModules.
+		 * @return List of Names of currently loaded sensor modules.
+		 */
+		static std::list<std::string> getListOfSensorModules();
+
 		/**
 		 * Delete all currently loaded DetectionModule instances.
 		 */
@@ -77,6 +120,9 @@ public:
  * @sa vmi::VmiIDS
  *
  * This macro is used by detection modules to load special sensor modules.
+ * A registered sensor module, which is not constructed yet, is constructed first, so the
+ * result does not depend on the order the object files were loaded in. Modules should
+ * nevertheless declare the sensor modules they use with LOADMODULE_DEPENDS().
  * If the dependency is not found a vmi::DependencyNotFoundException is thrown.
  */
 #define GETSENSORMODULE(variable, modulename) \
@@ -0,0 +1,290 @@
+/*
+ * ThreatLevelService.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#include "ThreatLevelService.h"
+
+#include "vmiids/util/MutexLocker.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#include <sys/time.h>
+
+#define THREATLEVEL_DEFAULT_HALFLIFE 300   //!< Default half-life of the scores (s).
+
+namespace vmi {
+
+static uint64_t currentTime(){
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	return (uint64_t) now.tv_sec * 1000000 + now.tv_usec;
+}
+
+ThreatLevelAggregate::ThreatLevelAggregate(unsigned int halfLife) {
+	this->decay = (halfLife > 0) ? M_LN2 / ((double) halfLife * 1000000) : 0;
+	this->sequence = 0;
+	this->sum = 0;
+	this->reference = 0;
+	this->count = 0;
+}
+
+ThreatLevelAggregate::~ThreatLevelAggregate() {
+}
+
+void ThreatLevelAggregate::publish(double sum, uint64_t reference, uint32_t count){
+	__sync_add_and_fetch(&this->sequence, 1);
+	this->sum = sum;
+	this->reference = reference;
+	this->count = count;
+	__sync_add_and_fetch(&this->sequence, 1);
+}
+
+void ThreatLevelAggregate::update(const DetectionModuleHandle &handle, float score, uint64_t time){
+	vmi::MutexLocker lock(&mutex);
+	// Reports may arrive slightly out of order. Never move the reference time backwards.
+	uint64_t reference = (time > this->reference) ? time : this->reference;
+	double sum = this->sum * exp(-this->decay * (double) (reference - this->reference));
+	uint32_t count = this->count;
+
+	std::map<DetectionModuleHandle, Contribution>::iterator it = this->contributions.find(handle);
+	if (it != this->contributions.end()) {
+		sum -= it->second.score * exp(-this->decay * (double) (reference - it->second.time));
+		if (sum < 0) sum = 0;
+	} else {
+		count++;
+	}
+	Contribution &contribution = this->contributions[handle];
+	contribution.score = score;
+	contribution.time = time;
+	sum += score * exp(-this->decay * (double) (reference - time));
+
+	this->publish(sum, reference, count);
+}
+
+void ThreatLevelAggregate::remove(const DetectionModuleHandle &handle){
+	vmi::MutexLocker lock(&mutex);
+	if (this->contributions.erase(handle) == 0) {
+		return;
+	}
+	// Recalculate from scratch, so rounding errors of the incremental updates do not accumulate.
+	double sum = 0;
+	for (std::map<DetectionModuleHandle, Contribution>::iterator it = this->contributions.begin();
+			it != this->contributions.end(); ++it) {
+		sum += it->second.score * exp(-this->decay * (double) (this->reference - it->second.time));
+	}
+	this->publish(sum, this->reference, this->contributions.size());
+}
+
+float ThreatLevelAggregate::getThreatLevel(uint64_t now) const {
+	double sum;
+	uint64_t reference;
+	uint32_t count;
+	uint32_t start;
+	do {
+		start = this->sequence;
+		__sync_synchronize();
+		sum = this->sum;
+		reference = this->reference;
+		count = this->count;
+		__sync_synchronize();
+	} while ((start & 1) || start != this->sequence);
+
+	if (count == 0) {
+		return 0;
+	}
+	if (now > reference) {
+		sum *= exp(-this->decay * (double) (now - reference));
+	}
+	return sum / count;
+}
+
+uint32_t ThreatLevelAggregate::getModuleCount() const {
+	return this->count;
+}
+
+ThreatLevelService::ModuleScore ThreatLevelService::scores[HANDLETABLE_CAPACITY];
+ThreatLevelAggregate *ThreatLevelService::global = NULL;
+vmi::SnapshotRegistry<uint32_t, ThreatLevelAggregate> ThreatLevelService::schedules;
+vmi::Mutex ThreatLevelService::scheduleMutex;
+unsigned int ThreatLevelService::halfLife = THREATLEVEL_DEFAULT_HALFLIFE;
+
+void ThreatLevelService::setHalfLife(unsigned int seconds){
+	ThreatLevelService::halfLife = seconds;
+}
+
+ThreatLevelAggregate *ThreatLevelService::getGlobal(){
+	if (global == NULL) {
+		ThreatLevelAggregate *aggregate = new ThreatLevelAggregate(halfLife);
+		if (!__sync_bool_compare_and_swap(&global, (ThreatLevelAggregate *) NULL, aggregate)) {
+			delete aggregate;
+		}
+	}
+	return global;
+}
+
+void ThreatLevelService::writeScore(const DetectionModuleHandle &handle, const std::string &name,
+		float score, uint64_t time){
+	if (!handle.isValid() || handle.index >= HANDLETABLE_CAPACITY) {
+		return;
+	}
+	ModuleScore &slot = scores[handle.index];
+	uint32_t start;
+	// Writers of the same slot exclude each other by making the sequence odd.
+	do {
+		start = slot.sequence;
+	} while ((start & 1) || !__sync_bool_compare_and_swap(&slot.sequence, start, start + 1));
+
+	if (slot.generation != handle.generation) {
+		slot.generation = handle.generation;
+		strncpy(slot.name, name.c_str(), THREATLEVEL_NAME_LENGTH - 1);
+		slot.name[THREATLEVEL_NAME_LENGTH - 1] = '\0';
+	}
+	slot.score = score;
+	slot.time = time;
+
+	__sync_synchronize();
+	slot.sequence = start + 2;
+}
+
+bool ThreatLevelService::readScore(size_t index, ModuleScore &copy){
+	const ModuleScore &slot = scores[index];
+	uint32_t start;
+	do {
+		start = slot.sequence;
+		__sync_synchronize();
+		copy.generation = slot.generation;
+		copy.score = slot.score;
+		copy.time = slot.time;
+		memcpy(copy.name, slot.name, THREATLEVEL_NAME_LENGTH);
+		__sync_synchronize();
+	} while ((start & 1) || start != slot.sequence);
+	copy.name[THREATLEVEL_NAME_LENGTH - 1] = '\0';
+	return copy.generation != 0;
+}
+
+void ThreatLevelService::report(DetectionModule *module){
+	uint64_t time = currentTime();
+	float score = module->getThreatLevel();
+	writeScore(module->getHandle(), module->getName(), score, time);
+	getGlobal()->update(module->getHandle(), score, time);
+}
+
+void ThreatLevelService::report(DetectionModule *module, uint32_t schedule){
+	uint64_t time = currentTime();
+	float score = module->getThreatLevel();
+	writeScore(module->getHandle(), module->getName(), score, time);
+	getGlobal()->update(module->getHandle(), score, time);
+
+	// removeSchedule() does not delete the aggregate while it is updated in the read section.
+	SnapshotRegistry<uint32_t, ThreatLevelAggregate>::Reader reader(schedules);
+	ThreatLevelAggregate *aggregate = reader.find(schedule);
+	if (aggregate != NULL) {
+		aggregate->update(module->getHandle(), score, time);
+	}
+}
+
+void ThreatLevelService::removeModule(const DetectionModuleHandle &handle){
+	if (!handle.isValid() || handle.index >= HANDLETABLE_CAPACITY) {
+		return;
+	}
+	ModuleScore &slot = scores[handle.index];
+	uint32_t start;
+	do {
+		start = slot.sequence;
+	} while ((start & 1) || !__sync_bool_compare_and_swap(&slot.sequence, start, start + 1));
+	if (slot.generation == handle.generation) {
+		slot.generation = 0;
+	}
+	__sync_synchronize();
+	slot.sequence = start + 2;
+
+	getGlobal()->remove(handle);
+	vmi::MutexLocker lock(&scheduleMutex);
+	SnapshotRegistry<uint32_t, ThreatLevelAggregate>::Reader reader(schedules);
+	for (SnapshotRegistry<uint32_t, ThreatLevelAggregate>::Entries::const_iterator it =
+			reader.getEntries().begin(); it != reader.getEntries().end(); ++it) {
+		it->second->remove(handle);
+	}
+}
+
+void ThreatLevelService::addSchedule(uint32_t schedule){
+	vmi::MutexLocker lock(&scheduleMutex);
+	if (schedules.find(schedule) == NULL) {
+		schedules.insert(schedule, new ThreatLevelAggregate(halfLife));
+	}
+}
+
+void ThreatLevelService::removeSchedule(uint32_t schedule){
+	vmi::MutexLocker lock(&scheduleMutex);
+	ThreatLevelAggregate *aggregate = schedules.find(schedule);
+	if (aggregate != NULL && schedules.erase(schedule, aggregate)) {
+		// No reader uses the aggregate after erase() returned.
+		delete aggregate;
+	}
+}
+
+float ThreatLevelService::getGlobalThreatLevel(){
+	return getGlobal()->getThreatLevel(currentTime());
+}
+
+float ThreatLevelService::getScheduleThreatLevel(uint32_t schedule){
+	SnapshotRegistry<uint32_t, ThreatLevelAggregate>::Reader reader(schedules);
+	ThreatLevelAggregate *aggregate = reader.find(schedule);
+	if (aggregate == NULL) {
+		return 0;
+	}
+	return aggregate->getThreatLevel(currentTime());
+}
+
+bool ThreatLevelService::getModuleThreatLevel(const DetectionModuleHandle &handle, float &score, uint64_t &time){
+	if (!handle.isValid() || handle.index >= HANDLETABLE_CAPACITY) {
+		return false;
+	}
+	ModuleScore copy;
+	if (!readScore(handle.index, copy) || copy.generation != handle.generation) {
+		return false;
+	}
+	score = copy.score;
+	time = copy.time;
+	return true;
+}
+
+std::string ThreatLevelService::getReport(){
+	uint64_t now = currentTime();
+	std::stringstream report;
+	char line[128];
+
+	ThreatLevelAggregate *aggregate = getGlobal();
+	snprintf(line, sizeof(line), "Global threat level: %.3f (%u modules)\n",
+			aggregate->getThreatLevel(now), aggregate->getModuleCount());
+	report << line;
+
+	{
+		SnapshotRegistry<uint32_t, ThreatLevelAggregate>::Reader reader(schedules);
+		for (SnapshotRegistry<uint32_t, ThreatLevelAggregate>::Entries::const_iterator it =
+				reader.getEntries().begin(); it != reader.getEntries().end(); ++it) {
+			snprintf(line, sizeof(line), "Schedule %us: %.3f (%u modules)\n",
+					it->first, it->second->getThreatLevel(now), it->second->getModuleCount());
+			report << line;
+		}
+	}
+
+	ModuleScore copy;
+	for (size_t i = 0; i < HANDLETABLE_CAPACITY; i++) {
+		if (!readScore(i, copy)) {
+			continue;
+		}
+		snprintf(line, sizeof(line), "Module %s: %.3f (%lus ago)\n", copy.name, copy.score,
+				(unsigned long) ((now > copy.time) ? (now - copy.time) / 1000000 : 0));
+		report << line;
+	}
+	return report.str();
+}
+
+}
@@ -0,0 +1,213 @@
+/*
+ * ThreatLevelService.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef THREATLEVELSERVICE_H_
+#define THREATLEVELSERVICE_H_
+
+#include "DetectionModule.h"
+
+#include "vmiids/util/Mutex.h"
+#include "vmiids/util/SnapshotRegistry.h"
+#include "vmiids/util/HandleTable.h"
+
+#include <map>
+#include <string>
+#include <stdint.h>
+
+#define THREATLEVEL_NAME_LENGTH 64   //!< Maximum length of a module name kept with its score.
+
+namespace vmi {
+
+/**
+ * @class ThreatLevelAggregate ThreatLevelService.h "vmiids/ThreatLevelService.h"
+ * @brief Exponentially decayed average of the threat levels of a group of DetectionModules.
+ * @sa ThreatLevelService
+ *
+ * The aggregate keeps the last score reported by each module of the group. The score of
+ * a module decays with its age, so a module, which has not confirmed its threat level for a
+ * while, contributes less. The aggregate is the average of the decayed scores:
+ *
+ * level(now) = sum(score_i * 2^(-(now - time_i) / halfLife)) / count
+ *
+ * The sum is kept relative to a reference time and updated incrementally with each report.
+ * Updates are serialized by a mutex, getThreatLevel() does not lock.
+ */
+class ThreatLevelAggregate {
+private:
+	/**
+	 * Last report of a module.
+	 */
+	struct Contribution {
+		float score;      //!< Reported threat level.
+		uint64_t time;    //!< Time of the report (us).
+	};
+
+	std::map<DetectionModuleHandle, Contribution> contributions;  //!< Reports by module. Protected by mutex.
+	vmi::Mutex mutex;              //!< Serializes updates.
+
+	double decay;                  //!< Decay rate (1/us).
+
+	volatile uint32_t sequence;    //!< Sequence counter of the published state. Odd while writing.
+	double sum;                    //!< Decayed sum of the scores at reference time.
+	uint64_t reference;            //!< Reference time of sum (us).
+	uint32_t count;                //!< Number of modules contributing.
+
+	/**
+	 * Publish a new state for lock-free readers. Must be called with the mutex held.
+	 */
+	void publish(double sum, uint64_t reference, uint32_t count);
+
+public:
+	/**
+	 * Constructor
+	 * @param halfLife Time (in seconds) after which a score has decayed to half of its value.
+	 */
+	ThreatLevelAggregate(unsigned int halfLife);
+	/**
+	 * Destructor
+	 */
+	virtual ~ThreatLevelAggregate();
+
+	/**
+	 * Replace the score of a module.
+	 * @param handle Handle of the module.
+	 * @param score New threat level of the module.
+	 * @param time Time of the report (us).
+	 */
+	void update(const DetectionModuleHandle &handle, float score, uint64_t time);
+	/**
+	 * Remove a module from the aggregate.
+	 * @param handle Handle of the module.
+	 */
+	void remove(const DetectionModuleHandle &handle);
+
+	/**
+	 * Lock-free.
+	 * @param now Current time (us).
+	 * @return Decayed average threat level. Zero, if no module has reported yet.
+	 */
+	float getThreatLevel(uint64_t now) const;
+	/**
+	 * @return Number of modules contributing to the aggregate.
+	 */
+	uint32_t getModuleCount() const;
+};
+
+/**
+ * @class ThreatLevelService ThreatLevelService.h "vmiids/ThreatLevelService.h"
+ * @brief Collects the threat levels of the DetectionModules.
+ * @sa DetectionModule
+ * @sa DetectionThread
+ *
+ * After each run of a DetectionModule, its threat level is reported to this service.
+ * The service keeps:
+ *  - the last score and time of each module, indexed by its handle,
+ *  - a decayed average over all modules, which have run (global threat level),
+ *  - a decayed average for each schedule, keyed by the time between two runs.
+ *
+ * Modules, which have never run, do not contribute. All queries are lock-free and do not
+ * access the DetectionModule registry. Reports of different modules do not contend.
+ *
+ * The half-life of the scores is read from the threatLevel setting (see VmiIDS::loadModules()).
+ */
+class ThreatLevelService {
+private:
+	/**
+	 * Last score of a module. Written and read under a sequence counter.
+	 */
+	struct ModuleScore {
+		volatile uint32_t sequence;   //!< Sequence counter. Odd while writing.
+		uint32_t generation;          //!< Generation of the module handle. Zero if unused.
+		float score;                  //!< Last reported threat level.
+		uint64_t time;                //!< Time of the last report (us).
+		char name[THREATLEVEL_NAME_LENGTH];  //!< Name of the module.
+	};
+
+	static ModuleScore scores[HANDLETABLE_CAPACITY];   //!< Scores, indexed by module handle.
+	static ThreatLevelAggregate *global;               //!< Aggregate of all modules.
+	static vmi::SnapshotRegistry<uint32_t, ThreatLevelAggregate> schedules;  //!< Aggregates of the schedules.
+	static vmi::Mutex scheduleMutex;                   //!< Serializes creating and removing schedules.
+	static unsigned int halfLife;                      //!< Half-life of the scores (s).
+
+	/**
+	 * Write the score of a module.
+	 */
+	static void writeScore(const DetectionModuleHandle &handle, const std::string &name, float score, uint64_t time);
+
+	/**
+	 * Read the score of a module.
+	 * @return False, if the slot is not in use.
+	 */
+	static bool readScore(size_t index, ModuleScore &copy);
+
+	static ThreatLevelAggregate *getGlobal();
+
+public:
+	/**
+	 * Set the half-life of the scores. Must be called before the first report.
+	 * @param seconds Time after which a score has decayed to half of its value.
+	 */
+	static void setHalfLife(unsigned int seconds);
+
+	/**
+	 * Report the threat level of a module, which was run directly.
+	 * @param module Module, which has finished its run.
+	 */
+	static void report(DetectionModule *module);
+	/**
+	 * Report the threat level of a module, which was run by a schedule.
+	 * The aggregate of the schedule is only updated, if it exists. Late reports of removed
+	 * schedules thus do not recreate their aggregate.
+	 * @param module Module, which has finished its run.
+	 * @param schedule Time between two runs of the schedule.
+	 */
+	static void report(DetectionModule *module, uint32_t schedule);
+
+	/**
+	 * Remove a module from all aggregates. Called when the module is unloaded.
+	 * @param handle Handle of the module.
+	 */
+	static void removeModule(const DetectionModuleHandle &handle);
+	/**
+	 * Create the aggregate of a schedule, if it does not exist. Called when a schedule is created
+	 * or retimed, before its thread reports.
+	 * @param schedule Time between two runs of the schedule.
+	 */
+	static void addSchedule(uint32_t schedule);
+	/**
+	 * Remove the aggregate of a schedule. Called when the schedule is deleted.
+	 * Waits for reports updating the aggregate.
+	 * @param schedule Time between two runs of the schedule.
+	 */
+	static void removeSchedule(uint32_t schedule);
+
+	/**
+	 * @return Decayed average threat level of all modules, which have run.
+	 */
+	static float getGlobalThreatLevel();
+	/**
+	 * @param schedule Time between two runs of the schedule.
+	 * @return Decayed average threat level of the modules of a schedule. Zero for unknown schedules.
+	 */
+	static float getScheduleThreatLevel(uint32_t schedule);
+	/**
+	 * @param handle Handle of the module.
+	 * @param score Last reported threat level of the module.
+	 * @param time Time of the last report (us since epoch).
+	 * @return False, if the module has not reported yet.
+	 */
+	static bool getModuleThreatLevel(const DetectionModuleHandle &handle, float &score, uint64_t &time);
+
+	/**
+	 * @return Human readable report of all threat levels. One line per global, schedule and module score.
+	 */
+	static std::string getReport();
+};
+
+}
+
+#endif /* THREATLEVELSERVICE_H_ */
@@ -11,6 +11,8 @@
 #include <cstdlib>
 #include <unistd.h>
 #include <cstring>
+#include <map>
+#include <vector>
 
 #include <dlfcn.h>
 #include <dirent.h>
@@ -20,10 +22,15 @@
 
 #include "vmiids/util/MutexLocker.h"
 
+#include "ModuleRegistry.h"
 #include "NotificationModule.h"
+#include "ThreatLevelService.h"
 
 vmi::VmiIDS* vmi::VmiIDS::instance = NULL;
-std::map<int, vmi::DetectionThread*> vmi::VmiIDS::runModules;
+vmi::SnapshotRegistry<uint32_t, vmi::DetectionThread> vmi::VmiIDS::schedules;
+std::list<vmi::DetectionThread *> vmi::VmiIDS::retiredSchedules;
+vmi::Mutex vmi::VmiIDS::retiredMutex;
+volatile sig_atomic_t vmi::VmiIDS::reloadRequested = 0;
 
 vmi::VmiIDS::VmiIDS() :
 		 vmi::Module("VmiIDS"), vmi::OutputModule("VmiIDS"),
@@ -38,6 +45,12 @@ vmi::VmiIDS::~VmiIDS() {
 	this->vmiRunning = false;
 	this->join();
 
+	// Running and pending rpc jobs use the modules. They finish before the modules are destroyed.
+	this->rpcServer.stop();
+
+	// Dependent modules are deleted before the modules they use.
+	ModuleRegistry::getInstance()->destroyModules();
+	// Modules not constructed by the registry.
 	DetectionModule::killInstances();
 	SensorModule::killInstances();
 	NotificationModule::killInstances();
@@ -53,54 +66,220 @@ void vmi::VmiIDS::defaultExceptionHandler(std::exception& e){
 	vmi::VmiIDS::getInstance()->error << e.what() << std::endl;
 }
 
-void vmi::VmiIDS::loadModules(){
+void vmi::VmiIDS::applyNotificationFilter(){
+	unsigned int suppressionWindow = 60;
+	unsigned int rateLimit = 100;
+	unsigned int rateBurst = 200;
+	DEBUG_LEVEL exemptLevel = OUTPUT_CRITICAL;
+	try {
+		Settings::Reader reader(*Settings::getInstance());
+		const ConfigValue &setting = reader.getSetting("notificationFilter");
+		setting.lookupValue("suppressionWindow", suppressionWindow);
+		setting.lookupValue("rateLimit", rateLimit);
+		setting.lookupValue("rateBurst", rateBurst);
+		std::string exemptLevelString;
+		if (setting.lookupValue("exemptLevel", exemptLevelString) &&
+				!NotificationModule::parseDebugLevel(exemptLevelString, exemptLevel)) {
+			this->printWarn("Unknown notificationFilter.exemptLevel %s ...\n", exemptLevelString.c_str());
+		}
+	} catch (OptionNotFoundException &e) {
+		this->printDebug("Using default notification filter ...\n");
+	}
+	NotificationModule::setFilterPolicy(suppressionWindow, rateLimit, rateBurst, exemptLevel);
+}
 
-	//
-	// Load Modules by Path Name
-	//
+void vmi::VmiIDS::loadInitialModules(std::string settingName){
+	std::vector<std::string> paths;
 	try {
-		libconfig::Setting &setting = Settings::getInstance()->getSetting("initialModuleByPath");
+		Settings::Reader reader(*Settings::getInstance());
+		const ConfigValue &setting = reader.getSetting(settingName);
 		for (int i = 0; i < setting.getLength(); i++) {
-			this->loadSharedObjectsPath(setting[i]);
+			std::string path;
+			if (setting[i].getValue(path)) {
+				paths.push_back(path);
+			}
 		}
 	} catch (OptionNotFoundException &e) {
-		this->printDebug("No Modules loaded by Path ...\n");
+		this->printDebug("No Modules loaded by %s ...\n", settingName.c_str());
+	}
+	for (std::vector<std::string>::iterator it = paths.begin(); it != paths.end(); ++it) {
+		this->loadSharedObjectsPath(*it);
+	}
+	// Other modules are constructed, when they are scheduled or used.
+	ModuleRegistry::getInstance()->activateModules(std::set<std::string>());
+}
+
+void vmi::VmiIDS::applySchedules(){
+	std::map<uint32_t, std::set<std::string> > configured;
+	{
+		Settings::Reader reader(*Settings::getInstance());
+		const ConfigValue *setting = reader.getSnapshot().find("runModules");
+		if (setting == NULL) {
+			this->printDebug("No DetectionModules started ...\n");
+		}
+		for (int i = 0; setting != NULL && i < setting->getLength(); i++) {
+			const ConfigValue &modulesSetting = (*setting)[i];
+			const ConfigValue *modulesList = modulesSetting.find("modules");
+			int seconds;
+			if (!modulesSetting.lookupValue("secondsBetweenRun", seconds) || modulesList == NULL) {
+				this->printWarn("runModules could not be parsed, schedules not changed ...\n");
+				return;
+			}
+			if (seconds <= 0) {
+				this->printWarn("Schedule of %d seconds could not be created ...\n", seconds);
+				continue;
+			}
+			std::set<std::string> &modules = configured[seconds];
+			for (int j = 0; j < modulesList->getLength(); j++) {
+				std::string module;
+				if (!(*modulesList)[j].getValue(module)) {
+					this->printWarn("runModules could not be parsed, schedules not changed ...\n");
+					return;
+				}
+				modules.insert(module);
+			}
+		}
+	}
+
+	// Construct the scheduled modules and their dependencies in parallel.
+	std::set<std::string> scheduledModules;
+	for (std::map<uint32_t, std::set<std::string> >::iterator it = configured.begin();
+			it != configured.end(); ++it) {
+		scheduledModules.insert(it->second.begin(), it->second.end());
+	}
+	ModuleRegistry::getInstance()->activateModules(scheduledModules);
+
+	std::map<uint32_t, std::vector<std::string> > current;
+	{
+		SnapshotRegistry<uint32_t, DetectionThread>::Reader reader(schedules);
+		for (SnapshotRegistry<uint32_t, DetectionThread>::Entries::const_iterator it =
+				reader.getEntries().begin(); it != reader.getEntries().end(); ++it) {
+			current[it->first] = it->second->getModuleNames();
+		}
+	}
+
+	// Only schedules, which differ from the configuration, are changed.
+	for (std::map<uint32_t, std::vector<std::string> >::iterator it = current.begin();
+			it != current.end(); ++it) {
+		if (configured.find(it->first) == configured.end()) {
+			this->removeSchedule(it->first);
+		}
+	}
+	for (std::map<uint32_t, std::set<std::string> >::iterator it = configured.begin();
+			it != configured.end(); ++it) {
+		std::map<uint32_t, std::vector<std::string> >::iterator running = current.find(it->first);
+		if (running == current.end()) {
+			this->addSchedule(it->first, it->second);
+			continue;
+		}
+		std::set<std::string> scheduled(running->second.begin(), running->second.end());
+		for (std::set<std::string>::iterator module = it->second.begin(); module != it->second.end(); ++module) {
+			if (scheduled.count(*module) == 0 && !this->enqueueDetectionModule(*module, it->first)) {
+				this->printWarn("DetectionModule %s not loaded, not scheduled ...\n", module->c_str());
+			}
+		}
+		for (std::set<std::string>::iterator module = scheduled.begin(); module != scheduled.end(); ++module) {
+			if (it->second.count(*module) == 0) {
+				this->dequeueDetectionModule(*module, it->first);
+			}
+		}
 	}
+}
+
+void vmi::VmiIDS::loadModules(){
 
 	//
-	// Load Modules by Filename
+	// Configure deduplication and rate limiting of notifications
 	//
+	this->applyNotificationFilter();
+
+	//
+	// Configure the decay of threat levels
+	//
+	unsigned int halfLife = 300;
 	try {
-		libconfig::Setting &setting = Settings::getInstance()->getSetting("initialModuleByFilename");
-		for (int i = 0; i < setting.getLength(); i++) {
-			this->loadSharedObjectsPath(setting[i]);
-		}
+		Settings::Reader reader(*Settings::getInstance());
+		const ConfigValue &setting = reader.getSetting("threatLevel");
+		setting.lookupValue("halfLife", halfLife);
 	} catch (OptionNotFoundException &e) {
-		this->printDebug("No Modules loaded by Filename ...\n");
+		this->printDebug("Using default threat level half-life ...\n");
 	}
+	ThreatLevelService::setHalfLife(halfLife);
+
+	//
+	// Load Modules by Path Name
+	//
+	this->loadInitialModules("initialModuleByPath");
+
+	//
+	// Load Modules by Filename
+	//
+	this->loadInitialModules("initialModuleByFilename");
 
 	//
 	// Start DetectionModules by Name
 	//
-	try {
-		libconfig::Setting &setting = Settings::getInstance()->getSetting("runModules");
-		for (int i = 0; i < setting.getLength(); i++) {
-			libconfig::Setting &modulesSetting = setting[i];
-			int seconds = modulesSetting["secondsBetweenRun"];
-			DetectionThread *thread = new DetectionThread(seconds);
-			for (int j = 0; j < modulesSetting["modules"].getLength(); j++) {
-				std::string module = modulesSetting["modules"][j];
-				thread->enqueueModule(modulesSetting["modules"][j]);
+	this->applySchedules();
+
+}
+
+void vmi::VmiIDS::reconfigureModule(std::string moduleName, const std::set<std::string> &options){
+	bool applied;
+	DetectionModule *detectionModule;
+	SensorModule *sensorModule;
+	NotificationModule *notificationModule;
+
+	if (ModuleRegistry::getInstance()->getState(moduleName) != MODULE_ACTIVE) {
+		// Modules not constructed yet read the new configuration, when they are constructed.
+		this->printDebug("Section %s does not belong to a constructed module ...\n", moduleName.c_str());
+		return;
+	}
+	if ((detectionModule = DetectionModule::getDetectionModule(moduleName)) != NULL) {
+		applied = detectionModule->applyConfiguration(options);
+	} else if ((sensorModule = SensorModule::getSensorModule(moduleName)) != NULL) {
+		applied = sensorModule->reconfigure(options);
+	} else if ((notificationModule = NotificationModule::getNotificationModule(moduleName)) != NULL) {
+		applied = notificationModule->reconfigure(options);
+	} else {
+		this->printDebug("Section %s does not belong to a loaded module ...\n", moduleName.c_str());
+		return;
+	}
+	if (!applied) {
+		this->printWarn("Module %s must be reloaded to apply the changed configuration ...\n", moduleName.c_str());
+	}
+}
+
+void vmi::VmiIDS::reloadConfiguration(){
+	ChangedSettings changes;
+	if (!Settings::getInstance()->reload(changes)) {
+		this->printError("Configuration could not be parsed, keeping the current configuration ...\n");
+		return;
+	}
+	this->printInfo("Configuration reloaded, %u sections changed ...\n", (unsigned int) changes.size());
+
+	// Sections are ordered by name, so new modules are loaded before runModules is applied.
+	// A section, which can not be applied, must not abort the framework thread.
+	for (ChangedSettings::iterator it = changes.begin(); it != changes.end(); ++it) {
+		try {
+			if (it->first == "notificationFilter") {
+				this->applyNotificationFilter();
+			} else if (it->first == "initialModuleByPath" || it->first == "initialModuleByFilename") {
+				this->loadInitialModules(it->first);
+			} else if (it->first == "runModules") {
+				this->applySchedules();
+			} else if (it->first == "threatLevel" || it->first == "rpc") {
+				this->printWarn("Changes of %s take effect after a restart ...\n", it->first.c_str());
+			} else {
+				this->reconfigureModule(it->first, it->second);
 			}
-			runModules[seconds] = thread;
-			thread->start();
+		} catch (std::exception &e) {
+			this->printError("Changes of %s could not be applied: %s ...\n", it->first.c_str(), e.what());
 		}
-	} catch (libconfig::SettingNotFoundException &e) {
-		this->printDebug("No DetectionModules started ...\n");
-	} catch (OptionNotFoundException &e) {
-		this->printDebug("No DetectionModules started ...\n");
 	}
+}
 
+void vmi::VmiIDS::requestReload(){
+	reloadRequested = 1;
 }
 
 void vmi::VmiIDS::initVmiIDS(){
@@ -122,14 +301,25 @@ void vmi::VmiIDS::run(void) {
 
 	while(this->vmiRunning){
 		this->sleep(1000);
+		if (reloadRequested) {
+			reloadRequested = 0;
+			this->reloadConfiguration();
+		}
+		this->reapSchedules();
 	}
 	//Delete Threads afterwards
-	while (!runModules.empty()) {
-		std::map<int, DetectionThread*>::iterator it = runModules.begin();
-		if((*it).second != NULL)
-			delete ((*it).second);
-		runModules.erase(it);
+	while (true) {
+		uint32_t seconds;
+		{
+			SnapshotRegistry<uint32_t, DetectionThread>::Reader reader(schedules);
+			if (reader.getEntries().empty()) {
+				break;
+			}
+			seconds = reader.getEntries().front().first;
+		}
+		this->removeSchedule(seconds);
 	}
+	this->reapSchedules();
 	return;
 }
 
@@ -142,6 +332,8 @@ void vmi::VmiIDS::loadSharedObjectsPath(std::string path) {
 		return;
 	}
 
+	// Load the object files in a fixed order, independent of the directory order.
+	std::set<std::string> filenames;
 	while ((dirp = readdir(dp)) != NULL) {
 		if (strstr(dirp->d_name, ".so") != NULL) {
 			std::string filename = path;
@@ -150,15 +342,26 @@ void vmi::VmiIDS::loadSharedObjectsPath(std::string path) {
 			struct stat fileStat;
 			lstat(filename.c_str(), &fileStat);
 			if (!S_ISLNK(fileStat.st_mode)) {
-				this->loadSharedObject(filename.c_str());
+				filenames.insert(filename);
 			}
 		}
 	}
 	closedir(dp);
+	for (std::set<std::string>::iterator it = filenames.begin(); it != filenames.end(); ++it) {
+		this->openSharedObject(*it);
+	}
 	return;
 }
 
 bool vmi::VmiIDS::loadSharedObject(std::string path) {
+	if (!this->openSharedObject(path)) {
+		return false;
+	}
+	ModuleRegistry::getInstance()->activateModules(std::set<std::string>());
+	return true;
+}
+
+bool vmi::VmiIDS::openSharedObject(std::string path) {
 	void *dlib;
 	dlib = dlopen(path.c_str(), RTLD_NOW | RTLD_GLOBAL);
 	if (dlib == NULL) {
@@ -169,28 +372,143 @@ bool vmi::VmiIDS::loadSharedObject(std::string path) {
 }
 
 bool vmi::VmiIDS::enqueueDetectionModule(std::string detectionModuleName, uint32_t timeInSeconds) {
+	if (timeInSeconds == 0 || !DetectionModule::isDetectionModule(detectionModuleName)) {
+		return false;
+	}
 
-	if (runModules.find(timeInSeconds) == runModules.end()){
-		runModules[timeInSeconds] = new DetectionThread(timeInSeconds);
+	SnapshotRegistry<uint32_t, DetectionThread>::Writer writer(schedules);
+	DetectionThread *schedule = writer.find(timeInSeconds);
+	if (schedule != NULL) {
+		// The schedule picks up the module at its next trigger.
+		return schedule->enqueueModule(detectionModuleName);
 	}
-	return runModules[timeInSeconds]->enqueueModule(detectionModuleName);
+	schedule = new DetectionThread(timeInSeconds);
+	schedule->enqueueModule(detectionModuleName);
+	ThreatLevelService::addSchedule(timeInSeconds);
+	schedule->start();
+	writer.insert(timeInSeconds, schedule);
+	writer.commit();
+	return true;
 }
 
 bool vmi::VmiIDS::dequeueDetectionModule(std::string detectionModuleName, uint32_t timeInSeconds) {
-	bool success = false;
+	SnapshotRegistry<uint32_t, DetectionThread>::Writer writer(schedules);
+	DetectionThread *schedule = writer.find(timeInSeconds);
+	if (schedule == NULL || !schedule->dequeueModule(detectionModuleName)) {
+		return false;
+	}
+	if (schedule->getModuleCount() == 0) {
+		writer.erase(timeInSeconds);
+		writer.commit();
+		retireSchedule(schedule);
+	}
+	return true;
+}
+
+bool vmi::VmiIDS::addSchedule(uint32_t timeInSeconds, const std::set<std::string> &detectionModules,
+		bool paused) {
+	if (timeInSeconds == 0) {
+		return false;
+	}
 
-	if (runModules.find(timeInSeconds) == runModules.end()){
-		return success;
+	SnapshotRegistry<uint32_t, DetectionThread>::Writer writer(schedules);
+	if (writer.find(timeInSeconds) != NULL) {
+		return false;
+	}
+	DetectionThread *schedule = new DetectionThread(timeInSeconds);
+	schedule->setPaused(paused);
+	for (std::set<std::string>::const_iterator it = detectionModules.begin();
+			it != detectionModules.end(); ++it) {
+		if (!schedule->enqueueModule(*it)) {
+			this->printWarn("DetectionModule %s not loaded, not scheduled ...\n", it->c_str());
+		}
 	}
+	ThreatLevelService::addSchedule(timeInSeconds);
+	schedule->start();
+	writer.insert(timeInSeconds, schedule);
+	writer.commit();
+	return true;
+}
 
-	success = runModules[timeInSeconds]->dequeueModule(detectionModuleName);
-	if(runModules[timeInSeconds]->getModuleCount() == 0){
-		delete (runModules[timeInSeconds]);
-		runModules.erase(runModules.find(timeInSeconds));
+bool vmi::VmiIDS::removeSchedule(uint32_t timeInSeconds) {
+	DetectionThread *schedule;
+	{
+		SnapshotRegistry<uint32_t, DetectionThread>::Writer writer(schedules);
+		schedule = writer.find(timeInSeconds);
+		if (schedule == NULL) {
+			return false;
+		}
+		writer.erase(timeInSeconds);
+		writer.commit();
+	}
+	// The aggregate is removed by reapSchedules(), once the schedule has stopped reporting.
+	retireSchedule(schedule);
+	return true;
+}
+
+bool vmi::VmiIDS::retimeSchedule(uint32_t timeInSeconds, uint32_t newTimeInSeconds) {
+	if (newTimeInSeconds == 0) {
+		return false;
+	}
+
+	{
+		SnapshotRegistry<uint32_t, DetectionThread>::Writer writer(schedules);
+		DetectionThread *schedule = writer.find(timeInSeconds);
+		if (schedule == NULL || writer.find(newTimeInSeconds) != NULL) {
+			return schedule != NULL && timeInSeconds == newTimeInSeconds;
+		}
+		ThreatLevelService::addSchedule(newTimeInSeconds);
+		writer.erase(timeInSeconds);
+		writer.insert(newTimeInSeconds, schedule);
+		schedule->setInterval(newTimeInSeconds);
+		writer.commit();
+		// Reports still using the old interval update the aggregate in a read section,
+		// so it is removed safely. Later ones find no aggregate and are dropped.
+		ThreatLevelService::removeSchedule(timeInSeconds);
+	}
+	return true;
+}
+
+bool vmi::VmiIDS::pauseSchedule(uint32_t timeInSeconds, bool paused) {
+	SnapshotRegistry<uint32_t, DetectionThread>::Reader reader(schedules);
+	DetectionThread *schedule = reader.find(timeInSeconds);
+	if (schedule == NULL) {
+		return false;
+	}
+	schedule->setPaused(paused);
+	return true;
+}
+
+const vmi::SnapshotRegistry<uint32_t, vmi::DetectionThread> &vmi::VmiIDS::getSchedules() {
+	return schedules;
+}
+
+void vmi::VmiIDS::retireSchedule(DetectionThread *schedule) {
+	schedule->stopThread();
+	vmi::MutexLocker lock(&retiredMutex);
+	retiredSchedules.push_back(schedule);
+}
+
+void vmi::VmiIDS::reapSchedules() {
+	std::list<DetectionThread *> retired;
+	{
+		vmi::MutexLocker lock(&retiredMutex);
+		retired.swap(retiredSchedules);
+	}
+	while (!retired.empty()) {
+		uint32_t seconds = retired.front()->getInterval();
+		// Waits for the module currently executed by the schedule.
+		delete retired.front();
+		retired.pop_front();
+		// Keep the aggregate, if a new schedule with the same interval was added meanwhile.
+		// The writer keeps it from being added concurrently.
+		SnapshotRegistry<uint32_t, DetectionThread>::Writer writer(schedules);
+		if (writer.find(seconds) == NULL) {
+			ThreatLevelService::removeSchedule(seconds);
+		}
 	}
-	return success;
 }
 
 void vmi::VmiIDS::collectThreadLevel() {
-	info << "The global threat level is: " << DetectionModule::getGlobalThreatLevel();
+	info << ThreatLevelService::getReport();
 }
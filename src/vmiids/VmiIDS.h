@@ -8,13 +8,15 @@
 #ifndef VMIIDS_H_
 #define VMIIDS_H_
 
-#include <map>
+#include <list>
 #include <string>
 #include <set>
+#include <signal.h>
 
 #include "vmiids/rpc/RpcServer.h"
 #include "vmiids/util/Thread.h"
 #include "vmiids/util/Mutex.h"
+#include "vmiids/util/SnapshotRegistry.h"
 
 #include "DetectionThread.h"
 #include "DetectionModule.h"
@@ -39,10 +41,17 @@ namespace vmi {
  * This class is the main class of the VmiIDS framework. It is responsible for the frameworks
  * bootstraping process.<p>
  *
+ * The schedules (DetectionThreads) are kept in a registry keyed by their reexecution time.
+ * Adding, removing and retiming a schedule publishes a new set of schedules at once, so readers
+ * (e.g. the status rpc) never see a partial change. A removed schedule is stopped and deleted
+ * later by the framework thread, so neither the caller nor a running module is blocked.
  */
 class VmiIDS : public Module, protected OutputModule, public Thread{
 	private:
-		static std::map<int, DetectionThread*> runModules; //!< Map of different detection module schedules.
+		static vmi::SnapshotRegistry<uint32_t, DetectionThread> schedules; //!< Detection module schedules by reexecution time.
+		static std::list<DetectionThread *> retiredSchedules;  //!< Removed schedules, which are not deleted yet.
+		static vmi::Mutex retiredMutex;  //!< Protects retiredSchedules.
+		static volatile sig_atomic_t reloadRequested;  //!< Set by requestReload().
 
 		static VmiIDS *instance;  //!< Instance of the singleton class.
 		RpcServer rpcServer;      //!< Instance of the rpc server thread.
@@ -68,13 +77,59 @@ class VmiIDS : public Module, protected OutputModule, public Thread{
 		void initVmiIDS();   //!< Bootstrap the framework
 		void loadModules();  //!< Load all modules specified in the configuration file.
 
+		void applyNotificationFilter();  //!< Configure the notification filter from the notificationFilter setting.
+		/**
+		 * Load the modules found in the directories listed in a setting.
+		 * Modules, which are already loaded, are not loaded again.
+		 *
+		 * @param settingName Name of the setting (initialModuleByPath or initialModuleByFilename).
+		 */
+		void loadInitialModules(std::string settingName);
+		/**
+		 * Create, change and remove schedules, until they match the runModules setting.
+		 * Schedules, which already match, are not touched.
+		 */
+		void applySchedules();
+		/**
+		 * Pass changed options to the module owning the section.
+		 *
+		 * @param moduleName Name of the section and module.
+		 * @param options Names of the changed options.
+		 */
+		void reconfigureModule(std::string moduleName, const std::set<std::string> &options);
+		/**
+		 * Reread the configuration file and apply the changed sections.
+		 * If the file can not be parsed, the current configuration is kept.
+		 */
+		void reloadConfiguration();
+
 		/**
 		 * Load all *.so files in the directory specified using the dl_open call.
-		 * The modules are the inserted to the framework by the LOADMODULE() macro.
+		 * The modules are the registered with the ModuleRegistry by the LOADMODULE() macro.
+		 * No module is constructed.
 		 *
 		 * @param path Path to look for modules to load.
 		 */
 		void loadSharedObjectsPath(std::string path);
+		/**
+		 * Load an object file using the dl_open call. Its modules are registered only.
+		 *
+		 * @param path Path of the object file.
+		 * @return True, if the object file could be loaded.
+		 */
+		bool openSharedObject(std::string path);
+
+		/**
+		 * Stop a schedule, which was removed from the registry. It is deleted by reapSchedules().
+		 * @param schedule Removed schedule.
+		 */
+		static void retireSchedule(DetectionThread *schedule);
+		/**
+		 * Wait for the retired schedules to finish their current module and delete them.
+		 * Afterwards the threat level aggregates of their intervals are removed, unless a new
+		 * schedule uses the interval.
+		 */
+		void reapSchedules();
 
 	protected:
 		/**
@@ -115,8 +170,16 @@ class VmiIDS : public Module, protected OutputModule, public Thread{
 
 		virtual void run(void);
 
+		/**
+		 * Request to reload the configuration file. The file is parsed and applied by the
+		 * framework thread within a second, so the caller is not blocked.
+		 * Async-signal-safe, used as the SIGHUP handler.
+		 */
+		static void requestReload();
+
 		/**
 		 * Load the module specified by path into the framework.
+		 * NotificationModules are constructed immediately, other modules on their first use.
 		 *
 		 * @param path Path to look for modules to load.
 		 * @return True, if the module could be loaded.
@@ -127,16 +190,18 @@ class VmiIDS : public Module, protected OutputModule, public Thread{
 		 * @brief Enqueue a detection module to a schedule
 		 * @sa DetectionModule
 		 * @sa DetectionThread
-		 * @sa runModules
+		 * @sa schedules
 		 *
 		 * Used to enqueue a DetectionModule to a specific schedule. The DetectionModule must
-		 * be loaded into the framework in advance. The scheduler triggers the execution of all
+		 * be loaded or registered in advance. A registered module is constructed by the schedule
+		 * thread before its next round, not by the caller. The scheduler triggers the execution of all
 		 * enqueued modules every timeInSeconds seconds. Afterwards all detectionModules are executed
 		 * sequentially. Hence one run of the entire list of module scheduled may take longer, than
 		 * the time specified. Therefore the execution is immediately retriggered in that case.
+		 * If no schedule with this time exists, a new schedule is created and started.
 		 *
 		 * @param detectionModuleName Name of the DetectionModule
-		 * @param timeInSeconds Time between two executions of the module detectionModuleName.
+		 * @param timeInSeconds Time between two executions of the module detectionModuleName. Not zero.
 		 * @return True, if the DetectionModule was enqueued successfully.
 		 */
 		bool enqueueDetectionModule(std::string detectionModuleName, uint32_t timeInSeconds = 0);
@@ -145,9 +210,10 @@ class VmiIDS : public Module, protected OutputModule, public Thread{
 		 * @brief Denqueue a detection module to a schedule
 		 * @sa DetectionModule
 		 * @sa DetectionThread
-		 * @sa runModules
+		 * @sa schedules
 		 *
-		 * Used to dequeue a DetectionModule from a specific schedule.
+		 * Used to dequeue a DetectionModule from a specific schedule. The change takes effect
+		 * at the next trigger. A schedule, which becomes empty, is removed.
 		 *
 		 * @param detectionModuleName Name of the DetectionModule
 		 * @param timeInSeconds Reexecution time of the schedule to unload the module from.
@@ -156,9 +222,63 @@ class VmiIDS : public Module, protected OutputModule, public Thread{
 		bool dequeueDetectionModule(std::string detectionModuleName, uint32_t timeInSeconds = 0);
 
 		/**
-		 * Currently a stub.
-		 * TODO Implement a function returning an overall thread level.
-		 * TODO For example for all modules in a certain schedule.
+		 * @brief Create a new schedule
+		 * @sa DetectionThread
+		 *
+		 * @param timeInSeconds Time between two executions of the schedule. Not zero.
+		 * @param detectionModules Names of the DetectionModules to execute. Modules, which are
+		 *        neither loaded nor registered, are skipped. Registered modules are constructed
+		 *        by the schedule thread.
+		 * @param paused True to create the schedule suspended.
+		 * @return True, if the schedule was created. False, if it already exists.
+		 */
+		bool addSchedule(uint32_t timeInSeconds, const std::set<std::string> &detectionModules,
+				bool paused = false);
+
+		/**
+		 * @brief Remove a schedule
+		 *
+		 * The schedule does not trigger further executions. A module currently executed by the
+		 * schedule is not interrupted. The function does not wait for it to finish.
+		 *
+		 * @param timeInSeconds Reexecution time of the schedule.
+		 * @return True, if the schedule was removed.
+		 */
+		bool removeSchedule(uint32_t timeInSeconds);
+
+		/**
+		 * @brief Change the reexecution time of a schedule
+		 *
+		 * Takes effect at the next trigger of the schedule.
+		 *
+		 * @param timeInSeconds Reexecution time of the schedule.
+		 * @param newTimeInSeconds New reexecution time. Not zero and not used by another schedule.
+		 * @return True, if the schedule was changed.
+		 */
+		bool retimeSchedule(uint32_t timeInSeconds, uint32_t newTimeInSeconds);
+
+		/**
+		 * @brief Suspend or resume a schedule
+		 *
+		 * A module currently executed by the schedule is not interrupted.
+		 *
+		 * @param timeInSeconds Reexecution time of the schedule.
+		 * @param paused True to suspend the schedule, false to resume it.
+		 * @return True, if the schedule exists.
+		 */
+		bool pauseSchedule(uint32_t timeInSeconds, bool paused);
+
+		/**
+		 * Request the registry of schedules, keyed by their reexecution time. The schedules
+		 * are not deleted while a SnapshotRegistry::Reader of the registry exists.
+		 *
+		 * @return Registry of schedules.
+		 */
+		static const vmi::SnapshotRegistry<uint32_t, DetectionThread> &getSchedules();
+
+		/**
+		 * Print the global, per schedule and per module threat levels.
+		 * @sa ThreatLevelService
 		 */
 		void collectThreadLevel();
 };
@@ -59,6 +59,10 @@ int signal_handler_sigint = 0;
  *     <td> stop current thread</td>
  *  </tr>
  *  <tr>
+ *     <td> SIGHUP </td>
+ *     <td> reload configuration file</td>
+ *  </tr>
+ *  <tr>
  *     <td> SIGSEGV </td>
  *     <td> print stacktrace</td>
  *  </tr>
@@ -78,6 +82,8 @@ void signal_handler(int sig_num, siginfo_t * info, void * ucontext) {
 		}
 	}else if (sig_num == SIGTERM) {
 			pthread_exit(NULL);
+	} else if (sig_num == SIGHUP) {
+		vmi::VmiIDS::requestReload();
 	} else if (sig_num == SIGSEGV) {
 		void * array[50];
 		void * caller_address;
@@ -161,6 +167,8 @@ int main() {
 	sigaction(SIGINT, &signal_action, NULL);
 	//To kill threads
 	sigaction(SIGTERM, &signal_action, NULL);
+	//To reload the configuration
+	sigaction(SIGHUP, &signal_action, NULL);
 	//To catch segfaults
 	sigaction(SIGSEGV, &signal_action, NULL);
 
@@ -0,0 +1,111 @@
+/*
+ * BackdoorPortDetectionModule.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#include "BackdoorPortDetectionModule.h"
+
+LOADMODULE_DEPENDS(BackdoorPortDetectionModule, "QemuMonitorSensorModule NetworkSensorModule MemorySensorModule");
+
+BackdoorPortDetectionModule::BackdoorPortDetectionModule() :
+			DetectionModule("BackdoorPortDetectionModule") {
+	GETSENSORMODULE(this->qemu, QemuMonitorSensorModule);
+	GETSENSORMODULE(this->network, NetworkSensorModule);
+	try {
+		GETSENSORMODULE(this->memory, MemorySensorModule);
+	} catch (vmi::DependencyNotFoundException &e) {
+		info << "MemorySensorModule not loaded. Hidden sockets are not detected." << std::endl;
+		this->memory = NULL;
+	}
+}
+
+BackdoorPortDetectionModule::~BackdoorPortDetectionModule() {
+}
+
+void BackdoorPortDetectionModule::run() {
+
+	bool isRunning;
+	try {
+		isRunning = this->qemu->isRunning();
+	} catch (vmi::ModuleException &e) {
+		critical << "Could not use QemuMonitorSensorModule";
+		return;
+	}
+
+	//Get socket list from memtool. Without it only the internal view is checked.
+	std::vector<MemtoolSocket> memtoolSockets;
+	if (this->memory != NULL) {
+		try {
+			this->memory->getSocketList(memtoolSockets);
+		} catch (vmi::ModuleException &e) {
+			info << "Could not read the socket list from memtool. Hidden sockets are not detected."
+					<< std::endl;
+			memtoolSockets.clear();
+		}
+	}
+
+	if (!isRunning) {
+		this->qemu->resumeVM();
+	}
+
+	//Get sockets and interfaces from the monitored machine
+	std::vector<NetworkSocket> sockets;
+	std::vector<NetworkInterface> interfaces;
+	this->network->getNetworkState(sockets, interfaces);
+
+	if (!isRunning) {
+		this->qemu->pauseVM();
+	}
+
+	float intrusion = 0;
+
+	//Check listening sockets for backdoor ports
+	std::set<uint64_t> visibleSockets;
+	for (std::vector<NetworkSocket>::iterator it = sockets.begin(); it != sockets.end(); ++it) {
+		visibleSockets.insert(it->inode);
+		bool listening = (it->protocol == NETWORK_TCP) ?
+				(it->state == NETWORK_TCP_LISTEN) : (it->remotePort == 0);
+		if (listening && this->backdoorPorts.contains(it->protocol, it->localPort)) {
+			alert << "Backdoor port found: " << ((it->protocol == NETWORK_TCP) ? "TCP" : "UDP")
+					<< " port " << it->localPort << " ("
+					<< this->backdoorPorts.getDescription(it->protocol, it->localPort) << ")" << std::endl;
+			intrusion = 1;
+		}
+	}
+
+	//Check for promiscuous interfaces
+	for (std::vector<NetworkInterface>::iterator it = interfaces.begin(); it != interfaces.end(); ++it) {
+		if (it->flags & NETWORK_IFF_PROMISC) {
+			critical << "Interface in promiscuous mode: " << it->name << std::endl;
+			if (intrusion < 0.5) intrusion = 0.5;
+		}
+	}
+
+	//Find sockets in memtool not listed in the internal view
+	std::set<uint64_t> hidden;
+	for (std::vector<MemtoolSocket>::iterator it = memtoolSockets.begin(); it != memtoolSockets.end(); ++it) {
+		if (it->inode == 0 || visibleSockets.find(it->inode) != visibleSockets.end()) {
+			continue;
+		}
+		hidden.insert(it->inode);
+		NETWORK_PROTOCOL protocol = (it->protocol.compare(0, 3, "tcp") == 0) ? NETWORK_TCP : NETWORK_UDP;
+		if (this->hiddenSockets.find(it->inode) != this->hiddenSockets.end()) {
+			alert << "Hidden socket detected: " << it->protocol << " port " << it->localPort
+					<< " inode " << it->inode << std::endl;
+			intrusion = 1;
+		} else {
+			critical << "Socket not found in /proc/net: " << it->protocol << " port " << it->localPort
+					<< " inode " << it->inode << std::endl;
+			if (intrusion < 0.5) intrusion = 0.5;
+		}
+		if (this->backdoorPorts.contains(protocol, it->localPort)) {
+			alert << "Hidden backdoor port found: " << it->protocol << " port " << it->localPort << " ("
+					<< this->backdoorPorts.getDescription(protocol, it->localPort) << ")" << std::endl;
+			intrusion = 1;
+		}
+	}
+	this->hiddenSockets = hidden;
+	this->threatLevel = intrusion;
+}
@@ -0,0 +1,56 @@
+/*
+ * BackdoorPortDetectionModule.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef BACKDOORPORTDETECTIONMODULE_H_
+#define BACKDOORPORTDETECTIONMODULE_H_
+
+#include "vmiids/DetectionModule.h"
+
+#include "vmiids/modules/sensor/QemuMonitorSensorModule.h"
+#include "vmiids/modules/sensor/NetworkSensorModule.h"
+#include "vmiids/modules/sensor/MemorySensorModule.h"
+
+#include "vmiids/modules/sensor/BackdoorPortIndex.h"
+
+#include <set>
+
+/**
+ * @class BackdoorPortDetectionModule BackdoorPortDetectionModule.h "vmiids/modules/detection/BackdoorPortDetectionModule.h"
+ * @brief Module detecting backdoor ports, hidden sockets and promiscuous interfaces.
+ * @sa vmi::DetectionModule
+ * @sa QemuMonitorSensorModule
+ * @sa NetworkSensorModule
+ * @sa MemorySensorModule
+ *
+ * The BackdoorPortDetectionModule compares every listening socket of the monitored machine
+ * against a BackdoorPortIndex. Network interfaces in promiscuous mode are reported as well.
+ *
+ * If the MemorySensorModule is loaded, the sockets found in the memory are compared with the
+ * internal view of the NetworkSensorModule. Sockets only found in the memory are hidden from
+ * the monitored machine and thus evidence for a compromised system.
+ *
+ * As both views are not generated at the exact same time, a hidden socket creates a message of
+ * type critical and raises the threat level to 0.5. If the socket is hidden in consecutive runs,
+ * an alert message is created and the threat level is raised to one.
+ * Listening backdoor ports raise the threat level to one.
+ */
+class BackdoorPortDetectionModule : public vmi::DetectionModule{
+	QemuMonitorSensorModule * qemu;
+	NetworkSensorModule * network;
+	MemorySensorModule * memory;   //!< Optional. NULL, if no MemorySensorModule is loaded.
+
+	BackdoorPortIndex backdoorPorts;  //!< Ports used by known backdoors.
+	std::set<uint64_t> hiddenSockets;  //!< Inodes of hidden sockets found in the last run.
+
+public:
+	BackdoorPortDetectionModule();
+	virtual ~BackdoorPortDetectionModule();
+
+	virtual void run();
+};
+
+#endif /* BACKDOORPORTDETECTIONMODULE_H_ */
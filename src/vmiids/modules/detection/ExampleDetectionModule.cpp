@@ -9,7 +9,7 @@
 
 #include "ExampleDetectionModule.h"
 
-LOADMODULE(ExampleDetectionModule);
+LOADMODULE_DEPENDS(ExampleDetectionModule, "FileSystemSensorModule ShellSensorModule QemuMonitorSensorModule");
 
 ExampleDetectionModule::ExampleDetectionModule() :
 	DetectionModule("ExampleDetectionModule") {
@@ -7,7 +7,7 @@
 
 #include "FileContentDetectionModule.h"
 
-LOADMODULE(FileContentDetectionModule);
+LOADMODULE_DEPENDS(FileContentDetectionModule, "QemuMonitorSensorModule ShellSensorModule FileSystemSensorModule");
 
 FileContentDetectionModule::FileContentDetectionModule() :
 			DetectionModule("FileContentDetectionModule") {
@@ -23,6 +23,19 @@ FileContentDetectionModule::~FileContentDetectionModule() {
 
 }
 
+bool FileContentDetectionModule::reconfigure(const std::set<std::string> &options) {
+	if (options.count("directory") > 0) {
+		std::string directory;
+		try {
+			GETOPTION(directory, directory);
+		} catch (vmi::OptionNotFoundException &e) {
+			return false;
+		}
+		this->directory = directory;
+	}
+	return options.size() == options.count("directory");
+}
+
 void FileContentDetectionModule::run() {
 
 	std::set<std::string> fileSet;
@@ -45,6 +45,12 @@ public:
 	virtual ~FileContentDetectionModule();
 
 	virtual void run();
+
+	/**
+	 * Apply a changed directory.
+	 * @sa vmi::Module::reconfigure()
+	 */
+	virtual bool reconfigure(const std::set<std::string> &options);
 };
 
 #endif /* FILECONTENTDETECTIONMODULE_H_ */
@@ -7,7 +7,7 @@
 
 #include "FileListDetectionModule.h"
 
-LOADMODULE(FileListDetectionModule);
+LOADMODULE_DEPENDS(FileListDetectionModule, "QemuMonitorSensorModule ShellSensorModule FileSystemSensorModule");
 
 
 FileListDetectionModule::FileListDetectionModule() :
@@ -27,6 +27,24 @@ FileListDetectionModule::~FileListDetectionModule() {
 
 }
 
+bool FileListDetectionModule::reconfigure(const std::set<std::string> &options) {
+	if (options.count("directory") > 0) {
+		std::string directory;
+		try {
+			GETOPTION(directory, directory);
+		} catch (vmi::OptionNotFoundException &e) {
+			return false;
+		}
+		while(directory.size() > 1 && directory[directory.size()-1] == '/')
+			directory.erase(directory.size()-1);
+		this->directory = directory;
+		// Files of the old directory must not be reported as hidden or virtual.
+		this->globalFsFileList.clear();
+		this->globalShellFileList.clear();
+	}
+	return options.size() == options.count("directory");
+}
+
 void FileListDetectionModule::run() {
 
 	bool isRunning;
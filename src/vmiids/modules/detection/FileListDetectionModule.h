@@ -65,6 +65,12 @@ public:
 	virtual ~FileListDetectionModule();
 
 	virtual void run();
+
+	/**
+	 * Apply a changed directory.
+	 * @sa vmi::Module::reconfigure()
+	 */
+	virtual bool reconfigure(const std::set<std::string> &options);
 };
 
 #endif /* FILELISTDETECTIONMODULE_H_ */
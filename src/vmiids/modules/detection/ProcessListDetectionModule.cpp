@@ -7,7 +7,7 @@
 
 #include "ProcessListDetectionModule.h"
 
-LOADMODULE(ProcessListDetectionModule);
+LOADMODULE_DEPENDS(ProcessListDetectionModule, "QemuMonitorSensorModule ShellSensorModule MemorySensorModule");
 
 ProcessListDetectionModule::ProcessListDetectionModule() :
 			DetectionModule("ProcessListDetectionModule") {
@@ -15,7 +15,7 @@
 #include <list>
 #include <sstream>
 
-#define RKHUNTERSCRIPT "/home/idsvm/workspace/libvmi/src/vmiidsmodules/detection/rkhunterfiles/rkhunter"
+#include <unistd.h>
 
 
 #define TEXTNORMAL = 	"\033[0m"
@@ -28,16 +28,149 @@
 #define TEXTCYAN =		"\033[0;36m"
 #define TEXTWHITE = 	"\033[0;37m"
 
-LOADMODULE(RkHunterDetectionModule);
+LOADMODULE_DEPENDS(RkHunterDetectionModule, "QemuMonitorSensorModule ShellSensorModule FileSystemSensorModule NetworkSensorModule");
+
+/**
+ * Strings left in system binaries by known rootkits.
+ * Searched for by performAdditionalRootkitCheck().
+ */
+static const char * rootkitStringTable[] = {
+	"/bin/xchk", "/bin/xsf", "/dev/ttyoa", "/dev/ttyof", "/dev/ttyop",
+	"/dev/ptyxx", "/dev/hdbb", "/dev/hda06", "/dev/proc/fuckit", "/dev/sdr0",
+	"/usr/bin/xstat", "/usr/bin/duarawkz", "/usr/lib/libshtift", "/usr/lib/libsh",
+	"/usr/info/.t0rn", "/usr/src/.puta", "/usr/sbin/xntps", "/usr/include/file.h",
+	"/usr/include/proc.h", "/usr/include/hosts.h", "/usr/include/log.h",
+	"/lib/ldlibps.so", "/lib/ldlibpst.so", "/lib/lidps1.so", "/lib/libext-2.so.7",
+	"/etc/rc.d/rsha", "/etc/sh.conf", "/etc/ld.so.hash", "/sbin/xlogin",
+	"/tmp/.bash_history", "mr.grep", "tymkc"
+};
+
+/**
+ * System binaries scanned for rootkit strings by performAdditionalRootkitCheck().
+ */
+static const char * rootkitStringBinaries[] = {
+	"/bin/login", "/bin/ls", "/bin/netstat", "/bin/ps", "/bin/su",
+	"/sbin/ifconfig", "/sbin/init", "/sbin/syslogd", "/usr/bin/du",
+	"/usr/bin/find", "/usr/bin/killall", "/usr/bin/passwd", "/usr/bin/pstree",
+	"/usr/bin/top", "/usr/bin/w", "/usr/sbin/inetd", "/usr/sbin/sshd",
+	"/usr/sbin/tcpd", "/usr/sbin/xinetd"
+};
+
+/**
+ * Rootkits checked by performKnownRootkitCheck().
+ * Each rootkit is listed with the prefix of its rkhunter variables.
+ * The files and directories of the rootkit are read from the variables
+ * <prefix>_FILES and <prefix>_DIRS respectively.
+ */
+static const char * knownRootkitTable[][2] = {
+	{ "55808 Trojan - Variant A",        "W55808A" },
+	{ "ADM Worm",                        "ADMWORM" },
+	{ "AjaKit Rootkit",                  "AJAKIT" },
+	{ "Adore Rootkit",                   "ADORE" },
+	{ "aPa Kit",                         "APAKIT" },
+	{ "Apache Worm",                     "APACHEWORM" },
+	{ "Ambient (ark) Rootkit",           "ARK" },
+	{ "Balaur Rootkit",                  "BALAUR" },
+	{ "BeastKit Rootkit",                "BEASTKIT" },
+	{ "beX2 Rootkit",                    "BEX" },
+	{ "BOBKit Rootkit",                  "BOBKIT" },
+	{ "cb Rootkit",                      "CB" },
+	{ "CiNIK Worm (Slapper.B variant)",  "CINIK" },
+	{ "Danny-Boy's Abuse Kit",           "DANNYBOY" },
+	{ "Devil RootKit",                   "DEVIL" },
+	{ "Dica-Kit Rootkit",                "DICA" },
+	{ "Dreams Rootkit",                  "DREAMS" },
+	{ "Duarawkz Rootkit",                "DUARAWKZ" },
+	{ "Enye LKM",                        "ENYELKM" },
+	{ "Flea Linux Rootkit",              "FLEA" },
+	{ "FreeBSD Rootkit",                 "FREEBSD_RK" },
+	{ "Fu Rootkit",                      "FU" },
+	{ "Fuck`it Rootkit",                 "FUCKIT" },
+	{ "GasKit Rootkit",                  "GASKIT" },
+	{ "Heroin LKM",                      "HEROIN" },
+	{ "HjC Kit",                         "HJCKIT" },
+	{ "ignoKit Rootkit",                 "IGNOKIT" },
+	{ "iLLogiC Rootkit",                 "ILLOGIC" },
+	{ "IntoXonia-NG Rootkit",            "INTOXONIA" },
+	{ "Irix Rootkit",                    "IRIX" },
+	{ "Kitko Rootkit",                   "KITKO" },
+	{ "Knark Rootkit",                   "KNARK" },
+	{ "ld-linuxv.so Rootkit",            "LDLINUX" },
+	{ "Li0n Worm",                       "LION" },
+	{ "Lockit / LJK2 Rootkit",           "LOCKIT" },
+	{ "Mood-NT Rootkit",                 "MOODNT" },
+	{ "MRK Rootkit",                     "MRK" },
+	{ "Ni0 Rootkit",                     "NIO" },
+	{ "Ohhara Rootkit",                  "OHHARA" },
+	{ "Optic Kit (Tux) Worm",            "OPTICKIT" },
+	{ "Oz Rootkit",                      "OZ" },
+	{ "Phalanx Rootkit",                 "PHALANX" },
+	{ "Phalanx2 Rootkit",                "PHALANX2" },
+	{ "Portacelo Rootkit",               "PORTACELO" },
+	{ "R3dstorm Toolkit",                "REDSTORM" },
+	{ "RH-Sharpe's Rootkit",             "RHSHARPES" },
+	{ "RSHA's Rootkit",                  "RSHA" },
+	{ "Scalper Worm",                    "SCALPER" },
+	{ "Sebek LKM",                       "SEBEK" },
+	{ "Shutdown Rootkit",                "SHUTDOWN" },
+	{ "SHV4 Rootkit",                    "SHV4" },
+	{ "SHV5 Rootkit",                    "SHV5" },
+	{ "Sin Rootkit",                     "SINROOTKIT" },
+	{ "Slapper Worm",                    "SLAPPER" },
+	{ "Sneakin Rootkit",                 "SNEAKIN" },
+	{ "'Spanish' Rootkit",               "SPANISH" },
+	{ "Suckit Rootkit",                  "SUCKIT" },
+	{ "SunOS Rootkit",                   "SUNOSROOTKIT" },
+	{ "SunOS / NSDAP Rootkit",           "NSDAP" },
+	{ "Superkit Rootkit",                "SUPERKIT" },
+	{ "TBD (Telnet BackDoor)",           "TBD" },
+	{ "TeLeKiT Rootkit",                 "TELEKIT" },
+	{ "T0rn Rootkit",                    "TORN" },
+	{ "trNkit Rootkit",                  "TRNKIT" },
+	{ "Trojanit Kit",                    "TROJANIT" },
+	{ "Tuxtendo Rootkit",                "TUXTENDO" },
+	{ "URK Rootkit",                     "URK" },
+	{ "Vampire Rootkit",                 "VAMPIRE" },
+	{ "VcKit Rootkit",                   "VCKIT" },
+	{ "Volc Rootkit",                    "VOLC" },
+	{ "Xzibit Rootkit",                  "XZIBIT" },
+	{ "X-Org SunOS Rootkit",             "XORGSUNOS" },
+	{ "zaRwT.KiT Rootkit",               "ZARWT" },
+	{ "ZK Rootkit",                      "ZK" }
+};
 
 RkHunterDetectionModule::RkHunterDetectionModule() :
-	DetectionModule("RkHunterDetectionModule") {
+	DetectionModule("RkHunterDetectionModule"), threatFound(0) {
 
 	GETSENSORMODULE(this->qemu, QemuMonitorSensorModule);
 	GETSENSORMODULE(this->shell, ShellSensorModule);
 	GETSENSORMODULE(this->fs, FileSystemSensorModule);
+	GETSENSORMODULE(this->network, NetworkSensorModule);
+
+	GETOPTION(rkhunterScript, this->rkhunterScript);
+
+	int threads;
+	try {
+		GETOPTION(checkThreads, threads);
+		this->checkThreads = (threads > 0) ? threads : 1;
+	} catch (vmi::OptionNotFoundException &e) {
+		threads = sysconf(_SC_NPROCESSORS_ONLN);
+		this->checkThreads = (threads > 0) ? threads : 1;
+	}
+
+	RkHunterVariableCache cache(this->rkhunterScript);
+	if (!cache.load(this->rkvars)) {
+		this->initializeVariables();
+		if (!cache.store(this->rkvars)) {
+			debug << "Could not write rkhunter variable cache " << cache.getCachePath() << std::endl;
+		}
+	}
+	this->initializeKnownRootkits();
 
-	this->initializeVariables();
+	for (size_t i = 0; i < sizeof(rootkitStringTable) / sizeof(rootkitStringTable[0]); i++) {
+		this->rootkitStrings.addPattern(rootkitStringTable[i]);
+	}
+	this->rootkitStrings.compile();
 }
 
 RkHunterDetectionModule::~RkHunterDetectionModule() {
@@ -45,13 +178,19 @@ RkHunterDetectionModule::~RkHunterDetectionModule() {
 }
 void RkHunterDetectionModule::initializeVariables() {
 
-	std::ifstream fileHandle(RKHUNTERSCRIPT, std::ifstream::in);
+	std::ifstream fileHandle(this->rkhunterScript.c_str(), std::ifstream::in);
 	std::string currentLine;
 
 	std::string currentVariableName;
 	std::string currentVariableContent;
 
 	bool lineInteresting = false;
+	size_t lineNumber = 0;
+	std::string unexpectedLine;
+
+	if (!fileHandle.is_open()) {
+		throw vmi::ModuleException(std::string("Could not open rkhunter script ").append(this->rkhunterScript));
+	}
 
 	size_t result;
 	regex_t rxReturn;
@@ -62,17 +201,25 @@ void RkHunterDetectionModule::initializeVariables() {
 	regex_t rxVariables;
 	regmatch_t matches[100];
 
-	result = regcomp(&rxReturn, "[:space:]*return", REG_EXTENDED );
-	result = regcomp(&rxDoSystemCheck, "^do_system_check_initialisation().*$",
-			REG_EXTENDED );
-	result = regcomp(&rxEmptyLine, "^[:space:]*$", REG_EXTENDED );
-	result = regcomp(&rxCommentLine, "([:space:]|\t)+#", REG_EXTENDED );
-	result = regcomp(&rxFirstLine, "\\s*(\\w*)=(.*)", REG_EXTENDED );
-	result = regcomp(&rxVariables,
-			"\\$\\{(\\w*)\\}\\s*\\$\\{(\\w*)\\}\\s*\\$\\{(\\w*)\\}\\s*",
-			REG_EXTENDED );
+	regex_t * compiled[] = { &rxReturn, &rxDoSystemCheck, &rxEmptyLine,
+			&rxCommentLine, &rxFirstLine, &rxVariables };
+	const char * patterns[] = { "[:space:]*return",
+			"^do_system_check_initialisation().*$",
+			"^[:space:]*$",
+			"([:space:]|\t)+#",
+			"\\s*(\\w*)=(.*)",
+			"\\$\\{(\\w*)\\}\\s*\\$\\{(\\w*)\\}\\s*\\$\\{(\\w*)\\}\\s*" };
+	const size_t regexCount = sizeof(compiled) / sizeof(compiled[0]);
+
+	for (size_t i = 0; i < regexCount; i++) {
+		if (regcomp(compiled[i], patterns[i], REG_EXTENDED) != 0) {
+			while (i > 0) regfree(compiled[--i]);
+			throw vmi::ModuleException("Could not compile rkhunter script regex");
+		}
+	}
 
 	while (std::getline(fileHandle, currentLine)) {
+		lineNumber++;
 
 		memset(matches, 0, sizeof(matches));
 		if (lineInteresting) {
@@ -183,7 +330,10 @@ void RkHunterDetectionModule::initializeVariables() {
 							currentVariableName, currentVariableContent));
 				}
 			} else {
-				exit(0);
+				// Unexpected line within the initialisation function. The variables parsed so
+				// far are incomplete, so they must neither be used nor cached.
+				unexpectedLine = currentLine;
+				break;
 			}
 		} else {
 			if (regexec(&rxDoSystemCheck, currentLine.c_str(), 0, 0, 0) == 0) {
@@ -192,18 +342,100 @@ void RkHunterDetectionModule::initializeVariables() {
 		}
 	}
 
-	regfree(&rxReturn);
-	regfree(&rxDoSystemCheck);
-	regfree(&rxEmptyLine);
-	regfree(&rxCommentLine);
-	regfree(&rxFirstLine);
-	regfree(&rxVariables);
+	for (size_t i = 0; i < regexCount; i++) {
+		regfree(compiled[i]);
+	}
 
 	fileHandle.close();
 
+	if (!unexpectedLine.empty()) {
+		this->rkvars.clear();
+		std::stringstream message;
+		message << "Unexpected line " << lineNumber << " in rkhunter script "
+				<< this->rkhunterScript << ": " << unexpectedLine;
+		throw vmi::ModuleException(message.str());
+	}
+
 	return;
 }
 
+void RkHunterDetectionModule::initializeKnownRootkits() {
+
+	std::multimap<std::string, std::string>::iterator it;
+	std::pair<std::multimap<std::string, std::string>::iterator,
+			std::multimap<std::string, std::string>::iterator> ret;
+
+	for (size_t i = 0; i < sizeof(knownRootkitTable) / sizeof(knownRootkitTable[0]); i++) {
+		std::vector<std::string> files;
+		std::vector<std::string> directories;
+
+		ret = this->rkvars.equal_range(std::string(knownRootkitTable[i][1]).append("_FILES"));
+		for (it = ret.first; it != ret.second; ++it)
+			files.push_back((*it).second);
+
+		ret = this->rkvars.equal_range(std::string(knownRootkitTable[i][1]).append("_DIRS"));
+		for (it = ret.first; it != ret.second; ++it)
+			directories.push_back((*it).second);
+
+		this->knownRootkits.addRootkit(knownRootkitTable[i][0], files, directories);
+	}
+}
+
+const RkHunterDetectionModule::CheckDescription RkHunterDetectionModule::checkTable[] = {
+	{ &RkHunterDetectionModule::performStringCommandCheck,       CHECK_SHELL },
+	{ &RkHunterDetectionModule::performSharedLibrariesCheck,     CHECK_SHELL },
+	{ &RkHunterDetectionModule::performFilePropertiesCheck,      CHECK_FILESYSTEM },
+	{ &RkHunterDetectionModule::performKnownRootkitCheck,        CHECK_FILESYSTEM },
+	{ &RkHunterDetectionModule::performAdditionalRootkitCheck,   CHECK_FILESYSTEM },
+	{ &RkHunterDetectionModule::performMalwareCheck,             CHECK_MEMORY },
+	{ &RkHunterDetectionModule::performTrojanSpecificCheck,      CHECK_FILESYSTEM },
+	{ &RkHunterDetectionModule::performLinuxSpecificCheck,       CHECK_MEMORY },
+	{ &RkHunterDetectionModule::performBackdoorCheck,            CHECK_SHELL },
+	{ &RkHunterDetectionModule::performNetworkInterfacesCheck,   CHECK_SHELL },
+	{ &RkHunterDetectionModule::performSystemBootCheck,          CHECK_FILESYSTEM },
+	{ &RkHunterDetectionModule::performGroupAndAccountCheck,     CHECK_FILESYSTEM },
+	{ &RkHunterDetectionModule::performSystemConfigurationCheck, CHECK_FILESYSTEM },
+	{ &RkHunterDetectionModule::performFileSystemCheck,          CHECK_FILESYSTEM },
+	{ &RkHunterDetectionModule::performApplicationVersionsCheck, CHECK_SHELL }
+};
+
+const size_t RkHunterDetectionModule::checkCount =
+		sizeof(RkHunterDetectionModule::checkTable) / sizeof(RkHunterDetectionModule::checkTable[0]);
+
+void RkHunterDetectionModule::CheckGroup::run() {
+	for (std::vector<CheckFunction>::iterator it = this->checks.begin();
+			it != this->checks.end(); ++it) {
+		(this->module->*(*it))();
+	}
+}
+
+void RkHunterDetectionModule::raiseThreat() {
+	__sync_lock_test_and_set(&this->threatFound, 1);
+}
+
+void RkHunterDetectionModule::report(vmi::DEBUG_LEVEL level, const std::string &message) {
+	switch (level) {
+	case vmi::OUTPUT_DEBUG:
+		vmi::NotificationModule::debug(this->getName(), message);
+		break;
+	case vmi::OUTPUT_INFO:
+		vmi::NotificationModule::info(this->getName(), message);
+		break;
+	case vmi::OUTPUT_WARN:
+		vmi::NotificationModule::warn(this->getName(), message);
+		break;
+	case vmi::OUTPUT_ERROR:
+		vmi::NotificationModule::error(this->getName(), message);
+		break;
+	case vmi::OUTPUT_CRITICAL:
+		vmi::NotificationModule::critical(this->getName(), message);
+		break;
+	case vmi::OUTPUT_ALERT:
+		vmi::NotificationModule::alert(this->getName(), message);
+		break;
+	}
+}
+
 void RkHunterDetectionModule::run() {
 
 	bool isRunning;
@@ -214,33 +446,73 @@ void RkHunterDetectionModule::run() {
 		return;
 	}
 
-	if (!isRunning) {
-		this->qemu->resumeVM();
-	}
-
 	printInfo("[ VMIIDS Rootkit Hunter version 0.0.foo ]");
 	printInfo("");
 
-	printInfo("Checking system commands...");
-	this->performStringCommandCheck();
-	this->performSharedLibrariesCheck();
-	this->performFilePropertiesCheck();
-	printInfo("Checking for rootkits...");
-	this->performKnownRootkitCheck();
-	this->performAdditionalRootkitCheck();
-	this->performMalwareCheck();
-	this->performTrojanSpecificCheck();
-	this->performLinuxSpecificCheck();
-	printInfo("Checking the network...");
-	this->performBackdoorCheck();
-	this->performNetworkInterfacesCheck();
-	printInfo("Checking the local host...");
-	this->performSystemBootCheck();
-	this->performGroupAndAccountCheck();
-	this->performSystemConfigurationCheck();
-	this->performFileSystemCheck();
-	printInfo("Checking application versions...");
-	this->performApplicationVersionsCheck();
+	this->threatFound = 0;
+	__sync_synchronize();
+
+	// Start all host side checks. Each file system check is a group on its own,
+	// the memory checks share one group and are thus run one after another.
+	std::vector<CheckGroup *> groups;
+	CheckGroup *memoryGroup = new CheckGroup(this);
+	vmi::ThreadPool pool(this->checkThreads);
+
+	for (size_t i = 0; i < checkCount; i++) {
+		if (checkTable[i].dependency == CHECK_FILESYSTEM) {
+			groups.push_back(new CheckGroup(this));
+			groups.back()->add(checkTable[i].check);
+			pool.submit(groups.back());
+		} else if (checkTable[i].dependency == CHECK_MEMORY) {
+			memoryGroup->add(checkTable[i].check);
+		}
+	}
+	groups.push_back(memoryGroup);
+	if (!memoryGroup->empty()) {
+		pool.submit(memoryGroup);
+	}
+
+	// Meanwhile run the shell checks. The VM is only resumed for this phase.
+	try {
+		if (!isRunning) {
+			this->qemu->resumeVM();
+		}
+		printInfo("Checking guest shell...");
+		// One transfer of the network state is shared by the network checks.
+		this->networkSockets.clear();
+		this->networkInterfaces.clear();
+		this->network->getNetworkState(this->networkSockets, this->networkInterfaces);
+		for (size_t i = 0; i < checkCount; i++) {
+			if (checkTable[i].dependency == CHECK_SHELL) {
+				(this->*checkTable[i].check)();
+			}
+		}
+		if (!isRunning) {
+			this->qemu->pauseVM();
+		}
+	} catch (std::exception &e) {
+		critical << "Shell checks aborted: " << e.what() << std::endl;
+		// Leave the VM paused, if it was paused before the run.
+		if (!isRunning) {
+			try {
+				this->qemu->pauseVM();
+			} catch (std::exception &e) {
+				critical << "Could not pause VM: " << e.what() << std::endl;
+			}
+		}
+	}
+
+	pool.waitForAll();
+	if (pool.getFailedTaskCount() > 0) {
+		critical << pool.getFailedTaskCount() << " check groups aborted" << std::endl;
+	}
+	while (!groups.empty()) {
+		delete groups.back();
+		groups.pop_back();
+	}
+	if (this->threatFound) {
+		this->threatLevel = 1;
+	}
 
 	/*
 	 System checks summary
@@ -272,9 +544,9 @@ void RkHunterDetectionModule::run() {
 void RkHunterDetectionModule::performStringCommandCheck() {
 	printInfo("\t Performing 'strings' command checks");
 
-	bool stringsFailed = false;
 	std::string commandOutput;
 	std::stringstream command;
+	vmi::MultiPatternMatcher matcher;
 
 	std::multimap<std::string, std::string>::iterator
 			it;
@@ -283,14 +555,44 @@ void RkHunterDetectionModule::performStringCommandCheck() {
 			std::multimap<std::string, std::string>::iterator>
 			ret;
 	ret = this->rkvars.equal_range(std::string("STRINGS_INTEGRITY"));
+	if (ret.first == ret.second) {
+		printInfo("\t\tChecking 'strings' command [ Skipped ]");
+		return;
+	}
+
+	// Pipe all test strings through a single 'strings' invocation
+	// and search its output for all of them at once.
+	command << "printf '%s\\n'";
 	for (it = ret.first; it != ret.second; ++it){
-		command.str("");
-		commandOutput.clear();
-		command << "echo " << (*it).second << " | strings | grep " << (*it).second << " | tr -d ' '";
+		matcher.addPattern((*it).second);
+		// Quote each string for the guest shell. A quote is written as '\''.
+		command << " '";
+		for (std::string::const_iterator c_it = (*it).second.begin();
+				c_it != (*it).second.end(); ++c_it) {
+			if (*c_it == '\'') {
+				command << "'\\''";
+			} else {
+				command << *c_it;
+			}
+		}
+		command << "'";
+	}
+	command << " | strings | tr -d ' '";
+	matcher.compile();
 
-		this->shell->parseCommandOutput(command.str(), commandOutput);
+	this->shell->parseCommandOutput(command.str(), commandOutput);
+
+	std::vector<vmi::MultiPatternMatcher::Match> matches;
+	std::vector<bool> found(matcher.getPatternCount(), false);
+	matcher.scan(commandOutput, matches);
+	for (std::vector<vmi::MultiPatternMatcher::Match>::iterator m_it = matches.begin();
+			m_it != matches.end(); ++m_it) {
+		found[m_it->pattern] = true;
+	}
 
-		if(commandOutput.find((*it).second) == std::string::npos) stringsFailed = true;
+	bool stringsFailed = false;
+	for (size_t i = 0; i < found.size(); i++) {
+		if (!found[i]) stringsFailed = true;
 	}
 	if(!stringsFailed){
 		printInfo("\t\tChecking 'strings' command [ OK ]");
@@ -441,7 +743,7 @@ void RkHunterDetectionModule::performSharedLibrariesCheck() {
 	 */
 }
 void RkHunterDetectionModule::performFilePropertiesCheck() {
-	printInfo("\t Performing file properties checks");
+	report(vmi::OUTPUT_INFO, "\t Performing file properties checks");
 
 	//
 	// This function carries out a check of system command property
@@ -1693,97 +1995,85 @@ void RkHunterDetectionModule::performFilePropertiesCheck() {
 	 */
 }
 void RkHunterDetectionModule::performKnownRootkitCheck() {
-	info << "\t Performing check of known rootkit files and directories";
-	/*
-	 Performing check of known rootkit files and directories
-	 55808 Trojan - Variant A[33C[ [0;32mNot found[0;39m ]
-	 ADM Worm[49C[ [0;32mNot found[0;39m ]
-	 AjaKit Rootkit[43C[ [0;32mNot found[0;39m ]
-	 Adore Rootkit[44C[ [0;32mNot found[0;39m ]
-	 aPa Kit[50C[ [0;32mNot found[0;39m ]
-	 Apache Worm[46C[ [0;32mNot found[0;39m ]
-	 Ambient (ark) Rootkit[36C[ [0;32mNot found[0;39m ]
-	 Balaur Rootkit[43C[ [0;32mNot found[0;39m ]
-	 BeastKit Rootkit[41C[ [0;32mNot found[0;39m ]
-	 beX2 Rootkit[45C[ [0;32mNot found[0;39m ]
-	 BOBKit Rootkit[43C[ [0;32mNot found[0;39m ]
-	 cb Rootkit[47C[ [0;32mNot found[0;39m ]
-	 CiNIK Worm (Slapper.B variant)[27C[ [0;32mNot found[0;39m ]
-	 Danny-Boy's Abuse Kit[36C[ [0;32mNot found[0;39m ]
-	 Devil RootKit[44C[ [0;32mNot found[0;39m ]
-	 Dica-Kit Rootkit[41C[ [0;32mNot found[0;39m ]
-	 Dreams Rootkit[43C[ [0;32mNot found[0;39m ]
-	 Duarawkz Rootkit[41C[ [0;32mNot found[0;39m ]
-	 Enye LKM[49C[ [0;32mNot found[0;39m ]
-	 Flea Linux Rootkit[39C[ [0;32mNot found[0;39m ]
-	 FreeBSD Rootkit[42C[ [0;32mNot found[0;39m ]
-	 Fu Rootkit[47C[ [0;32mNot found[0;39m ]
-	 Fuck`it Rootkit[42C[ [0;32mNot found[0;39m ]
-	 GasKit Rootkit[43C[ [0;32mNot found[0;39m ]
-	 Heroin LKM[47C[ [0;32mNot found[0;39m ]
-	 HjC Kit[50C[ [0;32mNot found[0;39m ]
-	 ignoKit Rootkit[42C[ [0;32mNot found[0;39m ]
-	 iLLogiC Rootkit[42C[ [0;32mNot found[0;39m ]
-	 IntoXonia-NG Rootkit[37C[ [0;32mNot found[0;39m ]
-	 Irix Rootkit[45C[ [0;32mNot found[0;39m ]
-	 Kitko Rootkit[44C[ [0;32mNot found[0;39m ]
-	 Knark Rootkit[44C[ [0;32mNot found[0;39m ]
-	 ld-linuxv.so Rootkit[37C[ [0;32mNot found[0;39m ]
-	 Li0n Worm[48C[ [0;32mNot found[0;39m ]
-	 Lockit / LJK2 Rootkit[36C[ [0;32mNot found[0;39m ]
-	 Mood-NT Rootkit[42C[ [0;32mNot found[0;39m ]
-	 MRK Rootkit[46C[ [0;32mNot found[0;39m ]
-	 Ni0 Rootkit[46C[ [0;32mNot found[0;39m ]
-	 Ohhara Rootkit[43C[ [0;32mNot found[0;39m ]
-	 Optic Kit (Tux) Worm[37C[ [0;32mNot found[0;39m ]
-	 Oz Rootkit[47C[ [0;32mNot found[0;39m ]
-	 Phalanx Rootkit[42C[ [0;32mNot found[0;39m ]
-	 Phalanx2 Rootkit[41C[ [0;32mNot found[0;39m ]
-	 Phalanx2 Rootkit (extended tests)[24C[ [0;32mNot found[0;39m ]
-	 Portacelo Rootkit[40C[ [0;32mNot found[0;39m ]
-	 R3dstorm Toolkit[41C[ [0;32mNot found[0;39m ]
-	 RH-Sharpe's Rootkit[38C[ [0;32mNot found[0;39m ]
-	 RSHA's Rootkit[43C[ [0;32mNot found[0;39m ]
-	 Scalper Worm[45C[ [0;32mNot found[0;39m ]
-	 Sebek LKM[48C[ [0;32mNot found[0;39m ]
-	 Shutdown Rootkit[41C[ [0;32mNot found[0;39m ]
-	 SHV4 Rootkit[45C[ [0;32mNot found[0;39m ]
-	 SHV5 Rootkit[45C[ [0;32mNot found[0;39m ]
-	 Sin Rootkit[46C[ [0;32mNot found[0;39m ]
-	 Slapper Worm[45C[ [0;32mNot found[0;39m ]
-	 Sneakin Rootkit[42C[ [0;32mNot found[0;39m ]
-	 'Spanish' Rootkit[40C[ [0;32mNot found[0;39m ]
-	 Suckit Rootkit[43C[ [0;32mNot found[0;39m ]
-	 SunOS Rootkit[44C[ [0;32mNot found[0;39m ]
-	 SunOS / NSDAP Rootkit[36C[ [0;32mNot found[0;39m ]
-	 Superkit Rootkit[41C[ [0;32mNot found[0;39m ]
-	 TBD (Telnet BackDoor)[36C[ [0;32mNot found[0;39m ]
-	 TeLeKiT Rootkit[42C[ [0;32mNot found[0;39m ]
-	 T0rn Rootkit[45C[ [0;32mNot found[0;39m ]
-	 trNkit Rootkit[43C[ [0;32mNot found[0;39m ]
-	 Trojanit Kit[45C[ [0;32mNot found[0;39m ]
-	 Tuxtendo Rootkit[41C[ [0;32mNot found[0;39m ]
-	 URK Rootkit[46C[ [0;32mNot found[0;39m ]
-	 Vampire Rootkit[42C[ [0;32mNot found[0;39m ]
-	 VcKit Rootkit[44C[ [0;32mNot found[0;39m ]
-	 Volc Rootkit[45C[ [0;32mNot found[0;39m ]
-	 Xzibit Rootkit[43C[ [0;32mNot found[0;39m ]
-	 X-Org SunOS Rootkit[38C[ [0;32mNot found[0;39m ]
-	 zaRwT.KiT Rootkit[40C[ [0;32mNot found[0;39m ]
-	 ZK Rootkit[47C[ [0;32mNot found[0;39m ]
-	 */
+	report(vmi::OUTPUT_INFO, "\t Performing check of known rootkit files and directories");
+
+	std::map<std::string, struct stat> existingFiles;
+	std::vector<RootkitSignatureMatch> matches;
+
+	this->fs->filesExist(this->knownRootkits.getPaths(), existingFiles);
+	this->knownRootkits.evaluate(existingFiles, matches);
+
+	std::stringstream message;
+	for (std::vector<RootkitSignatureMatch>::iterator it = matches.begin();
+			it != matches.end(); ++it) {
+		message.str("");
+		message << "\t\t" << it->rootkitName << " [ Warning ]";
+		for (std::vector<std::string>::iterator p_it = it->foundPaths.begin();
+				p_it != it->foundPaths.end(); ++p_it) {
+			message << "\n\t\t\tFound: " << *p_it;
+		}
+		report(vmi::OUTPUT_WARN, message.str());
+	}
+
+	message.str("");
+	message << "\t\tRootkits checked : " << this->knownRootkits.getRootkitCount();
+	message << "\n\t\tFiles checked    : " << this->knownRootkits.getPaths().size();
+	report(vmi::OUTPUT_INFO, message.str());
+	if (matches.empty()) {
+		report(vmi::OUTPUT_INFO, "\t\tPossible rootkits: [ None found ]");
+	} else {
+		message.str("");
+		message << "\t\tPossible rootkits: " << matches.size();
+		report(vmi::OUTPUT_WARN, message.str());
+		this->raiseThreat();
+	}
 }
 void RkHunterDetectionModule::performAdditionalRootkitCheck() {
-	printInfo("\t Performing additional rootkit checks");
+	report(vmi::OUTPUT_INFO, "\t Performing additional rootkit checks");
 	/*
 	 Performing additional rootkit checks
 	 Suckit Rookit additional checks[26C[ [0;32mOK[0;39m ]
 	 Checking for possible rootkit files and directories[6C[ [0;32mNone found[0;39m ]
 	 Checking for possible rootkit strings[20C[ [1;31mWarning[0;39m ]
 	 */
+
+	std::set<std::string> binaries;
+	for (size_t i = 0; i < sizeof(rootkitStringBinaries) / sizeof(rootkitStringBinaries[0]); i++) {
+		binaries.insert(rootkitStringBinaries[i]);
+	}
+
+	std::map<std::string, std::vector<vmi::MultiPatternMatcher::Match> > matches;
+	this->fs->scanFiles(binaries, this->rootkitStrings, matches);
+
+	std::stringstream message;
+	message << "\t\tScanned " << this->rootkitStrings.getScannedBytes() << " bytes for "
+			<< this->rootkitStrings.getPatternCount() << " strings with "
+			<< this->rootkitStrings.getThroughput() << " MB/s";
+	report(vmi::OUTPUT_DEBUG, message.str());
+
+	if (matches.empty()) {
+		report(vmi::OUTPUT_INFO, "\t\tChecking for possible rootkit strings [ None found ]");
+		return;
+	}
+	for (std::map<std::string, std::vector<vmi::MultiPatternMatcher::Match> >::iterator it = matches.begin();
+			it != matches.end(); ++it) {
+		std::set<size_t> patterns;
+		for (std::vector<vmi::MultiPatternMatcher::Match>::iterator m_it = it->second.begin();
+				m_it != it->second.end(); ++m_it) {
+			patterns.insert(m_it->pattern);
+		}
+		for (std::set<size_t>::iterator p_it = patterns.begin(); p_it != patterns.end(); ++p_it) {
+			message.str("");
+			message << "\t\tFound string '" << this->rootkitStrings.getPattern(*p_it)
+					<< "' in file " << it->first;
+			report(vmi::OUTPUT_WARN, message.str());
+		}
+	}
+	report(vmi::OUTPUT_WARN, "\t\tChecking for possible rootkit strings [ Warning ]");
+	this->raiseThreat();
 }
 void RkHunterDetectionModule::performMalwareCheck() {
-	printInfo("\t Performing malware checks");
+	report(vmi::OUTPUT_INFO, "\t Performing malware checks");
 	/*
 	 Performing malware checks
 	 Checking running processes for suspicious files[10C[ [0;32mNone found[0;39m ]
@@ -1793,14 +2083,14 @@ void RkHunterDetectionModule::performMalwareCheck() {
 	 */
 }
 void RkHunterDetectionModule::performTrojanSpecificCheck() {
-	printInfo("\t Performing trojan specific checks");
+	report(vmi::OUTPUT_INFO, "\t Performing trojan specific checks");
 	/*
 	 Performing trojan specific checks
 	 Checking for enabled inetd services[22C[ [0;32mOK[0;39m ]
 	 */
 }
 void RkHunterDetectionModule::performLinuxSpecificCheck() {
-	printInfo("\t Performing Linux specific checks");
+	report(vmi::OUTPUT_INFO, "\t Performing Linux specific checks");
 	/*
 	 Performing Linux specific checks
 	 Checking loaded kernel modules[27C[ [0;32mOK[0;39m ]
@@ -1833,6 +2123,25 @@ void RkHunterDetectionModule::performBackdoorCheck() {
 	 Checking for TCP port 62883[30C[ [0;32mNot found[0;39m ]
 	 Checking for TCP port 65535[30C[ [0;32mNot found[0;39m ]
 	 */
+
+	bool backdoorFound = false;
+	for (std::vector<NetworkSocket>::iterator it = this->networkSockets.begin();
+			it != this->networkSockets.end(); ++it) {
+		bool listening = (it->protocol == NETWORK_TCP) ?
+				(it->state == NETWORK_TCP_LISTEN) : (it->remotePort == 0);
+		if (listening && this->backdoorPorts.contains(it->protocol, it->localPort)) {
+			warn << "\t\tChecking for " << ((it->protocol == NETWORK_TCP) ? "TCP" : "UDP")
+					<< " port " << it->localPort << " [ Warning ] ("
+					<< this->backdoorPorts.getDescription(it->protocol, it->localPort) << ")" << std::endl;
+			backdoorFound = true;
+		}
+	}
+	if (backdoorFound) {
+		warn << "\t\tChecking for backdoor ports [ Warning ]" << std::endl;
+		this->raiseThreat();
+	} else {
+		printInfo("\t\tChecking %u backdoor ports [ Not found ]", (unsigned int) this->backdoorPorts.size());
+	}
 }
 void RkHunterDetectionModule::performNetworkInterfacesCheck() {
 	printInfo("\t Performing checks on the network interfaces");
@@ -1840,9 +2149,24 @@ void RkHunterDetectionModule::performNetworkInterfacesCheck() {
 	 Performing checks on the network interfaces
 	 Checking for promiscuous interfaces[22C[ [0;32mNone found[0;39m ]
 	 */
+
+	bool promiscuousFound = false;
+	for (std::vector<NetworkInterface>::iterator it = this->networkInterfaces.begin();
+			it != this->networkInterfaces.end(); ++it) {
+		if (it->flags & NETWORK_IFF_PROMISC) {
+			warn << "\t\tInterface in promiscuous mode: " << it->name << std::endl;
+			promiscuousFound = true;
+		}
+	}
+	if (promiscuousFound) {
+		warn << "\t\tChecking for promiscuous interfaces [ Warning ]" << std::endl;
+		this->raiseThreat();
+	} else {
+		printInfo("\t\tChecking for promiscuous interfaces [ None found ]");
+	}
 }
 void RkHunterDetectionModule::performSystemBootCheck() {
-	printInfo("\t Performing system boot checks");
+	report(vmi::OUTPUT_INFO, "\t Performing system boot checks");
 	/*
 	 Performing system boot checks
 	 Checking for local host name[29C[ [0;32mFound[0;39m ]
@@ -1851,7 +2175,7 @@ void RkHunterDetectionModule::performSystemBootCheck() {
 	 */
 }
 void RkHunterDetectionModule::performGroupAndAccountCheck() {
-	printInfo("\t Performing group and account checks");
+	report(vmi::OUTPUT_INFO, "\t Performing group and account checks");
 	/*
 	 Performing group and account checks
 	 Checking for passwd file[33C[ [0;32mFound[0;39m ]
@@ -1863,7 +2187,7 @@ void RkHunterDetectionModule::performGroupAndAccountCheck() {
 	 */
 }
 void RkHunterDetectionModule::performSystemConfigurationCheck() {
-	printInfo("\t Performing system configuration file checks");
+	report(vmi::OUTPUT_INFO, "\t Performing system configuration file checks");
 	/*
 	 Performing system configuration file checks
 	 Checking for SSH configuration file[22C[ [0;32mFound[0;39m ]
@@ -1875,7 +2199,7 @@ void RkHunterDetectionModule::performSystemConfigurationCheck() {
 	 */
 }
 void RkHunterDetectionModule::performFileSystemCheck() {
-	printInfo("\t Performing filesystem checks");
+	report(vmi::OUTPUT_INFO, "\t Performing filesystem checks");
 	/*
 	 Performing filesystem checks
 	 Checking /dev for suspicious file types[18C[ [1;31mWarning[0;39m ]
@@ -13,9 +13,18 @@
 #include "vmiids/modules/sensor/QemuMonitorSensorModule.h"
 #include "vmiids/modules/sensor/FileSystemSensorModule.h"
 #include "vmiids/modules/sensor/ShellSensorModule.h"
+#include "vmiids/modules/sensor/NetworkSensorModule.h"
+
+#include "RootkitSignatureIndex.h"
+#include "RkHunterVariableCache.h"
+#include "vmiids/modules/sensor/BackdoorPortIndex.h"
+
+#include "vmiids/util/MultiPatternMatcher.h"
+#include "vmiids/util/ThreadPool.h"
 
 #include <map>
 #include <string>
+#include <vector>
 
 /**
  * @class RkHunterDetectionModule RkHunterDetectionModule.h "vmiids/modules/detection/RkHunterDetectionModule.h"
@@ -24,20 +33,101 @@
  * @sa QemuMonitorSensorModule
  * @sa FileSystemSensorModule
  * @sa ShellSensorModule
+ * @sa NetworkSensorModule
  * @deprecated
  *
  * This DetectionModule is a first approach to port RKhunter as a module into the VmiIDS framework.
  * As the entire Rkhunter is a very large and complicated script the module is currently unfinished.
+ *
+ * Every check is declared with the sensor it depends on (see checkTable). Checks depending on the
+ * guest shell require a running VM and are run one after another. The VM is only resumed for this
+ * phase. Checks working on the file system are run in parallel on a worker pool, checks working on
+ * the memory are run one after another on a single worker. Both run concurrently with the shell phase.
+ * Output of checks running on the pool is passed directly to the NotificationModules (see report()).
  */
 class RkHunterDetectionModule : public vmi::DetectionModule {
 private:
+	/**
+	 * @enum CHECK_DEPENDENCY
+	 *
+	 * Sensor a check depends on.
+	 */
+	typedef enum {
+		CHECK_SHELL,       //!< Check uses the guest shell. Requires a running VM.
+		CHECK_FILESYSTEM,  //!< Check only uses the file system of the VM.
+		CHECK_MEMORY       //!< Check only uses the memory of the VM.
+	} CHECK_DEPENDENCY;
+
+	typedef void (RkHunterDetectionModule::*CheckFunction)();
+
+	/**
+	 * Description of a single check.
+	 */
+	typedef struct{
+		CheckFunction check;          //!< Function performing the check.
+		CHECK_DEPENDENCY dependency;  //!< Sensor used by the check.
+	} CheckDescription;
+
+	/**
+	 * @class CheckGroup
+	 * @brief Group of checks run one after another on a worker of the ThreadPool.
+	 */
+	class CheckGroup : public vmi::ThreadPool::Task {
+	private:
+		RkHunterDetectionModule *module;    //!< Module the checks belong to.
+		std::vector<CheckFunction> checks;  //!< Checks of this group.
+	public:
+		CheckGroup(RkHunterDetectionModule *module) : module(module) {}
+		void add(CheckFunction check) { checks.push_back(check); }
+		bool empty() const { return checks.empty(); }
+		virtual void run(void);
+	};
+
+	static const CheckDescription checkTable[];  //!< All checks in rkhunter order.
+	static const size_t checkCount;              //!< Number of entries in checkTable.
+
+	size_t checkThreads;  //!< Number of workers running file system checks (Optional config option, defaults to the number of CPUs)
+
 	QemuMonitorSensorModule * qemu;
 	FileSystemSensorModule * fs;
 	ShellSensorModule * shell;
+	NetworkSensorModule * network;
 
+	std::string rkhunterScript;  //!< Path of the rkhunter script (Must be set in config file @ref vmi::Settings)
 	std::multimap<std::string,std::string> rkvars;
 
+	RootkitSignatureIndex knownRootkits;  //!< Files and directories of all known rootkits.
+	vmi::MultiPatternMatcher rootkitStrings;  //!< Strings left in system binaries by known rootkits.
+	BackdoorPortIndex backdoorPorts;  //!< Ports used by known backdoors.
+	volatile int threatFound;  //!< Set by checks on the ThreadPool. Merged into threatLevel after the run.
+
+	std::vector<NetworkSocket> networkSockets;        //!< Sockets of the guest. Fetched once per run() for the network checks.
+	std::vector<NetworkInterface> networkInterfaces;  //!< Network interfaces of the guest. Fetched with networkSockets.
+
+	/**
+	 * Parse the variables of the rkhunter script into rkvars.
+	 * Only called if no valid RkHunterVariableCache exists.
+	 * Throws a vmi::ModuleException naming the line, if the script contains an unexpected line.
+	 */
 	void initializeVariables();
+	/**
+	 * Build the index of known rootkit files and directories from the rkhunter variables.
+	 */
+	void initializeKnownRootkits();
+
+	/**
+	 * Thread safe output function used by checks running on the ThreadPool.
+	 * The message is passed directly to the NotificationModules instead of the
+	 * modules output streams, which must only be used by a single thread.
+	 *
+	 * @param level Severity of the message.
+	 * @param message Message to output.
+	 */
+	void report(vmi::DEBUG_LEVEL level, const std::string &message);
+	/**
+	 * Thread safe replacement of setting threatLevel, for checks running on the ThreadPool.
+	 */
+	void raiseThreat();
 
 	void performStringCommandCheck();
 	void performSharedLibrariesCheck();
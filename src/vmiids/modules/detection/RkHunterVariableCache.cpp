@@ -0,0 +1,137 @@
+/*
+ * RkHunterVariableCache.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#include "RkHunterVariableCache.h"
+
+#include "vmiids/util/MappedFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define CACHEVERSION 1
+
+RkHunterVariableCache::RkHunterVariableCache(const std::string &scriptPath) :
+	scriptPath(scriptPath), cachePath(scriptPath) {
+	this->cachePath.append(".cache");
+}
+
+RkHunterVariableCache::~RkHunterVariableCache() {
+}
+
+const std::string &RkHunterVariableCache::getCachePath() const {
+	return this->cachePath;
+}
+
+bool RkHunterVariableCache::getScriptHeader(CacheHeader &header) {
+	vmi::MappedFile script;
+	struct stat scriptInfo;
+
+	if (!script.open(this->scriptPath) || stat(this->scriptPath.c_str(), &scriptInfo) != 0) {
+		return false;
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "RKVC", 4);
+	header.version = CACHEVERSION;
+	header.scriptMtime = scriptInfo.st_mtime;
+	header.scriptSize = script.getSize();
+
+	// 64 bit FNV-1a
+	header.scriptHash = 14695981039346656037ULL;
+	const unsigned char * data = (const unsigned char *) script.getData();
+	for (size_t i = 0; i < script.getSize(); i++) {
+		header.scriptHash ^= data[i];
+		header.scriptHash *= 1099511628211ULL;
+	}
+	return true;
+}
+
+bool RkHunterVariableCache::load(std::multimap<std::string, std::string> &variables) {
+	vmi::MappedFile cache;
+	struct stat scriptInfo;
+	CacheHeader scriptHeader;
+
+	if (!cache.open(this->cachePath) || cache.getSize() < sizeof(CacheHeader)) {
+		return false;
+	}
+	const CacheHeader * cacheHeader = (const CacheHeader *) cache.getData();
+
+	// Compare the cheap attributes first. The script is only hashed if they match.
+	if (memcmp(cacheHeader->magic, "RKVC", 4) != 0 || cacheHeader->version != CACHEVERSION
+			|| stat(this->scriptPath.c_str(), &scriptInfo) != 0
+			|| cacheHeader->scriptMtime != (int64_t) scriptInfo.st_mtime
+			|| cacheHeader->scriptSize != (uint64_t) scriptInfo.st_size) {
+		return false;
+	}
+	if (!this->getScriptHeader(scriptHeader) || cacheHeader->scriptHash != scriptHeader.scriptHash) {
+		return false;
+	}
+
+	std::multimap<std::string, std::string> cachedVariables;
+	const char * position = cache.getData() + sizeof(CacheHeader);
+	const char * end = cache.getData() + cache.getSize();
+	uint32_t lengths[2];
+
+	for (uint64_t i = 0; i < cacheHeader->recordCount; i++) {
+		if ((size_t) (end - position) < sizeof(lengths)) {
+			return false;
+		}
+		memcpy(lengths, position, sizeof(lengths));
+		position += sizeof(lengths);
+		if ((uint64_t) (end - position) < (uint64_t) lengths[0] + lengths[1]) {
+			return false;
+		}
+		cachedVariables.insert(std::pair<std::string, std::string>(
+				std::string(position, lengths[0]),
+				std::string(position + lengths[0], lengths[1])));
+		position += lengths[0] + lengths[1];
+	}
+
+	variables.insert(cachedVariables.begin(), cachedVariables.end());
+	return true;
+}
+
+bool RkHunterVariableCache::store(const std::multimap<std::string, std::string> &variables) {
+	CacheHeader header;
+
+	if (!this->getScriptHeader(header)) {
+		return false;
+	}
+	header.recordCount = variables.size();
+
+	std::stringstream temporaryPath;
+	temporaryPath << this->cachePath << "." << getpid();
+
+	std::ofstream cacheFile(temporaryPath.str().c_str(), std::ofstream::out
+			| std::ofstream::binary | std::ofstream::trunc);
+	if (!cacheFile.is_open()) {
+		return false;
+	}
+
+	cacheFile.write((const char *) &header, sizeof(header));
+	uint32_t lengths[2];
+	for (std::multimap<std::string, std::string>::const_iterator it = variables.begin();
+			it != variables.end(); ++it) {
+		lengths[0] = it->first.size();
+		lengths[1] = it->second.size();
+		cacheFile.write((const char *) lengths, sizeof(lengths));
+		cacheFile.write(it->first.data(), it->first.size());
+		cacheFile.write(it->second.data(), it->second.size());
+	}
+	cacheFile.close();
+
+	if (cacheFile.fail() || rename(temporaryPath.str().c_str(), this->cachePath.c_str()) != 0) {
+		unlink(temporaryPath.str().c_str());
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,91 @@
+/*
+ * RkHunterVariableCache.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef RKHUNTERVARIABLECACHE_H_
+#define RKHUNTERVARIABLECACHE_H_
+
+#include <string>
+#include <map>
+
+#include <stdint.h>
+
+/**
+ * @class RkHunterVariableCache RkHunterVariableCache.h "vmiids/modules/detection/RkHunterVariableCache.h"
+ * @brief Binary cache of the variables parsed from the rkhunter script.
+ * @sa RkHunterDetectionModule
+ *
+ * Parsing the rkhunter script with regular expressions takes a noticeable amount of time on every
+ * module load. The parsed variables are therefore stored in a compact binary file next to the
+ * script (the script path with the suffix ".cache" appended).
+ *
+ * The cache file starts with a header containing the modification time, the size and a 64 bit
+ * FNV-1a hash of the script it was created from. It is only used if all three values still match
+ * the script. The header is followed by one record per variable:
+ * the length of the name and the content (32 bit each), followed by the name and the content.
+ *
+ * The cache is loaded with a single mmap.
+ */
+class RkHunterVariableCache {
+public:
+	/**
+	 * Constructor
+	 *
+	 * @param scriptPath Path of the rkhunter script.
+	 */
+	RkHunterVariableCache(const std::string &scriptPath);
+	/**
+	 * Destructor
+	 */
+	virtual ~RkHunterVariableCache();
+
+	/**
+	 * Load the variables from the cache file.
+	 *
+	 * @param variables Multimap to insert the cached variables into.
+	 * @return True, if a valid cache was found. Otherwise the script must be parsed.
+	 */
+	bool load(std::multimap<std::string, std::string> &variables);
+	/**
+	 * Store the variables into the cache file.
+	 * The file is written to a temporary file first, which then replaces the cache.
+	 *
+	 * @param variables Variables parsed from the script.
+	 * @return True, if the cache file was written.
+	 */
+	bool store(const std::multimap<std::string, std::string> &variables);
+
+	/**
+	 * @return Path of the cache file.
+	 */
+	const std::string &getCachePath() const;
+
+private:
+	/**
+	 * Header of the cache file.
+	 */
+	typedef struct{
+		char magic[4];          //!< File magic. Always "RKVC".
+		uint32_t version;       //!< Version of the file format.
+		int64_t scriptMtime;    //!< Modification time of the script.
+		uint64_t scriptSize;    //!< Size of the script.
+		uint64_t scriptHash;    //!< FNV-1a hash of the script.
+		uint64_t recordCount;   //!< Number of variable records following the header.
+	} CacheHeader;
+
+	std::string scriptPath;  //!< Path of the rkhunter script.
+	std::string cachePath;   //!< Path of the cache file.
+
+	/**
+	 * Build the header describing the current version of the script.
+	 *
+	 * @param header Header to fill.
+	 * @return True, if the script could be read.
+	 */
+	bool getScriptHeader(CacheHeader &header);
+};
+
+#endif /* RKHUNTERVARIABLECACHE_H_ */
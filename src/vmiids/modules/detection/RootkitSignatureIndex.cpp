@@ -0,0 +1,100 @@
+/*
+ * RootkitSignatureIndex.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#include "RootkitSignatureIndex.h"
+
+#include <sstream>
+
+RootkitSignatureIndex::RootkitSignatureIndex() {
+}
+
+RootkitSignatureIndex::~RootkitSignatureIndex() {
+}
+
+void RootkitSignatureIndex::addRootkit(const std::string &rootkitName,
+		const std::vector<std::string> &files,
+		const std::vector<std::string> &directories) {
+	PathReference reference;
+	reference.rootkit = this->rootkitNames.size();
+	this->rootkitNames.push_back(rootkitName);
+
+	reference.isDirectory = false;
+	for (std::vector<std::string>::const_iterator it = files.begin();
+			it != files.end(); ++it) {
+		this->insertPaths(*it, reference);
+	}
+	reference.isDirectory = true;
+	for (std::vector<std::string>::const_iterator it = directories.begin();
+			it != directories.end(); ++it) {
+		this->insertPaths(*it, reference);
+	}
+}
+
+void RootkitSignatureIndex::insertPaths(const std::string &pathList,
+		PathReference reference) {
+	std::istringstream stream(pathList);
+	std::string path;
+	size_t position;
+
+	while (stream >> path) {
+		// The rkhunter script prefixes most paths with its root directory variable.
+		while ((position = path.find("${RKHROOTDIR}")) != std::string::npos) {
+			path.erase(position, 13);
+		}
+		while ((position = path.find('"')) != std::string::npos) {
+			path.erase(position, 1);
+		}
+		while (path.size() > 1 && path[path.size() - 1] == '/') {
+			path.erase(path.size() - 1);
+		}
+		if (path.empty() || path[0] != '/') {
+			continue;
+		}
+		this->index.insert(std::pair<std::string, PathReference>(path, reference));
+		this->paths.insert(path);
+	}
+}
+
+const std::set<std::string> &RootkitSignatureIndex::getPaths() const {
+	return this->paths;
+}
+
+size_t RootkitSignatureIndex::getRootkitCount() const {
+	return this->rootkitNames.size();
+}
+
+void RootkitSignatureIndex::evaluate(
+		const std::map<std::string, struct stat> &existingFiles,
+		std::vector<RootkitSignatureMatch> &matches) const {
+
+	std::map<size_t, RootkitSignatureMatch> found;
+
+	// Both sequences are sorted by path, so they are merged in a single pass.
+	std::multimap<std::string, PathReference>::const_iterator i_it = this->index.begin();
+	std::map<std::string, struct stat>::const_iterator f_it = existingFiles.begin();
+
+	while (i_it != this->index.end() && f_it != existingFiles.end()) {
+		int order = i_it->first.compare(f_it->first);
+		if (order < 0) {
+			++i_it;
+		} else if (order > 0) {
+			++f_it;
+		} else {
+			if (i_it->second.isDirectory == (bool) S_ISDIR(f_it->second.st_mode)) {
+				RootkitSignatureMatch &match = found[i_it->second.rootkit];
+				match.rootkitName = this->rootkitNames[i_it->second.rootkit];
+				match.foundPaths.push_back(i_it->first);
+			}
+			++i_it;
+		}
+	}
+
+	for (std::map<size_t, RootkitSignatureMatch>::iterator it = found.begin();
+			it != found.end(); ++it) {
+		matches.push_back(it->second);
+	}
+}
@@ -0,0 +1,111 @@
+/*
+ * RootkitSignatureIndex.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef ROOTKITSIGNATUREINDEX_H_
+#define ROOTKITSIGNATUREINDEX_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+#include <sys/stat.h>
+
+/**
+ * Result of a RootkitSignatureIndex evaluation.
+ * Contains the name of a rootkit and all of its files and directories found.
+ */
+typedef struct{
+	std::string rootkitName;
+	std::vector<std::string> foundPaths;
+} RootkitSignatureMatch;
+
+/**
+ * @class RootkitSignatureIndex RootkitSignatureIndex.h "vmiids/modules/detection/RootkitSignatureIndex.h"
+ * @brief Index of files and directories belonging to known rootkits.
+ * @sa RkHunterDetectionModule
+ * @sa FileSystemSensorModule::filesExist()
+ *
+ * Rkhunter checks each known rootkit on its own, which results in one file system access for
+ * every suspicious path. This index merges the paths of all rootkits into one sorted path map.
+ * Every path references the rootkits it belongs to. The whole index is thus checked with a single
+ * sweep over the file system (see FileSystemSensorModule::filesExist()).
+ *
+ * The result of the sweep is evaluated against the index by merging both sorted sequences.
+ */
+class RootkitSignatureIndex {
+public:
+	/**
+	 * Constructor
+	 */
+	RootkitSignatureIndex();
+	/**
+	 * Destructor
+	 */
+	virtual ~RootkitSignatureIndex();
+
+	/**
+	 * Add a rootkit to the index.
+	 *
+	 * The file and directory lists are given in rkhunter syntax. Each list contains
+	 * whitespace separated absolute paths.
+	 *
+	 * @param rootkitName Name of the rootkit.
+	 * @param files List of files belonging to the rootkit.
+	 * @param directories List of directories belonging to the rootkit.
+	 */
+	void addRootkit(const std::string &rootkitName,
+			const std::vector<std::string> &files,
+			const std::vector<std::string> &directories);
+
+	/**
+	 * Request all paths contained in the index.
+	 * @return Sorted set of all paths in the index.
+	 */
+	const std::set<std::string> &getPaths() const;
+
+	/**
+	 * Request the number of rootkits contained in the index.
+	 * @return Number of rootkits.
+	 */
+	size_t getRootkitCount() const;
+
+	/**
+	 * Compare the files found on the monitored file system with the index.
+	 *
+	 * A file only matches if it has the expected type. Files listed as directory must be
+	 * directories, all other files must not be directories.
+	 *
+	 * @param existingFiles Files found on the monitored file system.
+	 * @param matches List to append every rootkit found to.
+	 */
+	void evaluate(const std::map<std::string, struct stat> &existingFiles,
+			std::vector<RootkitSignatureMatch> &matches) const;
+
+private:
+	/**
+	 * Reference from a path to a rootkit.
+	 */
+	typedef struct{
+		size_t rootkit;     //!< Index of the rootkit within rootkitNames.
+		bool isDirectory;   //!< Flag, whether the path is expected to be a directory.
+	} PathReference;
+
+	std::vector<std::string> rootkitNames;  //!< Names of the rootkits contained in the index.
+	std::multimap<std::string, PathReference> index;  //!< Sorted path index.
+	std::set<std::string> paths;  //!< Set of all distinct paths within the index.
+
+	/**
+	 * Split a rkhunter path list and insert all paths into the index.
+	 *
+	 * @param pathList Whitespace separated list of paths.
+	 * @param reference Reference to store for each path.
+	 */
+	void insertPaths(const std::string &pathList, PathReference reference);
+};
+
+#endif /* ROOTKITSIGNATUREINDEX_H_ */
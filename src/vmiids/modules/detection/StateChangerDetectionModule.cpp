@@ -9,7 +9,7 @@
 
 #include "StateChangerDetectionModule.h"
 
-LOADMODULE(StateChangerDetectionModule);
+LOADMODULE_DEPENDS(StateChangerDetectionModule, "QemuMonitorSensorModule");
 
 int StateChangerDetectionModule::runCounter = 0;
 
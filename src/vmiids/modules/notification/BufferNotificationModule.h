@@ -9,6 +9,7 @@
 #define BUFFERNOTIFICATIONMODULE_H_
 
 #include "vmiids/NotificationModule.h"
+#include "vmiids/util/Mutex.h"
 
 #include <sstream>
 
@@ -17,18 +18,23 @@
  * @brief Output to a buffer
  * @sa vmi::NotificationModule
  *
- * This module is built to store the frameworks output in an internal buffer.
+ * This module is built to store the output of a single detection run in an internal buffer.
+ * The module is not registered globally, it only receives notifications tagged with its run ID.
+ * Concurrent runs thus use separate buffers.
  * The buffer can be received by using the getBuffer() function.
  */
 class BufferNotificationModule: public vmi::NotificationModule {
 private:
 	std::stringstream stream;
+	vmi::Mutex bufferMutex;  //!< Notifications are written by the dispatcher thread.
 
 public:
 	/**
 	 * Constructor
+	 *
+	 * @param runId Run to capture. See vmi::Thread::createRunId().
 	 */
-	BufferNotificationModule();
+	BufferNotificationModule(uint32_t runId);
 	/**
 	 * Destructor
 	 */
@@ -37,17 +43,13 @@ public:
 	/**
 	 * Receive a buffer containing the currently recorded data.
 	 * When the buffer is requested by a user the internal buffer is flushed.
+	 * Notifications still queued for the dispatcher are not included (see NotificationModule::waitForDispatch()).
 	 *
 	 * @return String containing the currently recorded data.
 	 */
 	std::string getBuffer();
 
-	virtual void doDebug(std::string module, std::string message);
-	virtual void doInfo(std::string module, std::string message);
-	virtual void doWarn(std::string module, std::string message);
-	virtual void doError(std::string module, std::string message);
-	virtual void doCritical(std::string module, std::string message);
-	virtual void doAlert(std::string module, std::string message);
+	virtual void doNotify(const vmi::NotificationRecord &record);
 };
 
 #endif /* RPCNOTIFICATIONMODULE_H_ */
@@ -0,0 +1,110 @@
+/*
+ * EventLogFormat.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef EVENTLOGFORMAT_H_
+#define EVENTLOGFORMAT_H_
+
+#include <stdint.h>
+#include <cstdio>
+#include <string>
+
+/**
+ * @file EventLogFormat.h
+ * @brief On-disk format of the event log written by the EventLogNotificationModule.
+ *
+ * An event log is a directory containing:
+ *  - Segment files "events-<sequence>.log". Each segment starts with an EventLogSegmentHeader
+ *    followed by records. A record is an EventLogRecordHeader followed by the payload
+ *    (the message text) and padding to EVENTLOG_ALIGNMENT bytes.
+ *  - Sparse index files "events-<sequence>.idx", one per segment. An EventLogIndexEntry is
+ *    appended every indexInterval bytes of records.
+ *  - The module table "modules". One line "<id> <module name>" per module ever logged.
+ *    Module IDs are stable across restarts.
+ *
+ * Segments are written through a shared mapping. A record is complete once dataEnd in the
+ * segment header covers it, so readers may read a segment while it is written.
+ * All values are stored in host byte order.
+ */
+
+#define EVENTLOG_MAGIC       "VMEL"  //!< Magic of a segment file.
+#define EVENTLOG_VERSION     1       //!< Version of the format.
+#define EVENTLOG_ALIGNMENT   8       //!< Alignment of all records in a segment.
+#define EVENTLOG_MODULEFILE  "modules"  //!< Name of the module table in the log directory.
+#define EVENTLOG_UNKNOWN_MODULE 0xFFFF  //!< Module ID used once the module table is full.
+
+/**
+ * Header at the start of each segment file.
+ */
+typedef struct {
+	char magic[4];          //!< EVENTLOG_MAGIC
+	uint32_t version;       //!< EVENTLOG_VERSION
+	uint32_t headerSize;    //!< Offset of the first record.
+	uint32_t sequence;      //!< Sequence number of the segment.
+	uint64_t dataEnd;       //!< Offset behind the last complete record.
+	uint64_t firstTime;     //!< Smallest timestamp in the segment (us since epoch).
+	uint64_t lastTime;      //!< Largest timestamp in the segment (us since epoch).
+	uint32_t severityMask;  //!< Bit n is set, if the segment contains a record of severity n.
+	uint32_t recordCount;   //!< Number of records in the segment.
+} EventLogSegmentHeader;
+
+/**
+ * Header of each record in a segment.
+ */
+typedef struct {
+	uint32_t length;         //!< Length of the record including header, payload and padding.
+	uint8_t severity;        //!< Severity (vmi::DEBUG_LEVEL).
+	uint8_t reserved;        //!< Reserved. Zero.
+	uint16_t moduleId;       //!< ID of the module in the module table.
+	uint32_t runId;          //!< Run ID of the notification. Zero, if it did not belong to a run.
+	uint32_t payloadLength;  //!< Length of the payload.
+	uint64_t time;           //!< Timestamp (us since epoch).
+} EventLogRecordHeader;
+
+/**
+ * Entry of a sparse index file.
+ *
+ * maxTime is the largest timestamp of all records in front of offset. A reader looking for
+ * records newer than t can skip to the offset of the last entry with maxTime < t, even if
+ * records were not logged in strict time order.
+ */
+typedef struct {
+	uint64_t maxTime;  //!< Largest timestamp of all records in front of offset.
+	uint64_t offset;   //!< Offset of a record in the segment.
+} EventLogIndexEntry;
+
+/**
+ * Build the file name of a segment or index file.
+ *
+ * @param directory Directory of the event log.
+ * @param sequence Sequence number of the segment.
+ * @param suffix "log" or "idx".
+ * @return Path of the file.
+ */
+inline std::string eventLogFileName(const std::string &directory, uint32_t sequence, const char *suffix){
+	char name[32];
+	snprintf(name, sizeof(name), "events-%08u.%s", sequence, suffix);
+	return directory + "/" + name;
+}
+
+/**
+ * Parse the sequence number of a segment file name.
+ *
+ * @param name File name without directory.
+ * @param sequence Variable to store the sequence number in.
+ * @return True, if name is the name of a segment file.
+ */
+inline bool eventLogParseSegmentName(const char *name, uint32_t &sequence){
+	char suffix[4];
+	unsigned int value;
+	if (sscanf(name, "events-%8u.%3s", &value, suffix) != 2 || std::string(suffix) != "log") {
+		return false;
+	}
+	sequence = value;
+	return true;
+}
+
+#endif /* EVENTLOGFORMAT_H_ */
@@ -0,0 +1,247 @@
+/*
+ * EventLogNotificationModule.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#include "EventLogNotificationModule.h"
+#include "vmiids/VmiIDS.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define EVENTLOG_DEFAULT_SEGMENTSIZE   (16 * 1024 * 1024)
+#define EVENTLOG_DEFAULT_MAXSEGMENTS   8
+#define EVENTLOG_DEFAULT_INDEXINTERVAL (64 * 1024)
+
+LOADMODULE(EventLogNotificationModule);
+
+EventLogNotificationModule::EventLogNotificationModule() :
+		NotificationModule("EventLogNotificationModule") {
+	GETOPTION(directory, this->directory);
+
+	unsigned int value;
+	try {
+		GETOPTION(segmentSize, value);
+		this->segmentSize = value;
+	} catch (vmi::OptionNotFoundException &e) {
+		this->segmentSize = EVENTLOG_DEFAULT_SEGMENTSIZE;
+	}
+	try {
+		GETOPTION(maxSegments, value);
+		this->maxSegments = value;
+	} catch (vmi::OptionNotFoundException &e) {
+		this->maxSegments = EVENTLOG_DEFAULT_MAXSEGMENTS;
+	}
+	try {
+		GETOPTION(indexInterval, value);
+		this->indexInterval = value;
+	} catch (vmi::OptionNotFoundException &e) {
+		this->indexInterval = EVENTLOG_DEFAULT_INDEXINTERVAL;
+	}
+	if (this->segmentSize < 4096) this->segmentSize = 4096;
+	if (this->maxSegments < 1) this->maxSegments = 1;
+	if (this->indexInterval < 1) this->indexInterval = 1;
+
+	this->moduleFile = -1;
+	this->segmentFile = -1;
+	this->indexFile = -1;
+	this->segment = NULL;
+	this->header = NULL;
+	this->nextIndexOffset = 0;
+	this->maxTime = 0;
+
+	this->openLog();
+	if (!this->openSegment()) {
+		if (this->moduleFile >= 0) close(this->moduleFile);
+		throw vmi::ModuleException("Could not create event log segment in " + this->directory);
+	}
+}
+
+EventLogNotificationModule::~EventLogNotificationModule() {
+	this->detach();
+	this->closeSegment();
+	if (this->moduleFile >= 0) close(this->moduleFile);
+}
+
+void EventLogNotificationModule::openLog(){
+	std::string moduleFileName = this->directory + "/" + EVENTLOG_MODULEFILE;
+
+	// Fails if the directory exists. Any other error is reported when the first segment is created.
+	mkdir(this->directory.c_str(), 0755);
+
+	// Keep the IDs of previous runs, so all segments share one module table.
+	FILE *modules = fopen(moduleFileName.c_str(), "r");
+	if (modules != NULL) {
+		unsigned int id;
+		char name[256];
+		while (fscanf(modules, "%u %255s", &id, name) == 2) {
+			if (id >= EVENTLOG_UNKNOWN_MODULE) continue;
+			if (id >= this->moduleNames.size()) this->moduleNames.resize(id + 1);
+			this->moduleNames[id] = name;
+		}
+		fclose(modules);
+	}
+	this->moduleFile = open(moduleFileName.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+
+	DIR *dir = opendir(this->directory.c_str());
+	if (dir != NULL) {
+		struct dirent *entry;
+		uint32_t sequence;
+		while ((entry = readdir(dir)) != NULL) {
+			if (eventLogParseSegmentName(entry->d_name, sequence)) {
+				this->segments.push_back(sequence);
+			}
+		}
+		closedir(dir);
+	}
+	std::sort(this->segments.begin(), this->segments.end());
+}
+
+bool EventLogNotificationModule::openSegment(){
+	uint32_t sequence = (this->segments.empty()) ? 0 : this->segments.back() + 1;
+
+	while (this->segments.size() >= this->maxSegments) {
+		unlink(eventLogFileName(this->directory, this->segments.front(), "log").c_str());
+		unlink(eventLogFileName(this->directory, this->segments.front(), "idx").c_str());
+		this->segments.pop_front();
+	}
+
+	std::string segmentName = eventLogFileName(this->directory, sequence, "log");
+	this->segmentFile = open(segmentName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (this->segmentFile < 0) {
+		return false;
+	}
+	void *mapping = MAP_FAILED;
+	if (ftruncate(this->segmentFile, this->segmentSize) == 0) {
+		mapping = mmap(NULL, this->segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, this->segmentFile, 0);
+	}
+	if (mapping == MAP_FAILED) {
+		close(this->segmentFile);
+		this->segmentFile = -1;
+		unlink(segmentName.c_str());
+		return false;
+	}
+	this->indexFile = open(eventLogFileName(this->directory, sequence, "idx").c_str(),
+			O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+	this->segments.push_back(sequence);
+
+	this->segment = (char *) mapping;
+	this->header = (EventLogSegmentHeader *) mapping;
+	memcpy(this->header->magic, EVENTLOG_MAGIC, sizeof(this->header->magic));
+	this->header->version = EVENTLOG_VERSION;
+	this->header->headerSize = (sizeof(EventLogSegmentHeader) + EVENTLOG_ALIGNMENT - 1) & ~(EVENTLOG_ALIGNMENT - 1);
+	this->header->sequence = sequence;
+	this->header->firstTime = 0;
+	this->header->lastTime = 0;
+	this->header->severityMask = 0;
+	this->header->recordCount = 0;
+	this->header->dataEnd = this->header->headerSize;
+	this->nextIndexOffset = this->header->headerSize;
+	this->maxTime = 0;
+	return true;
+}
+
+void EventLogNotificationModule::closeSegment(){
+	if (this->segment == NULL) {
+		return;
+	}
+	uint64_t dataEnd = this->header->dataEnd;
+	munmap(this->segment, this->segmentSize);
+	if (ftruncate(this->segmentFile, dataEnd) != 0) {
+		// The unused tail stays zero filled. Readers only use data up to dataEnd.
+	}
+	close(this->segmentFile);
+	if (this->indexFile >= 0) close(this->indexFile);
+	this->segment = NULL;
+	this->header = NULL;
+	this->segmentFile = -1;
+	this->indexFile = -1;
+}
+
+uint16_t EventLogNotificationModule::getModuleId(const char *module, size_t moduleLength){
+	for (size_t id = 0; id < this->moduleNames.size(); id++) {
+		if (this->moduleNames[id].size() == moduleLength &&
+				memcmp(this->moduleNames[id].data(), module, moduleLength) == 0) {
+			return id;
+		}
+	}
+	if (this->moduleNames.size() >= EVENTLOG_UNKNOWN_MODULE) {
+		return EVENTLOG_UNKNOWN_MODULE;
+	}
+	uint16_t id = this->moduleNames.size();
+	this->moduleNames.push_back(std::string(module, moduleLength));
+	if (this->moduleFile >= 0) {
+		char line[32];
+		int length = snprintf(line, sizeof(line), "%u ", id);
+		std::string entry = std::string(line, length) + this->moduleNames.back() + "\n";
+		if (write(this->moduleFile, entry.data(), entry.size()) != (ssize_t) entry.size()) {
+			// Records of this module are still written, but can not be resolved by name.
+		}
+	}
+	return id;
+}
+
+void EventLogNotificationModule::doNotify(const vmi::NotificationRecord &record){
+	if (record.severity < debugLevel) {
+		return;
+	}
+
+	size_t payloadLength = record.messageLength;
+	size_t recordLength = (sizeof(EventLogRecordHeader) + payloadLength + EVENTLOG_ALIGNMENT - 1) & ~(EVENTLOG_ALIGNMENT - 1);
+	if (this->segment != NULL && this->header->recordCount > 0 &&
+			this->header->dataEnd + recordLength > this->segmentSize) {
+		this->closeSegment();
+	}
+	if (this->segment == NULL && !this->openSegment()) {
+		return;
+	}
+	if (this->header->dataEnd + recordLength > this->segmentSize) {
+		// Message larger than an empty segment. Store as much as fits.
+		payloadLength = this->segmentSize - this->header->dataEnd - sizeof(EventLogRecordHeader);
+		recordLength = (sizeof(EventLogRecordHeader) + payloadLength) & ~(EVENTLOG_ALIGNMENT - 1);
+		payloadLength = recordLength - sizeof(EventLogRecordHeader);
+	}
+
+	uint64_t offset = this->header->dataEnd;
+	uint64_t time = (uint64_t) record.time.tv_sec * 1000000 + record.time.tv_usec;
+
+	EventLogRecordHeader *entry = (EventLogRecordHeader *) (this->segment + offset);
+	entry->length = recordLength;
+	entry->severity = record.severity;
+	entry->reserved = 0;
+	entry->moduleId = this->getModuleId(record.getModule(), record.moduleLength);
+	entry->runId = record.runId;
+	entry->payloadLength = payloadLength;
+	entry->time = time;
+	memcpy(entry + 1, record.getMessage(), payloadLength);
+
+	if (offset >= this->nextIndexOffset && this->indexFile >= 0) {
+		EventLogIndexEntry indexEntry;
+		indexEntry.maxTime = this->maxTime;
+		indexEntry.offset = offset;
+		if (write(this->indexFile, &indexEntry, sizeof(indexEntry)) == sizeof(indexEntry)) {
+			this->nextIndexOffset = offset + this->indexInterval;
+		}
+	}
+
+	if (this->header->recordCount == 0 || time < this->header->firstTime) {
+		this->header->firstTime = time;
+	}
+	if (time > this->maxTime) {
+		this->maxTime = time;
+	}
+	this->header->lastTime = this->maxTime;
+	this->header->severityMask |= (1u << record.severity);
+	this->header->recordCount++;
+	// Publish the record to concurrent readers only after it is complete.
+	__sync_synchronize();
+	this->header->dataEnd = offset + recordLength;
+}
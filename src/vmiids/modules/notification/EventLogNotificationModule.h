@@ -0,0 +1,93 @@
+/*
+ * EventLogNotificationModule.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef EVENTLOGNOTIFICATIONMODULE_H_
+#define EVENTLOGNOTIFICATIONMODULE_H_
+
+#include "vmiids/NotificationModule.h"
+
+#include "EventLogFormat.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+
+/**
+ * @class EventLogNotificationModule EventLogNotificationModule.h "vmiids/modules/notification/EventLogNotificationModule.h"
+ * @brief Output to a binary event log
+ * @sa vmi::NotificationModule
+ * @sa EventLogFormat.h
+ *
+ * This module stores the frameworks output as binary records in a directory.
+ * Each record contains the timestamp, severity, module ID, run ID and message of a notification.
+ *
+ * Records are appended to a memory mapped segment file of fixed size. When a segment is full,
+ * the module continues with a new segment and deletes the oldest segments beyond maxSegments.
+ * A sparse time index is written next to each segment, so the reader (VMIeventlog) can filter
+ * by time without scanning whole segments.
+ *
+ * Options (@ref vmi::Settings):
+ *  - directory: Directory of the event log. Created, if it does not exist.
+ *  - segmentSize: Size of a segment in bytes (optional, default 16 MiB).
+ *  - maxSegments: Number of segments kept (optional, default 8).
+ *  - indexInterval: Bytes between two index entries (optional, default 64 KiB).
+ */
+class EventLogNotificationModule: public vmi::NotificationModule {
+private:
+	std::string directory;    //!< Directory of the event log.
+	size_t segmentSize;       //!< Size of a segment file.
+	size_t maxSegments;       //!< Number of segments kept.
+	size_t indexInterval;     //!< Bytes between two index entries.
+
+	std::vector<std::string> moduleNames;  //!< Module table. The index is the module ID.
+	int moduleFile;           //!< File descriptor of the module table.
+
+	std::deque<uint32_t> segments;  //!< Sequence numbers of all segments on disk. Oldest first.
+	int segmentFile;          //!< File descriptor of the current segment.
+	int indexFile;            //!< File descriptor of the current index.
+	char *segment;            //!< Mapping of the current segment.
+	EventLogSegmentHeader *header;  //!< Header of the current segment.
+	uint64_t nextIndexOffset; //!< Offset at which the next index entry is written.
+	uint64_t maxTime;         //!< Largest timestamp in the current segment.
+
+	/**
+	 * Read the module table and find existing segments.
+	 */
+	void openLog();
+	/**
+	 * Create and map the next segment. Deletes the oldest segments beyond maxSegments.
+	 *
+	 * @return True, if the segment could be created.
+	 */
+	bool openSegment();
+	/**
+	 * Shrink the current segment to its used size and release it.
+	 */
+	void closeSegment();
+	/**
+	 * Lookup or assign the ID of a module.
+	 *
+	 * @param module Name of the module.
+	 * @param moduleLength Length of the name.
+	 * @return ID of the module.
+	 */
+	uint16_t getModuleId(const char *module, size_t moduleLength);
+
+public:
+	/**
+	 * Constructor
+	 */
+	EventLogNotificationModule();
+	/**
+	 * Destructor
+	 */
+	virtual ~EventLogNotificationModule();
+
+	virtual void doNotify(const vmi::NotificationRecord &record);
+};
+
+#endif /* EVENTLOGNOTIFICATIONMODULE_H_ */
@@ -0,0 +1,66 @@
+/*
+ * EventStreamFormat.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef EVENTSTREAMFORMAT_H_
+#define EVENTSTREAMFORMAT_H_
+
+#include <stdint.h>
+
+/**
+ * @file EventStreamFormat.h
+ * @brief Wire format of the event stream published by the EventStreamNotificationModule.
+ *
+ * A client connects to the UNIX stream socket of the module and sends an
+ * EventStreamSubscription, followed by moduleLength bytes of module filter. The filter is a
+ * comma separated list of module names. An empty filter subscribes to all modules.
+ *
+ * Afterwards the module pushes frames. Each frame is an EventStreamFrameHeader followed by
+ * moduleLength bytes of module name and messageLength bytes of message text.
+ * Frames of type EVENTSTREAM_DROPPED carry no payload. They report in messageLength the
+ * number of events dropped, because the client did not read fast enough.
+ *
+ * All values are stored in host byte order, as the socket is local.
+ */
+
+#define EVENTSTREAM_MAGIC          "VMES"  //!< Magic of a subscription.
+#define EVENTSTREAM_VERSION        1       //!< Version of the format.
+#define EVENTSTREAM_DEFAULT_SOCKET "/run/vmiids/events.sock"  //!< Default path of the socket.
+#define EVENTSTREAM_MAX_FILTER     4096    //!< Maximum length of the module filter.
+
+/**
+ * Subscription sent by the client after connecting.
+ */
+typedef struct {
+	char magic[4];          //!< EVENTSTREAM_MAGIC
+	uint16_t version;       //!< EVENTSTREAM_VERSION
+	uint8_t minSeverity;    //!< Lowest severity (vmi::DEBUG_LEVEL) sent to the client.
+	uint8_t reserved;       //!< Reserved. Zero.
+	uint32_t moduleLength;  //!< Length of the module filter following the subscription.
+} EventStreamSubscription;
+
+/**
+ * Type of a frame.
+ */
+typedef enum {
+	EVENTSTREAM_EVENT = 1,    //!< Notification.
+	EVENTSTREAM_DROPPED = 2,  //!< Events were dropped.
+} EventStreamFrameType;
+
+/**
+ * Header of each frame.
+ */
+typedef struct {
+	uint32_t length;         //!< Length of the frame including header and payload.
+	uint8_t type;            //!< Type of the frame (EventStreamFrameType).
+	uint8_t severity;        //!< Severity (vmi::DEBUG_LEVEL).
+	uint16_t moduleLength;   //!< Length of the module name.
+	uint32_t runId;          //!< Run ID of the notification. Zero, if it did not belong to a run.
+	uint32_t messageLength;  //!< Length of the message. Number of dropped events for EVENTSTREAM_DROPPED.
+	uint64_t time;           //!< Timestamp (us since epoch).
+} EventStreamFrameHeader;
+
+#endif /* EVENTSTREAMFORMAT_H_ */
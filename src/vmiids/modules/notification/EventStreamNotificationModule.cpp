@@ -0,0 +1,392 @@
+/*
+ * EventStreamNotificationModule.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#include "EventStreamNotificationModule.h"
+#include "vmiids/VmiIDS.h"
+#include "vmiids/util/MutexLocker.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+
+#define EVENTSTREAM_DEFAULT_SUBSCRIBERS 16
+#define EVENTSTREAM_DEFAULT_BUFFERSIZE  (256 * 1024)
+#define EVENTSTREAM_DEFAULT_EVENTSIZE   4096
+#define EVENTSTREAM_POLL_TIMEOUT        1000   //!< Time (ms) after which the server thread checks, if it should stop.
+
+LOADMODULE(EventStreamNotificationModule);
+
+/**
+ * Thread running EventStreamNotificationModule::serve().
+ */
+class EventStreamNotificationModule::Server: public vmi::Thread {
+private:
+	EventStreamNotificationModule *module;
+
+public:
+	Server(EventStreamNotificationModule *module) : module(module) {}
+	virtual void run(){
+		module->serve();
+	}
+};
+
+EventStreamNotificationModule::EventStreamNotificationModule() :
+		NotificationModule("EventStreamNotificationModule") {
+	unsigned int value;
+
+	try {
+		GETOPTION(socketPath, this->socketPath);
+	} catch (vmi::OptionNotFoundException &e) {
+		this->socketPath = EVENTSTREAM_DEFAULT_SOCKET;
+	}
+	try {
+		GETOPTION(maxSubscribers, value);
+		this->maxSubscribers = (value > 0) ? value : 1;
+	} catch (vmi::OptionNotFoundException &e) {
+		this->maxSubscribers = EVENTSTREAM_DEFAULT_SUBSCRIBERS;
+	}
+	try {
+		GETOPTION(maxEventSize, value);
+		this->maxEventSize = (value >= 256) ? value : 256;
+	} catch (vmi::OptionNotFoundException &e) {
+		this->maxEventSize = EVENTSTREAM_DEFAULT_EVENTSIZE;
+	}
+	try {
+		GETOPTION(bufferSize, value);
+		this->bufferSize = value;
+	} catch (vmi::OptionNotFoundException &e) {
+		this->bufferSize = EVENTSTREAM_DEFAULT_BUFFERSIZE;
+	}
+	// Each ring buffer must hold at least one maximum sized event and a drop report.
+	if (this->bufferSize < this->maxEventSize + sizeof(EventStreamFrameHeader)) {
+		this->bufferSize = this->maxEventSize + sizeof(EventStreamFrameHeader);
+	}
+
+	this->running = true;
+	this->pending = false;
+	this->server = NULL;
+
+	struct sockaddr_un address;
+	if (this->socketPath.size() >= sizeof(address.sun_path)) {
+		throw vmi::ModuleException("Socket path too long: " + this->socketPath);
+	}
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, this->socketPath.c_str());
+
+	// Subscribers receive all notifications. Create the directory private to the user, so nobody
+	// else can connect before the socket itself is restricted below. Existing directories are
+	// left untouched.
+	size_t separator = this->socketPath.rfind('/');
+	if (separator != std::string::npos && separator > 0 &&
+			mkdir(this->socketPath.substr(0, separator).c_str(), 0700) != 0 && errno != EEXIST) {
+		throw vmi::ModuleException("Could not create the directory of " + this->socketPath);
+	}
+
+	if (pipe2(this->wakeFds, O_NONBLOCK | O_CLOEXEC) != 0) {
+		throw vmi::ModuleException("Could not create pipe");
+	}
+	this->listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (this->listenFd >= 0) {
+		// Remove the socket of a previous instance.
+		unlink(this->socketPath.c_str());
+		if (bind(this->listenFd, (struct sockaddr *) &address, sizeof(address)) != 0 ||
+				chmod(this->socketPath.c_str(), 0600) != 0 ||
+				listen(this->listenFd, this->maxSubscribers) != 0) {
+			::close(this->listenFd);
+			this->listenFd = -1;
+		}
+	}
+	if (this->listenFd < 0) {
+		::close(this->wakeFds[0]);
+		::close(this->wakeFds[1]);
+		throw vmi::ModuleException("Could not listen on " + this->socketPath);
+	}
+
+	this->server = new Server(this);
+	this->server->start();
+}
+
+EventStreamNotificationModule::~EventStreamNotificationModule() {
+	this->detach();
+	this->running = false;
+	this->pending = true;
+	this->flush();
+	this->server->join();
+	delete this->server;
+
+	while (!this->subscribers.empty()) {
+		this->closeSubscriber(this->subscribers.front());
+	}
+	::close(this->listenFd);
+	::close(this->wakeFds[0]);
+	::close(this->wakeFds[1]);
+	unlink(this->socketPath.c_str());
+}
+
+void EventStreamNotificationModule::writeRing(Subscriber *subscriber, const void *data, size_t length){
+	size_t size = subscriber->ring.size();
+	size_t tail = (subscriber->head + subscriber->count) % size;
+	size_t first = std::min(length, size - tail);
+	memcpy(&subscriber->ring[tail], data, first);
+	memcpy(&subscriber->ring[0], (const char *) data + first, length - first);
+	subscriber->count += length;
+}
+
+bool EventStreamNotificationModule::append(Subscriber *subscriber, const EventStreamFrameHeader &header,
+		const char *module, const char *message){
+	size_t space = subscriber->ring.size() - subscriber->count;
+	size_t needed = header.length;
+	if (subscriber->dropped > 0) {
+		needed += sizeof(EventStreamFrameHeader);
+	}
+	if (needed > space) {
+		subscriber->dropped++;
+		return false;
+	}
+
+	if (subscriber->dropped > 0) {
+		EventStreamFrameHeader dropped;
+		memset(&dropped, 0, sizeof(dropped));
+		dropped.length = sizeof(dropped);
+		dropped.type = EVENTSTREAM_DROPPED;
+		dropped.severity = vmi::OUTPUT_WARN;
+		dropped.messageLength = subscriber->dropped;
+		dropped.time = header.time;
+		writeRing(subscriber, &dropped, sizeof(dropped));
+		subscriber->dropped = 0;
+	}
+	writeRing(subscriber, &header, sizeof(header));
+	writeRing(subscriber, module, header.moduleLength);
+	writeRing(subscriber, message, header.messageLength);
+	return true;
+}
+
+bool EventStreamNotificationModule::matches(const Subscriber *subscriber, const vmi::NotificationRecord &record){
+	if (!subscriber->active || (unsigned int) record.severity < subscriber->minSeverity) {
+		return false;
+	}
+	if (subscriber->modules.empty()) {
+		return true;
+	}
+	for (std::vector<std::string>::const_iterator it = subscriber->modules.begin();
+			it != subscriber->modules.end(); ++it) {
+		if (it->size() == record.moduleLength && memcmp(it->data(), record.getModule(), record.moduleLength) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void EventStreamNotificationModule::doNotify(const vmi::NotificationRecord &record){
+	if (record.severity < debugLevel) {
+		return;
+	}
+
+	size_t messageLength = record.messageLength;
+	const char *message = record.getMessage();
+	while (messageLength > 0 && (message[messageLength - 1] == '\n' || message[messageLength - 1] == '\r')) {
+		messageLength--;
+	}
+	size_t moduleLength = std::min<size_t>(record.moduleLength, this->maxEventSize / 2);
+	if (sizeof(EventStreamFrameHeader) + moduleLength + messageLength > this->maxEventSize) {
+		messageLength = this->maxEventSize - sizeof(EventStreamFrameHeader) - moduleLength;
+	}
+
+	EventStreamFrameHeader header;
+	header.length = sizeof(header) + moduleLength + messageLength;
+	header.type = EVENTSTREAM_EVENT;
+	header.severity = record.severity;
+	header.moduleLength = moduleLength;
+	header.runId = record.runId;
+	header.messageLength = messageLength;
+	header.time = (uint64_t) record.time.tv_sec * 1000000 + record.time.tv_usec;
+
+	vmi::MutexLocker lock(&mutex);
+	for (std::list<Subscriber *>::iterator it = this->subscribers.begin(); it != this->subscribers.end(); ++it) {
+		if (matches(*it, record) && this->append(*it, header, record.getModule(), message)) {
+			this->pending = true;
+		}
+	}
+}
+
+void EventStreamNotificationModule::flush(){
+	if (!this->pending) {
+		return;
+	}
+	this->pending = false;
+	char wake = 0;
+	if (write(this->wakeFds[1], &wake, 1) < 0) {
+		// The pipe is full, the server thread wakes up anyway.
+	}
+}
+
+void EventStreamNotificationModule::serve(){
+	std::vector<struct pollfd> fds;
+	std::vector<Subscriber *> polled;
+
+	while (this->running) {
+		// Subscribers are only removed by this thread, so the pointers stay valid after unlocking.
+		fds.resize(2);
+		fds[0].fd = this->listenFd;
+		fds[0].events = POLLIN;
+		fds[1].fd = this->wakeFds[0];
+		fds[1].events = POLLIN;
+		polled.clear();
+		this->mutex.lock();
+		for (std::list<Subscriber *>::iterator it = this->subscribers.begin(); it != this->subscribers.end(); ++it) {
+			struct pollfd fd;
+			fd.fd = (*it)->fd;
+			fd.events = ((*it)->count > 0) ? POLLIN | POLLOUT : POLLIN;
+			fd.revents = 0;
+			fds.push_back(fd);
+			polled.push_back(*it);
+		}
+		this->mutex.unlock();
+		fds[0].revents = 0;
+		fds[1].revents = 0;
+
+		if (poll(&fds[0], fds.size(), EVENTSTREAM_POLL_TIMEOUT) <= 0) {
+			continue;
+		}
+
+		if (fds[1].revents & POLLIN) {
+			char buffer[64];
+			while (read(this->wakeFds[0], buffer, sizeof(buffer)) > 0);
+		}
+		for (size_t i = 0; i < polled.size(); i++) {
+			short revents = fds[i + 2].revents;
+			if ((revents & (POLLERR | POLLHUP | POLLNVAL)) ||
+					((revents & POLLIN) && !this->receiveSubscription(polled[i])) ||
+					((revents & POLLOUT) && !this->sendFrames(polled[i]))) {
+				this->closeSubscriber(polled[i]);
+			}
+		}
+		if (fds[0].revents & POLLIN) {
+			this->acceptSubscriber();
+		}
+	}
+}
+
+void EventStreamNotificationModule::acceptSubscriber(){
+	int fd;
+	while ((fd = accept4(this->listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+		Subscriber *subscriber = new Subscriber();
+		subscriber->fd = fd;
+		subscriber->active = false;
+		subscriber->minSeverity = vmi::OUTPUT_DEBUG;
+		subscriber->ring.resize(this->bufferSize);
+		subscriber->head = 0;
+		subscriber->count = 0;
+		subscriber->dropped = 0;
+
+		vmi::MutexLocker lock(&mutex);
+		if (this->subscribers.size() >= this->maxSubscribers) {
+			::close(fd);
+			delete subscriber;
+			continue;
+		}
+		this->subscribers.push_back(subscriber);
+	}
+}
+
+bool EventStreamNotificationModule::receiveSubscription(Subscriber *subscriber){
+	char buffer[256];
+	if (subscriber->active) {
+		// Nothing is expected after the subscription. Only detect a closed connection.
+		ssize_t received = recv(subscriber->fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+		return received > 0 || (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR));
+	}
+
+	size_t needed = sizeof(EventStreamSubscription);
+	if (subscriber->request.size() >= needed) {
+		needed += ((const EventStreamSubscription *) &subscriber->request[0])->moduleLength;
+	}
+	ssize_t received = recv(subscriber->fd, buffer, std::min(needed - subscriber->request.size(), sizeof(buffer)),
+			MSG_DONTWAIT);
+	if (received <= 0) {
+		return received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+	}
+	subscriber->request.insert(subscriber->request.end(), buffer, buffer + received);
+	if (subscriber->request.size() < sizeof(EventStreamSubscription)) {
+		return true;
+	}
+
+	const EventStreamSubscription *subscription = (const EventStreamSubscription *) &subscriber->request[0];
+	if (memcmp(subscription->magic, EVENTSTREAM_MAGIC, sizeof(subscription->magic)) != 0 ||
+			subscription->version != EVENTSTREAM_VERSION ||
+			subscription->moduleLength > EVENTSTREAM_MAX_FILTER) {
+		return false;
+	}
+	if (subscriber->request.size() < sizeof(EventStreamSubscription) + subscription->moduleLength) {
+		return true;
+	}
+
+	std::vector<std::string> modules;
+	std::string filter(subscriber->request.begin() + sizeof(EventStreamSubscription), subscriber->request.end());
+	size_t start = 0;
+	while (start < filter.size()) {
+		size_t end = filter.find(',', start);
+		if (end == std::string::npos) end = filter.size();
+		if (end > start) modules.push_back(filter.substr(start, end - start));
+		start = end + 1;
+	}
+
+	vmi::MutexLocker lock(&mutex);
+	subscriber->minSeverity = subscription->minSeverity;
+	subscriber->modules.swap(modules);
+	subscriber->request.clear();
+	subscriber->active = true;
+	return true;
+}
+
+bool EventStreamNotificationModule::sendFrames(Subscriber *subscriber){
+	struct iovec vectors[2];
+	struct msghdr message;
+	memset(&message, 0, sizeof(message));
+	message.msg_iov = vectors;
+
+	// The dispatcher only writes behind the pending bytes, so they can be sent without the lock.
+	this->mutex.lock();
+	size_t size = subscriber->ring.size();
+	size_t first = std::min(subscriber->count, size - subscriber->head);
+	vectors[0].iov_base = &subscriber->ring[subscriber->head];
+	vectors[0].iov_len = first;
+	vectors[1].iov_base = &subscriber->ring[0];
+	vectors[1].iov_len = subscriber->count - first;
+	message.msg_iovlen = (vectors[1].iov_len > 0) ? 2 : 1;
+	this->mutex.unlock();
+
+	if (vectors[0].iov_len == 0) {
+		return true;
+	}
+	ssize_t sent = sendmsg(subscriber->fd, &message, MSG_DONTWAIT | MSG_NOSIGNAL);
+	if (sent < 0) {
+		return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+	}
+
+	vmi::MutexLocker lock(&mutex);
+	subscriber->head = (subscriber->head + sent) % size;
+	subscriber->count -= sent;
+	return true;
+}
+
+void EventStreamNotificationModule::closeSubscriber(Subscriber *subscriber){
+	this->mutex.lock();
+	this->subscribers.remove(subscriber);
+	this->mutex.unlock();
+	::close(subscriber->fd);
+	delete subscriber;
+}
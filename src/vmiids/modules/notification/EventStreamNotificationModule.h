@@ -0,0 +1,132 @@
+/*
+ * EventStreamNotificationModule.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef EVENTSTREAMNOTIFICATIONMODULE_H_
+#define EVENTSTREAMNOTIFICATIONMODULE_H_
+
+#include "vmiids/NotificationModule.h"
+#include "vmiids/util/Mutex.h"
+#include "vmiids/util/Thread.h"
+#include "EventStreamFormat.h"
+
+#include <list>
+#include <string>
+#include <vector>
+
+/**
+ * @class EventStreamNotificationModule EventStreamNotificationModule.h "vmiids/modules/notification/EventStreamNotificationModule.h"
+ * @brief Live event stream on a UNIX socket
+ * @sa vmi::NotificationModule
+ * @sa EventStreamFormat.h
+ *
+ * This module publishes the notifications of the framework on a UNIX stream socket.
+ * Clients (e.g. <code>VMImodule w</code>) connect, send a subscription with a minimum severity
+ * and a list of modules and receive the matching notifications as binary frames.
+ *
+ * Each subscriber has a bounded ring buffer. The dispatcher only copies the frame into the ring
+ * buffers of the matching subscribers and never blocks on a socket. A server thread sends the
+ * ring buffers to the subscribers directly from the ring, without copying. If a subscriber reads
+ * too slowly and its ring buffer is full, new events are dropped for this subscriber only. The
+ * subscriber is told how many events it missed by an EVENTSTREAM_DROPPED frame.
+ *
+ * Options (@ref vmi::Settings):
+ *  - socketPath: Path of the socket (optional, default EVENTSTREAM_DEFAULT_SOCKET). The socket is
+ *    only accessible by the user running the framework. A missing directory is created with mode 0700.
+ *  - maxSubscribers: Maximum number of subscribers (optional, default 16).
+ *  - bufferSize: Size of the ring buffer of each subscriber (optional, default 262144).
+ *  - maxEventSize: Maximum size of a frame. Longer messages are truncated (optional, default 4096).
+ */
+class EventStreamNotificationModule: public vmi::NotificationModule {
+private:
+	/**
+	 * Client connected to the socket.
+	 */
+	struct Subscriber {
+		int fd;                    //!< Connected socket.
+		bool active;               //!< True, once the subscription has been received.
+		unsigned int minSeverity;  //!< Lowest severity sent to the subscriber.
+		std::vector<std::string> modules;  //!< Modules sent to the subscriber. Empty for all.
+		std::vector<char> request; //!< Partially received subscription.
+		std::vector<char> ring;    //!< Ring buffer of pending frames.
+		size_t head;               //!< Offset of the first pending byte in the ring.
+		size_t count;              //!< Number of pending bytes.
+		size_t dropped;            //!< Number of events dropped since the last EVENTSTREAM_DROPPED frame.
+	};
+
+	class Server;
+
+	std::string socketPath;    //!< Path of the socket.
+	size_t maxSubscribers;     //!< Maximum number of subscribers.
+	size_t bufferSize;         //!< Size of the ring buffer of each subscriber.
+	size_t maxEventSize;       //!< Maximum size of a frame.
+
+	int listenFd;              //!< Listening socket. -1, if not listening.
+	int wakeFds[2];            //!< Pipe waking up the server thread.
+	volatile bool running;     //!< False, when the server thread should stop.
+	bool pending;              //!< True, if frames were queued since the last flush().
+
+	std::list<Subscriber *> subscribers;  //!< Connected clients. Protected by mutex.
+	vmi::Mutex mutex;          //!< Protects the subscribers and their ring buffers.
+	Server *server;            //!< Server thread.
+
+	/**
+	 * Copy data into the ring buffer of a subscriber. There must be enough space.
+	 */
+	static void writeRing(Subscriber *subscriber, const void *data, size_t length);
+	/**
+	 * Append a frame to the ring buffer of a subscriber. Must be called with the mutex held.
+	 * @return False, if the ring buffer is full. The frame is counted as dropped.
+	 */
+	bool append(Subscriber *subscriber, const EventStreamFrameHeader &header,
+			const char *module, const char *message);
+	/**
+	 * Check, if a subscriber wants to receive a notification.
+	 */
+	static bool matches(const Subscriber *subscriber, const vmi::NotificationRecord &record);
+
+	/**
+	 * Server thread. Accepts new subscribers and sends the ring buffers.
+	 */
+	void serve();
+	/**
+	 * Accept a new subscriber.
+	 */
+	void acceptSubscriber();
+	/**
+	 * Read the subscription of a subscriber.
+	 * @return False, if the subscriber has to be closed.
+	 */
+	bool receiveSubscription(Subscriber *subscriber);
+	/**
+	 * Send the pending frames of a subscriber without blocking.
+	 * @return False, if the subscriber has to be closed.
+	 */
+	bool sendFrames(Subscriber *subscriber);
+	/**
+	 * Remove and close a subscriber.
+	 */
+	void closeSubscriber(Subscriber *subscriber);
+
+public:
+	/**
+	 * Constructor. Creates the socket and starts the server thread.
+	 */
+	EventStreamNotificationModule();
+	/**
+	 * Destructor. Stops the server thread and closes all subscribers.
+	 */
+	virtual ~EventStreamNotificationModule();
+
+	virtual void doNotify(const vmi::NotificationRecord &record);
+
+	/**
+	 * Wake up the server thread, if frames were queued. Called after each batch of notifications.
+	 */
+	virtual void flush();
+};
+
+#endif /* EVENTSTREAMNOTIFICATIONMODULE_H_ */
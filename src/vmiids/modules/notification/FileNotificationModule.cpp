@@ -21,47 +21,16 @@ FileNotificationModule::FileNotificationModule() :
 }
 
 FileNotificationModule::~FileNotificationModule() {
+	this->detach();
 	outfile.close();
 }
 
-void FileNotificationModule::doDebug(std::string module, std::string message){
-	if(debugLevel <= vmi::OUTPUT_DEBUG){
-		outfile << "Debug:       " << module << ": " << message;
-		outfile.flush();
+void FileNotificationModule::doNotify(const vmi::NotificationRecord &record){
+	if(record.severity >= debugLevel){
+		outfile.write(record.getText(), record.textLength);
 	}
 }
 
-void FileNotificationModule::doInfo(std::string module, std::string message){
-	if(debugLevel <= vmi::OUTPUT_INFO){
-		outfile << "Information: " << module << ": " << message;
-		outfile.flush();
-	}
-}
-
-void FileNotificationModule::doWarn(std::string module, std::string message){
-	if(debugLevel <= vmi::OUTPUT_WARN){
-		outfile << "Warning:     " << module << ": " << message;
-		outfile.flush();
-	}
-}
-
-void FileNotificationModule::doError(std::string module, std::string message){
-	if(debugLevel <= vmi::OUTPUT_ERROR){
-		outfile << "Error:       " << module << ": " << message;
-		outfile.flush();
-	}
-}
-
-void FileNotificationModule::doCritical(std::string module, std::string message){
-	if(debugLevel <= vmi::OUTPUT_CRITICAL){
-		outfile << "Critical:    " << module << ": " << message;
-		outfile.flush();
-	}
-}
-
-void FileNotificationModule::doAlert(std::string module, std::string message){
-	if(debugLevel <= vmi::OUTPUT_ALERT){
-		outfile << "Alert:       " << module << ": " << message;
-		outfile.flush();
-	}
+void FileNotificationModule::flush(){
+	outfile.flush();
 }
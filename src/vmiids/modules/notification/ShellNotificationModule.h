@@ -29,12 +29,12 @@ public:
 	 */
 	virtual ~ShellNotificationModule();
 
-	virtual void doDebug(std::string module, std::string message);
-	virtual void doInfo(std::string module, std::string message);
-	virtual void doWarn(std::string module, std::string message);
-	virtual void doError(std::string module, std::string message);
-	virtual void doCritical(std::string module, std::string message);
-	virtual void doAlert(std::string module, std::string message);
+	virtual void doNotify(const vmi::NotificationRecord &record);
+
+	/**
+	 * Write all buffered output. Called after each batch of notifications.
+	 */
+	virtual void flush();
 
 };
 
@@ -0,0 +1,224 @@
+/*
+ * SyslogNotificationModule.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#include "SyslogNotificationModule.h"
+#include "vmiids/VmiIDS.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define SYSLOG_DEFAULT_SOCKET     "/dev/log"
+#define SYSLOG_DEFAULT_APPNAME    "vmiids"
+#define SYSLOG_DEFAULT_FACILITY   1
+#define SYSLOG_DEFAULT_BACKLOG    1024
+#define SYSLOG_DEFAULT_MESSAGESIZE 2048
+#define SYSLOG_BATCH              64     //!< Maximum number of messages passed to sendmmsg() at once.
+#define SYSLOG_MSGID_LENGTH       32     //!< Maximum length of the MSGID field (RFC 5424).
+#define SYSLOG_ENTERPRISE_ID      "32473"  //!< Enterprise number of the structured data.
+
+LOADMODULE(SyslogNotificationModule);
+
+/**
+ * Syslog severities of the DEBUG_LEVELs.
+ */
+static const unsigned int syslogSeverity[] = { 7, 6, 4, 3, 2, 1 };
+
+SyslogNotificationModule::SyslogNotificationModule() :
+		NotificationModule("SyslogNotificationModule") {
+	unsigned int value;
+
+	try {
+		GETOPTION(socketPath, this->socketPath);
+	} catch (vmi::OptionNotFoundException &e) {
+		this->socketPath = SYSLOG_DEFAULT_SOCKET;
+	}
+	try {
+		GETOPTION(appName, this->appName);
+	} catch (vmi::OptionNotFoundException &e) {
+		this->appName = SYSLOG_DEFAULT_APPNAME;
+	}
+	try {
+		GETOPTION(facility, value);
+		this->facility = (value < 24) ? value : SYSLOG_DEFAULT_FACILITY;
+	} catch (vmi::OptionNotFoundException &e) {
+		this->facility = SYSLOG_DEFAULT_FACILITY;
+	}
+	try {
+		GETOPTION(backlog, value);
+		this->backlogSize = (value > 0) ? value : 1;
+	} catch (vmi::OptionNotFoundException &e) {
+		this->backlogSize = SYSLOG_DEFAULT_BACKLOG;
+	}
+	try {
+		GETOPTION(maxMessageSize, value);
+		this->maxMessageSize = (value >= 256) ? value : 256;
+	} catch (vmi::OptionNotFoundException &e) {
+		this->maxMessageSize = SYSLOG_DEFAULT_MESSAGESIZE;
+	}
+
+	char host[256];
+	if (gethostname(host, sizeof(host)) == 0) {
+		host[sizeof(host) - 1] = '\0';
+		this->hostName = host;
+	} else {
+		this->hostName = "-";
+	}
+
+	this->slots.resize(this->backlogSize * this->maxMessageSize);
+	this->lengths.resize(this->backlogSize);
+	this->backlogStart = 0;
+	this->backlogCount = 0;
+	this->droppedMessages = 0;
+
+	this->socketFd = -1;
+	this->connectSocket();
+}
+
+SyslogNotificationModule::~SyslogNotificationModule() {
+	this->detach();
+	this->flush();
+	if (this->socketFd >= 0) close(this->socketFd);
+}
+
+bool SyslogNotificationModule::connectSocket(){
+	if (this->socketFd >= 0) {
+		return true;
+	}
+	struct sockaddr_un address;
+	if (this->socketPath.size() >= sizeof(address.sun_path)) {
+		return false;
+	}
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, this->socketPath.c_str());
+
+	this->socketFd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	if (this->socketFd < 0) {
+		return false;
+	}
+	if (connect(this->socketFd, (struct sockaddr *) &address, sizeof(address)) != 0) {
+		close(this->socketFd);
+		this->socketFd = -1;
+		return false;
+	}
+	return true;
+}
+
+void SyslogNotificationModule::format(vmi::DEBUG_LEVEL severity, const char *module, size_t moduleLength,
+		uint32_t runId, const struct timeval &time, const char *message, size_t messageLength){
+	if (this->backlogCount == this->backlogSize) {
+		// Receiver is too slow. Drop the oldest message.
+		this->backlogStart = (this->backlogStart + 1) % this->backlogSize;
+		this->backlogCount--;
+		this->droppedMessages++;
+	}
+	size_t slot = (this->backlogStart + this->backlogCount) % this->backlogSize;
+	char *buffer = &this->slots[slot * this->maxMessageSize];
+
+	struct tm utc;
+	char timestamp[32];
+	gmtime_r(&time.tv_sec, &utc);
+	strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", &utc);
+
+	// MSGID must consist of printable characters without spaces.
+	char msgId[SYSLOG_MSGID_LENGTH + 1];
+	size_t msgIdLength = 0;
+	for (size_t i = 0; i < moduleLength && msgIdLength < SYSLOG_MSGID_LENGTH; i++) {
+		if (module[i] > ' ' && module[i] < 127) msgId[msgIdLength++] = module[i];
+	}
+	if (msgIdLength == 0) msgId[msgIdLength++] = '-';
+	msgId[msgIdLength] = '\0';
+
+	char structuredData[48];
+	if (runId != 0) {
+		snprintf(structuredData, sizeof(structuredData), "[vmiids@" SYSLOG_ENTERPRISE_ID " run=\"%u\"]", runId);
+	} else {
+		strcpy(structuredData, "-");
+	}
+
+	int headerLength = snprintf(buffer, this->maxMessageSize, "<%u>1 %s.%06uZ %s %s %u %s %s ",
+			this->facility * 8 + syslogSeverity[severity], timestamp, (unsigned int) time.tv_usec,
+			this->hostName.c_str(), this->appName.c_str(), (unsigned int) getpid(), msgId, structuredData);
+	if (headerLength < 0 || (size_t) headerLength >= this->maxMessageSize) {
+		headerLength = this->maxMessageSize - 1;
+	}
+
+	while (messageLength > 0 && (message[messageLength - 1] == '\n' || message[messageLength - 1] == '\r')) {
+		messageLength--;
+	}
+	if (messageLength > this->maxMessageSize - headerLength) {
+		messageLength = this->maxMessageSize - headerLength;
+	}
+	memcpy(buffer + headerLength, message, messageLength);
+
+	this->lengths[slot] = headerLength + messageLength;
+	this->backlogCount++;
+}
+
+void SyslogNotificationModule::doNotify(const vmi::NotificationRecord &record){
+	if (record.severity < debugLevel) {
+		return;
+	}
+	this->format(record.severity, record.getModule(), record.moduleLength, record.runId,
+			record.time, record.getMessage(), record.messageLength);
+}
+
+void SyslogNotificationModule::reportDrops(){
+	// The report needs a free slot. Formatting it into a full backlog would drop another message.
+	if (this->droppedMessages == 0 || this->backlogCount == this->backlogSize) {
+		return;
+	}
+	char message[96];
+	int length = snprintf(message, sizeof(message), "%lu messages dropped, syslog receiver too slow",
+			(unsigned long) this->droppedMessages);
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	this->droppedMessages = 0;
+	this->format(vmi::OUTPUT_WARN, this->getName().data(), this->getName().size(), 0, now, message, length);
+}
+
+void SyslogNotificationModule::flush(){
+	this->reportDrops();
+	if (this->backlogCount == 0 || !this->connectSocket()) {
+		return;
+	}
+
+	struct mmsghdr messages[SYSLOG_BATCH];
+	struct iovec vectors[SYSLOG_BATCH];
+	while (this->backlogCount > 0) {
+		unsigned int count = 0;
+		while (count < SYSLOG_BATCH && count < this->backlogCount) {
+			size_t slot = (this->backlogStart + count) % this->backlogSize;
+			vectors[count].iov_base = &this->slots[slot * this->maxMessageSize];
+			vectors[count].iov_len = this->lengths[slot];
+			memset(&messages[count], 0, sizeof(messages[count]));
+			messages[count].msg_hdr.msg_iov = &vectors[count];
+			messages[count].msg_hdr.msg_iovlen = 1;
+			count++;
+		}
+
+		int sent = sendmmsg(this->socketFd, messages, count, MSG_DONTWAIT);
+		if (sent <= 0) {
+			if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+				// Receiver is gone (e.g. restarted). Reconnect on the next flush.
+				close(this->socketFd);
+				this->socketFd = -1;
+			}
+			// Keep the backlog for the next flush.
+			return;
+		}
+		this->backlogStart = (this->backlogStart + sent) % this->backlogSize;
+		this->backlogCount -= sent;
+		this->reportDrops();
+	}
+}
@@ -0,0 +1,99 @@
+/*
+ * SyslogNotificationModule.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef SYSLOGNOTIFICATIONMODULE_H_
+#define SYSLOGNOTIFICATIONMODULE_H_
+
+#include "vmiids/NotificationModule.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @class SyslogNotificationModule SyslogNotificationModule.h "vmiids/modules/notification/SyslogNotificationModule.h"
+ * @brief Output to syslog
+ * @sa vmi::NotificationModule
+ *
+ * This module forwards the frameworks output as RFC 5424 messages to a UNIX datagram socket,
+ * e.g. /dev/log of syslog or journald. The module name is used as MSGID, the run ID is passed
+ * as structured data. For testing, any datagram listener can be used, e.g.
+ * <code>socat UNIX-RECVFROM:/tmp/vmiids.sock,fork -</code>.
+ *
+ * Messages are formatted into a bounded backlog. The backlog is sent with sendmmsg() whenever
+ * the dispatcher flushes the module, without blocking. If the receiver is slow or not available,
+ * messages stay in the backlog and are sent on the next flush. The dispatcher flushes the modules
+ * at least once per second, even if no new notifications arrive. If the backlog is full, the oldest
+ * messages are dropped and counted. The number of dropped messages is reported, as soon as a slot
+ * is free.
+ *
+ * Options (@ref vmi::Settings):
+ *  - socketPath: Path of the datagram socket (optional, default "/dev/log").
+ *  - appName: APP-NAME of the messages (optional, default "vmiids").
+ *  - facility: Syslog facility (optional, default 1 = user).
+ *  - backlog: Number of messages kept if the receiver is slow (optional, default 1024).
+ *  - maxMessageSize: Maximum size of a message. Longer messages are truncated (optional, default 2048).
+ */
+class SyslogNotificationModule: public vmi::NotificationModule {
+private:
+	std::string socketPath;   //!< Path of the datagram socket.
+	std::string appName;      //!< APP-NAME of the messages.
+	std::string hostName;     //!< HOSTNAME of the messages.
+	unsigned int facility;    //!< Syslog facility.
+	size_t maxMessageSize;    //!< Maximum size of a message.
+
+	int socketFd;             //!< Connected datagram socket. -1, if not connected.
+
+	std::vector<char> slots;       //!< Backlog. backlogSize slots of maxMessageSize bytes each.
+	std::vector<size_t> lengths;   //!< Length of the message in each slot.
+	size_t backlogSize;       //!< Number of slots.
+	size_t backlogStart;      //!< Slot of the oldest message.
+	size_t backlogCount;      //!< Number of messages in the backlog.
+	size_t droppedMessages;   //!< Number of messages dropped since the last report.
+
+	/**
+	 * Connect the socket, if it is not connected.
+	 * @return True, if the socket is connected.
+	 */
+	bool connectSocket();
+	/**
+	 * Format a message into the next free slot of the backlog.
+	 *
+	 * @param severity Severity of the message.
+	 * @param module Name of the module. Used as MSGID.
+	 * @param moduleLength Length of the module name.
+	 * @param runId Run ID of the message. Zero, if it did not belong to a run.
+	 * @param time Time of the message.
+	 * @param message Message text.
+	 * @param messageLength Length of the message text.
+	 */
+	void format(vmi::DEBUG_LEVEL severity, const char *module, size_t moduleLength, uint32_t runId,
+			const struct timeval &time, const char *message, size_t messageLength);
+	/**
+	 * Format a report of the dropped messages, if the backlog has a free slot.
+	 * Otherwise the messages stay counted and are reported later.
+	 */
+	void reportDrops();
+
+public:
+	/**
+	 * Constructor
+	 */
+	SyslogNotificationModule();
+	/**
+	 * Destructor. Tries to send the remaining backlog.
+	 */
+	virtual ~SyslogNotificationModule();
+
+	virtual void doNotify(const vmi::NotificationRecord &record);
+
+	/**
+	 * Send the backlog. Called after each batch of notifications and periodically by the dispatcher.
+	 */
+	virtual void flush();
+};
+
+#endif /* SYSLOGNOTIFICATIONMODULE_H_ */
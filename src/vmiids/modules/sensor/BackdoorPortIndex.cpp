@@ -0,0 +1,69 @@
+/*
+ * BackdoorPortIndex.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#include "BackdoorPortIndex.h"
+
+#include <cstring>
+
+/**
+ * Backdoor ports checked by rkhunter.
+ */
+static const struct {
+	NETWORK_PROTOCOL protocol;
+	uint16_t port;
+	const char * description;
+} backdoorPortTable[] = {
+	{ NETWORK_TCP, 1524,  "Possible FreeBSD (FBRK) Rootkit backdoor" },
+	{ NETWORK_TCP, 1984,  "Fuckit Rootkit" },
+	{ NETWORK_UDP, 2001,  "Scalper" },
+	{ NETWORK_TCP, 2006,  "CB Rootkit or w00tkit Rootkit SSH server" },
+	{ NETWORK_TCP, 2128,  "MRK" },
+	{ NETWORK_TCP, 6666,  "Possible rogue IRC bot" },
+	{ NETWORK_TCP, 6667,  "Possible rogue IRC bot" },
+	{ NETWORK_TCP, 6668,  "Possible rogue IRC bot" },
+	{ NETWORK_TCP, 6669,  "Possible rogue IRC bot" },
+	{ NETWORK_TCP, 7000,  "Possible rogue IRC bot" },
+	{ NETWORK_TCP, 13000, "Possible Universal Rootkit (URK) SSH server" },
+	{ NETWORK_TCP, 14856, "Optic Kit (Tux)" },
+	{ NETWORK_TCP, 25000, "Possible Universal Rootkit (URK) component" },
+	{ NETWORK_TCP, 29812, "FreeBSD Rootkit (FBRK) telnet port" },
+	{ NETWORK_TCP, 31337, "Historical backdoor port" },
+	{ NETWORK_TCP, 33369, "Possible trojaned sshd" },
+	{ NETWORK_TCP, 47107, "T0rn" },
+	{ NETWORK_TCP, 47018, "Possible Universal Rootkit (URK) component" },
+	{ NETWORK_TCP, 60922, "zaRwT.KiT" },
+	{ NETWORK_TCP, 62883, "Possible Universal Rootkit (URK) component" },
+	{ NETWORK_TCP, 65535, "FreeBSD Rootkit (FBRK) telnet port" }
+};
+
+BackdoorPortIndex::BackdoorPortIndex() {
+	memset(this->bitmap, 0, sizeof(this->bitmap));
+	for (size_t i = 0; i < sizeof(backdoorPortTable) / sizeof(backdoorPortTable[0]); i++) {
+		this->add(backdoorPortTable[i].protocol, backdoorPortTable[i].port, backdoorPortTable[i].description);
+	}
+}
+
+BackdoorPortIndex::~BackdoorPortIndex() {
+}
+
+void BackdoorPortIndex::add(NETWORK_PROTOCOL protocol, uint16_t port, const std::string &description) {
+	this->bitmap[protocol][port >> 5] |= (1U << (port & 31));
+	this->descriptions[((uint32_t) protocol << 16) | port] = description;
+}
+
+std::string BackdoorPortIndex::getDescription(NETWORK_PROTOCOL protocol, uint16_t port) const {
+	std::map<uint32_t, std::string>::const_iterator it =
+			this->descriptions.find(((uint32_t) protocol << 16) | port);
+	if (it == this->descriptions.end()) {
+		return std::string();
+	}
+	return it->second;
+}
+
+size_t BackdoorPortIndex::size() const {
+	return this->descriptions.size();
+}
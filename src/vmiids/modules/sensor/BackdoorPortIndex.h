@@ -0,0 +1,78 @@
+/*
+ * BackdoorPortIndex.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef BACKDOORPORTINDEX_H_
+#define BACKDOORPORTINDEX_H_
+
+#include "vmiids/modules/sensor/NetworkSensorModule.h"
+
+#include <string>
+#include <map>
+#include <stdint.h>
+
+/**
+ * @class BackdoorPortIndex BackdoorPortIndex.h "vmiids/modules/sensor/BackdoorPortIndex.h"
+ * @brief Bitmap of ports known to be used by backdoors.
+ * @sa BackdoorPortDetectionModule
+ * @sa RkHunterDetectionModule
+ *
+ * Every protocol has a bitmap with one bit per port. Checking a socket thus costs a single
+ * bit test, independent of the number of known backdoor ports. The description of a port is
+ * only looked up if the bit is set.
+ *
+ * The index is initialized with the backdoor ports checked by rkhunter. It is part of the
+ * library of the NetworkSensorModule, which all its users depend on anyway.
+ */
+class BackdoorPortIndex {
+public:
+	/**
+	 * Constructor. Adds the ports checked by rkhunter.
+	 */
+	BackdoorPortIndex();
+	/**
+	 * Destructor
+	 */
+	virtual ~BackdoorPortIndex();
+
+	/**
+	 * Add a backdoor port to the index.
+	 *
+	 * @param protocol Protocol of the port.
+	 * @param port Port number.
+	 * @param description Name of the backdoor using the port.
+	 */
+	void add(NETWORK_PROTOCOL protocol, uint16_t port, const std::string &description);
+
+	/**
+	 * Check if a port is a known backdoor port.
+	 *
+	 * @param protocol Protocol of the port.
+	 * @param port Port number.
+	 * @return True, if the port is used by a known backdoor.
+	 */
+	bool contains(NETWORK_PROTOCOL protocol, uint16_t port) const {
+		return (this->bitmap[protocol][port >> 5] & (1U << (port & 31))) != 0;
+	}
+
+	/**
+	 * @param protocol Protocol of the port.
+	 * @param port Port number.
+	 * @return Name of the backdoor using the port. Empty, if the port is not known.
+	 */
+	std::string getDescription(NETWORK_PROTOCOL protocol, uint16_t port) const;
+
+	/**
+	 * @return Number of ports in the index.
+	 */
+	size_t size() const;
+
+private:
+	uint32_t bitmap[2][65536 / 32];  //!< One bit per port for TCP and UDP.
+	std::map<uint32_t, std::string> descriptions;  //!< Descriptions keyed by protocol << 16 | port.
+};
+
+#endif /* BACKDOORPORTINDEX_H_ */
@@ -11,6 +11,7 @@
 #include <gcrypt.h>
 
 #include <dirent.h>
+#include <errno.h>
 #include <iostream>
 
 LOADMODULE(FileSystemSensorModule);
@@ -40,6 +41,39 @@ bool FileSystemSensorModule::fileExists(const std::string absolutePath,
 	return false;
 }
 
+void FileSystemSensorModule::filesExist(const std::set<std::string> &absolutePaths,
+		std::map<std::string, struct stat> &existingFiles) {
+
+	this->clearFSCache();
+
+	std::set<std::string> missingDirectories;
+	struct stat fileInfo;
+
+	for (std::set<std::string>::const_iterator it = absolutePaths.begin();
+			it != absolutePaths.end(); ++it) {
+		// Skip the path, if one of its parent directories is already known to be missing.
+		bool parentMissing = false;
+		size_t separator = it->rfind('/');
+		while (separator != std::string::npos && separator > 0) {
+			if (missingDirectories.find(it->substr(0, separator)) != missingDirectories.end()) {
+				parentMissing = true;
+				break;
+			}
+			separator = it->rfind('/', separator - 1);
+		}
+		if (parentMissing) {
+			continue;
+		}
+
+		if (stat(std::string().append(this->fileSystemPath).append(*it).c_str(), &fileInfo) == 0) {
+			existingFiles.insert(std::pair<std::string, struct stat>(*it, fileInfo));
+		} else if (errno == ENOENT || errno == ENOTDIR) {
+			missingDirectories.insert(*it);
+		}
+	}
+	return;
+}
+
 void FileSystemSensorModule::openFileRO(const std::string absolutePath,
 		std::ifstream *fileHandle) {
 	this->clearFSCache();
@@ -49,6 +83,36 @@ void FileSystemSensorModule::openFileRO(const std::string absolutePath,
 	return;
 }
 
+bool FileSystemSensorModule::mapFileRO(const std::string absolutePath,
+		vmi::MappedFile &mappedFile) {
+	this->clearFSCache();
+
+	return mappedFile.open(std::string().append(this->fileSystemPath).append(absolutePath));
+}
+
+void FileSystemSensorModule::scanFiles(const std::set<std::string> &absolutePaths,
+		vmi::MultiPatternMatcher &matcher,
+		std::map<std::string, std::vector<vmi::MultiPatternMatcher::Match> > &matches) {
+
+	this->clearFSCache();
+
+	vmi::MappedFile mappedFile;
+	std::vector<vmi::MultiPatternMatcher::Match> fileMatches;
+
+	for (std::set<std::string>::const_iterator it = absolutePaths.begin();
+			it != absolutePaths.end(); ++it) {
+		if (!mappedFile.open(std::string().append(this->fileSystemPath).append(*it))) {
+			continue;
+		}
+		fileMatches.clear();
+		if (matcher.scan(mappedFile.getData(), mappedFile.getSize(), fileMatches) > 0) {
+			matches[*it] = fileMatches;
+		}
+	}
+	mappedFile.close();
+	return;
+}
+
 void FileSystemSensorModule::getFileList(const std::string &directory, std::set<std::string> &directories, bool withdirs){
 	DIR *d;
 	struct dirent *dir;
@@ -9,6 +9,8 @@
 #define FILESYSTEMSENSORMODULE_H_
 
 #include "vmiids/SensorModule.h"
+#include "vmiids/util/MappedFile.h"
+#include "vmiids/util/MultiPatternMatcher.h"
 
 #include <string>
 #include <fstream>
@@ -16,6 +18,7 @@
 #include <sys/stat.h>
 
 #include <set>
+#include <map>
 
 /*!
  * FileSystemSensorException FileSystemSensorModule.h "vmiids/modules/sensor/FileSystemSensorModule.h"
@@ -60,6 +63,17 @@ public:
 	 * @return True, if the requested file exists. Otherwise false.
 	 */
 	bool fileExists(const std::string absolutePath, struct stat * stFileInfo = NULL);
+	/**
+	 * Check a set of files for existence within the monitored machines filesystem.
+	 *
+	 * In contrast to fileExists() the file system cache is only cleared once for the whole set.
+	 * The paths are visited in sorted order. Once a directory is known to be missing, all paths
+	 * below it are skipped without calling stat.
+	 *
+	 * @param absolutePaths Absolute paths of the files to check.
+	 * @param existingFiles Map to store the stat information of every file found in.
+	 */
+	void filesExist(const std::set<std::string> &absolutePaths, std::map<std::string, struct stat> &existingFiles);
 	/**
 	 * Open a file on the monitored machines filesystem.
 	 *
@@ -67,6 +81,27 @@ public:
 	 * @param fileHandle File handle to open the file into.
 	 */
 	void openFileRO(const std::string absolutePath, std::ifstream *fileHandle);
+	/**
+	 * Map a file of the monitored machines filesystem read only into memory.
+	 *
+	 * @param absolutePath Absolute path of the file to map.
+	 * @param mappedFile MappedFile object to map the file into.
+	 * @return True, if the file could be mapped.
+	 */
+	bool mapFileRO(const std::string absolutePath, vmi::MappedFile &mappedFile);
+	/**
+	 * Scan a set of files for the patterns of matcher.
+	 *
+	 * The file system cache is only cleared once for the whole set. Every file is mapped into
+	 * memory and scanned in a single pass, regardless of the number of patterns.
+	 * Files that can not be opened are skipped.
+	 *
+	 * @param absolutePaths Absolute paths of the files to scan.
+	 * @param matcher Matcher containing the patterns to search for.
+	 * @param matches Map to store the matches of every file containing at least one pattern in.
+	 */
+	void scanFiles(const std::set<std::string> &absolutePaths, vmi::MultiPatternMatcher &matcher,
+			std::map<std::string, std::vector<vmi::MultiPatternMatcher::Match> > &matches);
 	/**
 	 * Read the contents of the given directory into the set directories.
 	 * If the flag withdirs is true, contents of subdirectories are included.
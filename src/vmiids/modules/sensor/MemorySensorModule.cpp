@@ -124,6 +124,38 @@ void MemorySensorModule::getProcessList(std::map<uint32_t, MemtoolProcess> &memt
 	return;
 }
 
+void MemorySensorModule::getSocketList(std::vector<MemtoolSocket> &memtoolSockets){
+	vmi::MutexLocker lock(&mutex);
+	std::string scriptResult;
+
+	this->clearFSCache();
+
+	std::stringstream runSocketlistScript;
+	runSocketlistScript << "sc " << this->memtoolScriptPath << "/socketlist.js";
+	debug << "Trying to read socket list..." << std::endl;
+
+	if (memtool->isDaemonRunning() &&
+			memtool->eval(runSocketlistScript.str().c_str()) == 0) {
+		scriptResult = std::string(memtool->readAllStdOut().toStdString());
+	}else{
+		throw MemtoolNotRunningException();
+	}
+
+	std::istringstream lines(scriptResult);
+	std::string currentLine;
+	while (std::getline(lines, currentLine)) {
+		std::istringstream fields(currentLine);
+		MemtoolSocket socket;
+		unsigned int port;
+		if (!(fields >> socket.protocol >> port >> socket.inode) ||
+				(socket.protocol.compare(0, 3, "tcp") != 0 && socket.protocol.compare(0, 3, "udp") != 0)) {
+			continue;
+		}
+		socket.localPort = port;
+		memtoolSockets.push_back(socket);
+	}
+	return;
+}
 
 bool MemorySensorModule::clearFSCache() {
 	bool result = true;
@@ -15,6 +15,7 @@
 #include <memtool/memtool.h>
 
 #include <map>
+#include <vector>
 #include <QCoreApplication>
 
 #include <stdint.h>
@@ -38,6 +39,15 @@ typedef struct{
 	std::string processName;
 } MemtoolProcess;
 
+/**
+ * Representation of a socket in the memory sensor module.
+ */
+typedef struct{
+	std::string protocol;   //!< "tcp", "tcp6", "udp" or "udp6"
+	uint16_t localPort;
+	uint64_t inode;
+} MemtoolSocket;
+
 /*!
  * @class MemorySensorModule MemorySensorModule.h "vmiids/modules/sensor/MemorySensorModule.h"
  * @brief Sensor to create a view from the monitored machines physical memory state.
@@ -67,6 +77,18 @@ public:
 	 */
 	void getProcessList(std::map<uint32_t, MemtoolProcess> &memtoolProcessMap);
 
+	/**
+	 * Receive a list of sockets, currently open in the monitored machine.
+	 *
+	 * This function leverages the script "socketlist.js" shipped with vmiids and installed
+	 * into the memtool script directory. The script prints one socket per line: protocol,
+	 * local port and inode separated by spaces. All other lines are ignored.
+	 * Throws a MemtoolNotRunningException, if the script could not be run.
+	 *
+	 * @param memtoolSockets Vector able to store the result of the request.
+	 */
+	void getSocketList(std::vector<MemtoolSocket> &memtoolSockets);
+
 private:
 	vmi::Mutex mutex; //!< Mutex to handle multithreaded execution
 
@@ -0,0 +1,107 @@
+/*
+ * NetworkSensorModule.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#include "NetworkSensorModule.h"
+
+#include "vmiids/util/MutexLocker.h"
+
+#include <cstdio>
+
+/**
+ * Command transferring all socket tables and interface flags at once.
+ * Each section is introduced by a line starting with '@'.
+ */
+#define NETWORKSTATECOMMAND "for f in tcp tcp6 udp udp6; do echo \"@$f\"; cat /proc/net/$f 2>/dev/null; done; " \
+	"echo \"@if\"; for i in /sys/class/net/*; do echo \"${i##*/} $(cat $i/flags)\"; done"
+
+LOADMODULE_DEPENDS(NetworkSensorModule, "ShellSensorModule");
+
+NetworkSensorModule::NetworkSensorModule() : SensorModule("NetworkSensorModule") {
+	this->shell = NULL;
+}
+
+NetworkSensorModule::~NetworkSensorModule() {
+}
+
+void NetworkSensorModule::getNetworkState(std::vector<NetworkSocket> &sockets,
+		std::vector<NetworkInterface> &interfaces) {
+	vmi::MutexLocker lock(&mutex);
+
+	if (this->shell == NULL) {
+		GETSENSORMODULE(this->shell, ShellSensorModule);
+	}
+
+	std::string commandOutput;
+	this->shell->parseCommandOutput(NETWORKSTATECOMMAND, commandOutput);
+
+	enum { SECTION_NONE, SECTION_SOCKETS, SECTION_INTERFACES } section = SECTION_NONE;
+	NETWORK_PROTOCOL protocol = NETWORK_TCP;
+	bool ipv6 = false;
+
+	NetworkSocket socket;
+	NetworkInterface interface;
+	char name[64];
+
+	size_t lineStart = 0;
+	size_t lineEnd;
+	while (lineStart < commandOutput.size()) {
+		if ((lineEnd = commandOutput.find('\n', lineStart)) == std::string::npos) {
+			lineEnd = commandOutput.size();
+		}
+		std::string line = commandOutput.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+		if (!line.empty() && line[line.size() - 1] == '\r') {
+			line.erase(line.size() - 1);
+		}
+
+		if (line.compare(0, 4, "@tcp") == 0 || line.compare(0, 4, "@udp") == 0) {
+			section = SECTION_SOCKETS;
+			protocol = (line[1] == 't') ? NETWORK_TCP : NETWORK_UDP;
+			ipv6 = (line.compare(4, 1, "6") == 0);
+		} else if (line.compare("@if") == 0) {
+			section = SECTION_INTERFACES;
+		} else if (section == SECTION_SOCKETS) {
+			if (this->parseSocket(line, protocol, ipv6, socket)) {
+				sockets.push_back(socket);
+			}
+		} else if (section == SECTION_INTERFACES) {
+			if (sscanf(line.c_str(), "%63s %x", name, &interface.flags) == 2) {
+				interface.name = name;
+				interfaces.push_back(interface);
+			}
+		}
+	}
+	return;
+}
+
+bool NetworkSensorModule::parseSocket(const std::string &line,
+		NETWORK_PROTOCOL protocol, bool ipv6, NetworkSocket &socket) {
+	char localAddress[33];
+	char remoteAddress[33];
+	unsigned int localPort;
+	unsigned int remotePort;
+	unsigned int state;
+	unsigned int uid;
+	unsigned long long inode;
+
+	// sl local_address rem_address st tx_queue:rx_queue tr:tm->when retrnsmt uid timeout inode
+	if (sscanf(line.c_str(), " %*u: %32[0-9A-Fa-f]:%x %32[0-9A-Fa-f]:%x %x %*x:%*x %*x:%*x %*x %u %*d %llu",
+			localAddress, &localPort, remoteAddress, &remotePort, &state, &uid, &inode) != 7) {
+		// Header line or incomplete output.
+		return false;
+	}
+	socket.protocol = protocol;
+	socket.ipv6 = ipv6;
+	socket.localAddress = localAddress;
+	socket.localPort = localPort;
+	socket.remoteAddress = remoteAddress;
+	socket.remotePort = remotePort;
+	socket.state = state;
+	socket.uid = uid;
+	socket.inode = inode;
+	return true;
+}
@@ -0,0 +1,115 @@
+/*
+ * NetworkSensorModule.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef NETWORKSENSORMODULE_H_
+#define NETWORKSENSORMODULE_H_
+
+#include "vmiids/SensorModule.h"
+
+#include "vmiids/util/Mutex.h"
+
+#include "vmiids/modules/sensor/ShellSensorModule.h"
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * @enum NETWORK_PROTOCOL
+ *
+ * Transport protocol of a socket.
+ */
+typedef enum {
+	NETWORK_TCP = 0,  //!< TCP
+	NETWORK_UDP       //!< UDP
+} NETWORK_PROTOCOL;
+
+/**
+ * Socket states as used in /proc/net/tcp.
+ */
+#define NETWORK_TCP_LISTEN 0x0A
+
+/**
+ * Interface flags as used in /sys/class/net/<interface>/flags.
+ */
+#define NETWORK_IFF_UP      0x1
+#define NETWORK_IFF_PROMISC 0x100
+
+/**
+ * Representation of a socket in the network sensor module.
+ * Addresses are kept in the hexadecimal notation used by /proc/net.
+ */
+typedef struct{
+	NETWORK_PROTOCOL protocol;
+	bool ipv6;
+	std::string localAddress;
+	uint16_t localPort;
+	std::string remoteAddress;
+	uint16_t remotePort;
+	uint8_t state;
+	uint32_t uid;
+	uint64_t inode;
+} NetworkSocket;
+
+/**
+ * Representation of a network interface in the network sensor module.
+ */
+typedef struct{
+	std::string name;
+	uint32_t flags;
+} NetworkInterface;
+
+/*!
+ * @class NetworkSensorModule NetworkSensorModule.h "vmiids/modules/sensor/NetworkSensorModule.h"
+ * @brief Sensor to create a view of the monitored machines sockets and network interfaces.
+ * @sa vmi::SensorModule
+ * @sa ShellSensorModule
+ *
+ * The network sensor reads /proc/net/{tcp,tcp6,udp,udp6} and the flags of all network interfaces
+ * from the monitored machine. All files are transferred with a single command through the
+ * ShellSensorModule and parsed into flat records.
+ * Note, that this information is not reliable for the purpose of rootkit detection.
+ *
+ * The ShellSensorModule is resolved on first use, so the sensors may be loaded in any order.
+ */
+class NetworkSensorModule : public vmi::SensorModule{
+public:
+	/**
+	 * Constructor
+	 */
+	NetworkSensorModule();
+	/**
+	 * Destructor
+	 */
+	virtual ~NetworkSensorModule();
+
+	/**
+	 * Receive the sockets and network interfaces of the monitored machine.
+	 *
+	 * @param sockets Vector to append all sockets to.
+	 * @param interfaces Vector to append all network interfaces to.
+	 */
+	void getNetworkState(std::vector<NetworkSocket> &sockets, std::vector<NetworkInterface> &interfaces);
+
+private:
+	vmi::Mutex mutex; //!< Mutex to handle multithreaded execution
+
+	ShellSensorModule * shell;  //!< ShellSensorModule used to access the monitored machine.
+
+	/**
+	 * Parse a line of /proc/net/{tcp,tcp6,udp,udp6}.
+	 *
+	 * @param line Line to parse.
+	 * @param protocol Protocol of the file the line was read from.
+	 * @param ipv6 Flag, whether the line was read from an ipv6 file.
+	 * @param socket Socket to store the result in.
+	 * @return True, if the line describes a socket.
+	 */
+	bool parseSocket(const std::string &line, NETWORK_PROTOCOL protocol, bool ipv6, NetworkSocket &socket);
+};
+
+#endif /* NETWORKSENSORMODULE_H_ */
@@ -0,0 +1,82 @@
+/*
+ * socketlist.js
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ *
+ * Memtool script listing the TCP and UDP sockets of the kernel, used by
+ * MemorySensorModule::getSocketList().
+ *
+ * The sockets are read from the kernel hash tables instead of /proc/net, so sockets
+ * hidden from the monitored machine are listed as well. One socket is printed per
+ * line: protocol, local port and inode separated by spaces.
+ *
+ * Written for the 2.6.3x kernels monitored by vmiids.
+ */
+
+/*
+ * Return the structure of type type containing the instance member at field member.
+ */
+function containerOf(member, type, field)
+{
+	var container = member.Cast(type);
+	container.AddToAddress(-container.MemberOffset(field));
+	return container;
+}
+
+/*
+ * Convert a 16 bit value from network to host byte order.
+ */
+function ntohs(value)
+{
+	return ((value & 0xff) << 8) | ((value >> 8) & 0xff);
+}
+
+/*
+ * Print protocol, local port and inode of the socket sk.
+ */
+function printSocket(protocol, sk)
+{
+	var inet = sk.Cast("inet_sock");
+	var port = inet.MemberNames().indexOf("inet_sport") >= 0 ?
+			inet.inet_sport.toUInt16() : inet.sport.toUInt16();
+	var inode = 0;
+	if (!sk.sk_socket.IsNull()) {
+		inode = containerOf(sk.sk_socket, "socket_alloc", "socket").vfs_inode.i_ino.toUInt32();
+	}
+	print(protocol + " " + ntohs(port) + " " + inode);
+}
+
+/*
+ * Print all sockets of a hlist_nulls, linked by sock_common.skc_nulls_node.
+ * The end of the list is marked by an odd pointer.
+ */
+function printHListNulls(protocol, head)
+{
+	var node = head.first;
+	while (!node.IsNull() && (node.AddressLow() & 1) == 0) {
+		// sock_common is the first member of sock.
+		var sk = containerOf(node, "sock_common", "skc_nulls_node").Cast("sock");
+		printSocket(protocol, sk);
+		node = node.next;
+	}
+}
+
+print("Protocol Port Inode");
+
+// Listening and established TCP sockets
+var tcp = new Instance("tcp_hashinfo");
+for (var i = 0; i < tcp.listening_hash.ArrayLength(); i++) {
+	printHListNulls("tcp", tcp.listening_hash.ArrayElem(i).head);
+}
+var ehashMask = tcp.ehash_mask.toUInt32();
+for (var i = 0; i <= ehashMask; i++) {
+	printHListNulls("tcp", tcp.ehash.ArrayElem(i).chain);
+}
+
+// Bound UDP sockets
+var udp = new Instance("udp_table");
+var udpMask = udp.mask.toUInt32();
+for (var i = 0; i <= udpMask; i++) {
+	printHListNulls("udp", udp.hash.ArrayElem(i).head);
+}
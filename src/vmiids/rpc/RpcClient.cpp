@@ -7,33 +7,187 @@
 
 #include "RpcClient.h"
 
+#include <cerrno>
 #include <cstdlib>
+#include <cstring>
+#include <netdb.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
 
 #include <iostream>
 #include <string>
 #include <sstream>
 #include <list>
 
-#define RPC_HOST "localhost"
-
-/* Default timeout can be changed using clnt_control() */
-static struct timeval TIMEOUT = { 25, 0 };
+#define JOB_POLL_INTERVAL 100000  //!< Time (in us) between two polls of a running job.
+#define RPC_TIMEOUT       25      //!< Time (in s) to wait for the server.
 
 vmi::RpcClient::RpcClient() {
+	this->fd = -1;
+	this->lastRequestId = 0;
 }
 
 vmi::RpcClient::~RpcClient() {
+	this->stopConnection();
 }
 
 void vmi::RpcClient::startConnection(void) {
-	this->clnt = clnt_create(RPC_HOST, VMIIDS_RPC, VMIIDS_RPC_VERSION, "udp");
-	if (this->clnt == NULL) {
-		clnt_pcreateerror(RPC_HOST);
-		throw RpcException("Could not connect to VmiIDS");
+	if (this->fd >= 0) {
+		return;
+	}
+	const char *address = getenv(VMIIDS_RPC_ADDRESS);
+	if (address == NULL || *address == '\0') {
+		address = VMIIDS_RPC_SOCKET;
+	}
+
+	std::string host(address);
+	size_t separator = host.rfind(':');
+	if (host[0] != '/' && separator != std::string::npos) {
+		// host:port
+		struct addrinfo hints;
+		struct addrinfo *addresses;
+		memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+		if (getaddrinfo(host.substr(0, separator).c_str(), host.substr(separator + 1).c_str(),
+				&hints, &addresses) != 0) {
+			throw RpcException("Could not resolve " + host);
+		}
+		for (struct addrinfo *it = addresses; it != NULL && this->fd < 0; it = it->ai_next) {
+			this->fd = socket(it->ai_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+			if (this->fd >= 0 && connect(this->fd, it->ai_addr, it->ai_addrlen) != 0) {
+				close(this->fd);
+				this->fd = -1;
+			}
+		}
+		freeaddrinfo(addresses);
+	} else {
+		struct sockaddr_un unixAddress;
+		memset(&unixAddress, 0, sizeof(unixAddress));
+		unixAddress.sun_family = AF_UNIX;
+		strncpy(unixAddress.sun_path, address, sizeof(unixAddress.sun_path) - 1);
+		this->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (this->fd >= 0 && connect(this->fd, (struct sockaddr *) &unixAddress, sizeof(unixAddress)) != 0) {
+			close(this->fd);
+			this->fd = -1;
+		}
+	}
+	if (this->fd < 0) {
+		throw RpcException("Could not connect to VmiIDS at " + host);
 	}
+
+	struct timeval timeout = { RPC_TIMEOUT, 0 };
+	setsockopt(this->fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	setsockopt(this->fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
 }
+
 void vmi::RpcClient::stopConnection(void) {
-	clnt_destroy (this->clnt);
+	if (this->fd >= 0) {
+		close(this->fd);
+		this->fd = -1;
+	}
+	this->replies.clear();
+}
+
+uint32_t vmi::RpcClient::sendRequest(eRPCFuncs function, RpcEncoder &arguments) {
+	this->startConnection();
+	if (++this->lastRequestId == 0) ++this->lastRequestId;
+	const std::string &frame = arguments.finish(this->lastRequestId, function);
+
+	size_t sent = 0;
+	while (sent < frame.size()) {
+		ssize_t result = send(this->fd, frame.data() + sent, frame.size() - sent, MSG_NOSIGNAL);
+		if (result < 0 && errno == EINTR) {
+			continue;
+		}
+		if (result <= 0) {
+			this->stopConnection();
+			throw RpcException("Could not send request");
+		}
+		sent += result;
+	}
+	return this->lastRequestId;
+}
+
+/**
+ * Read exactly length bytes.
+ * @return False, if the connection was closed or timed out.
+ */
+static bool receiveFully(int fd, char *buffer, size_t length){
+	size_t received = 0;
+	while (received < length) {
+		ssize_t result = recv(fd, buffer + received, length - received, 0);
+		if (result < 0 && errno == EINTR) {
+			continue;
+		}
+		if (result <= 0) {
+			return false;
+		}
+		received += result;
+	}
+	return true;
+}
+
+void vmi::RpcClient::receiveReply(uint32_t requestId, std::string &payload) {
+	uint8_t status;
+	std::map<uint32_t, Reply>::iterator it = this->replies.find(requestId);
+	if (it != this->replies.end()) {
+		status = it->second.status;
+		payload.swap(it->second.payload);
+		this->replies.erase(it);
+	} else {
+		while (true) {
+			rpcFrameHeader header;
+			if (!receiveFully(this->fd, (char *) &header, sizeof(header))) {
+				this->stopConnection();
+				throw RpcException("Connection to VmiIDS lost");
+			}
+			uint32_t length = ntohl(header.length);
+			if (length > VMIIDS_RPC_MAX_FRAME - sizeof(rpcFrameHeader)) {
+				this->stopConnection();
+				throw RpcException("Invalid reply");
+			}
+			uint32_t id = ntohl(header.requestId);
+			// The payload is read into the result buffer directly.
+			std::string &buffer = (id == requestId) ? payload : this->replies[id].payload;
+			buffer.resize(length);
+			if (length > 0 && !receiveFully(this->fd, &buffer[0], length)) {
+				this->stopConnection();
+				throw RpcException("Connection to VmiIDS lost");
+			}
+			if (id == requestId) {
+				status = header.status;
+				break;
+			}
+			this->replies[id].status = header.status;
+		}
+	}
+
+	if (status != RPC_OK) {
+		std::stringstream message;
+		message << "Request rejected by VmiIDS (status " << (unsigned int) status << ")";
+		throw RpcException(message.str());
+	}
+}
+
+void vmi::RpcClient::call(eRPCFuncs function, RpcEncoder &arguments, std::string &payload) {
+	uint32_t requestId = this->sendRequest(function, arguments);
+	this->receiveReply(requestId, payload);
+}
+
+bool vmi::RpcClient::callForSuccess(eRPCFuncs function, RpcEncoder &arguments) {
+	std::string payload;
+	uint32_t result = 0;
+	try {
+		this->call(function, arguments, payload);
+		RpcDecoder(payload.data(), payload.size()).getUInt32(result);
+	} catch (RpcException &e) {
+		e.printException();
+	}
+	return result;
 }
 
 vmi::RpcClient* vmi::RpcClient::instance = NULL;
@@ -46,130 +200,240 @@ vmi::RpcClient *vmi::RpcClient::getInstance() {
 
 bool vmi::RpcClient::enqueueDetectionModule(std::string detectionModuleName,
 		uint32_t timeInSeconds) {
-	this->startConnection();
-	enum clnt_stat retval;
-	bool_t result;
-	rpcArgumentStringInt arg;
-	char * moduleName = (char *) malloc(detectionModuleName.size() + 1);
-	memset(moduleName, '0', detectionModuleName.size() + 1);
-	memmove(moduleName, detectionModuleName.c_str(), detectionModuleName.size());
-	arg.string = moduleName;
-	arg.integer = timeInSeconds;
-
-	retval = clnt_call(this->clnt, ENQUEUEDETECTIONMODULE,
-			(xdrproc_t) xdr_rpcArgumentStringInt, (caddr_t) &arg,
-			(xdrproc_t) xdr_int, (caddr_t) &result,
-			TIMEOUT);
-	if (retval != RPC_SUCCESS) {
-		clnt_perror(this->clnt, "call failed");
-	}
-	this->stopConnection();
-	return result;
+	RpcEncoder arguments;
+	arguments.putString(detectionModuleName);
+	arguments.putUInt32(timeInSeconds);
+	return this->callForSuccess(ENQUEUEDETECTIONMODULE, arguments);
 }
 
 bool vmi::RpcClient::dequeueDetectionModule(std::string detectionModuleName,
 		uint32_t timeInSeconds) {
-	this->startConnection();
-	enum clnt_stat retval;
-	bool_t result;
-	rpcArgumentStringInt arg;
-	char * moduleName = (char *) malloc(detectionModuleName.size() + 1);
-	memset(moduleName, '0', detectionModuleName.size() + 1);
-	memmove(moduleName, detectionModuleName.c_str(), detectionModuleName.size());
-	arg.string = moduleName;
-	arg.integer = timeInSeconds;
-
-	retval = clnt_call(this->clnt, DEQUEUEDETECTIONMODULE,
-			(xdrproc_t) xdr_rpcArgumentStringInt, (caddr_t) &arg,
-			(xdrproc_t) xdr_int, (caddr_t) &result,
-			TIMEOUT);
-	if (retval != RPC_SUCCESS) {
-		clnt_perror(this->clnt, "call failed");
+	RpcEncoder arguments;
+	arguments.putString(detectionModuleName);
+	arguments.putUInt32(timeInSeconds);
+	return this->callForSuccess(DEQUEUEDETECTIONMODULE, arguments);
+}
+
+std::string vmi::RpcClient::runSingleDetectionModule(std::string module) {
+	uint32_t jobId = this->submitDetectionModule(module);
+	if (jobId == 0) {
+		return "Detection Module not found\n";
+	}
+	std::string output;
+	this->waitForJob(jobId, output);
+	return output;
+}
+
+uint32_t vmi::RpcClient::submitDetectionModule(std::string module) {
+	RpcEncoder arguments;
+	arguments.putString(module);
+	std::string payload;
+	uint32_t result = 0;
+	this->call(RUNDETECTIONMODULE, arguments, payload);
+	if (!RpcDecoder(payload.data(), payload.size()).getUInt32(result)) {
+		throw RpcException("Could not submit DetectionModule");
 	}
-	this->stopConnection();
-	free(moduleName);
 	return result;
 }
 
-std::string vmi::RpcClient::runSingleDetectionModule(std::string module) {
-	this->startConnection();
-	enum clnt_stat retval;
-	char *result = NULL;
-	const char * arg = module.c_str();
-
-	retval = clnt_call(this->clnt, RUNDETECTIONMODULE,
-			(xdrproc_t) xdr_wrapstring, (caddr_t) &arg,
-			(xdrproc_t) xdr_wrapstring, (caddr_t) &result,
-			TIMEOUT);
-	if (retval != RPC_SUCCESS) {
-		clnt_perror(this->clnt, "call failed");
-	}
-	std::string resultString(result);
-	this->stopConnection();
-	return resultString;
+/**
+ * Decode the result of a GETJOBRESULT request.
+ */
+static int decodeJobResult(const std::string &payload, std::string &output) {
+	vmi::RpcDecoder result(payload.data(), payload.size());
+	const char *string;
+	uint32_t length;
+	uint32_t state;
+	if (!result.getString(string, length) || !result.getUInt32(state)) {
+		throw vmi::RpcException("Could not query job");
+	}
+	output.append(string, length);
+	return state;
 }
 
-bool vmi::RpcClient::stopIDS(int signum) {
-	this->startConnection();
-	enum clnt_stat retval;
-	bool_t result;
+int vmi::RpcClient::getJobResult(uint32_t jobId, std::string &output) {
+	RpcEncoder arguments;
+	arguments.putUInt32(jobId);
+	std::string payload;
+	this->call(GETJOBRESULT, arguments, payload);
+	return decodeJobResult(payload, output);
+}
 
-	retval
-			= clnt_call (this->clnt, STOPIDS, (xdrproc_t) xdr_int, (caddr_t) &signum,
-					(xdrproc_t) xdr_bool, (caddr_t) &result,
-					TIMEOUT);
-	if (retval != RPC_SUCCESS) {
-		clnt_perror(this->clnt, "call failed");
+void vmi::RpcClient::getJobResults(const std::vector<uint32_t> &jobIds, std::vector<int> &states,
+		std::vector<std::string> &outputs) {
+	std::vector<uint32_t> requestIds;
+	for (size_t i = 0; i < jobIds.size(); i++) {
+		RpcEncoder arguments;
+		arguments.putUInt32(jobIds[i]);
+		requestIds.push_back(this->sendRequest(GETJOBRESULT, arguments));
 	}
-	this->stopConnection();
-	return result;
+	states.resize(jobIds.size());
+	outputs.resize(jobIds.size());
+	std::string payload;
+	try {
+		for (size_t i = 0; i < jobIds.size(); i++) {
+			this->receiveReply(requestIds[i], payload);
+			states[i] = decodeJobResult(payload, outputs[i]);
+		}
+	} catch (RpcException &e) {
+		// Do not leave the replies of the remaining requests on the connection.
+		this->stopConnection();
+		throw;
+	}
+}
+
+bool vmi::RpcClient::stopIDS(int signum) {
+	RpcEncoder arguments;
+	arguments.putUInt32(signum);
+	return this->callForSuccess(STOPIDS, arguments);
 }
 
 bool vmi::RpcClient::loadSharedObject(std::string path) {
-	this->startConnection();
-	enum clnt_stat retval;
-	bool_t result;
-	const char * arg = path.c_str();
+	RpcEncoder arguments;
+	arguments.putString(path);
+	return this->callForSuccess(LOADSHAREDOBJECT, arguments);
+}
 
-	retval = clnt_call(this->clnt, LOADSHAREDOBJECT,
-			(xdrproc_t) xdr_wrapstring, (caddr_t) &arg,
-			(xdrproc_t) xdr_int, (caddr_t) &result,
-			TIMEOUT);
-	if (retval != RPC_SUCCESS) {
-		clnt_perror(this->clnt, "call failed");
+int vmi::RpcClient::waitForJob(uint32_t jobId, std::string &output, unsigned int timeout) {
+	struct timeval start, now;
+	gettimeofday(&start, NULL);
+	int state;
+	while ((state = this->getJobResult(jobId, output)) == JOB_PENDING || state == JOB_RUNNING) {
+		gettimeofday(&now, NULL);
+		if (timeout != 0 && (now.tv_sec - start.tv_sec) * 1000 + (now.tv_usec - start.tv_usec) / 1000 >= (long) timeout) {
+			break;
+		}
+		usleep(JOB_POLL_INTERVAL);
 	}
-	this->stopConnection();
-	return result;
+	return state;
 }
 
 std::list<std::string> vmi::RpcClient::getListOfDetectionModules(void) {
-	this->startConnection();
-	enum clnt_stat retval;
-	char *result = NULL;
+	RpcEncoder arguments;
+	std::string payload;
+	std::list<std::string> stringList;
+	try {
+		this->call(GETDETECTIONMODULELIST, arguments, payload);
+	} catch (RpcException &e) {
+		e.printException();
+		return stringList;
+	}
 
-	retval = clnt_call(this->clnt, LOADSHAREDOBJECT,
-			(xdrproc_t) xdr_void, (caddr_t) NULL,
-			(xdrproc_t) xdr_wrapstring, (caddr_t) &result,
-			TIMEOUT);
-	if (retval != RPC_SUCCESS) {
-		clnt_perror(this->clnt, "call failed");
+	RpcDecoder result(payload.data(), payload.size());
+	uint32_t count = 0;
+	std::string module;
+	result.getUInt32(count);
+	for (uint32_t i = 0; i < count && result.getString(module); i++) {
+		stringList.push_back(module);
 	}
-	std::string detectionModulesString(result);
-	this->stopConnection();
+	return stringList;
+}
 
-	std::list<std::string> stringList;
+std::string vmi::RpcClient::getThreatLevel(void) {
+	RpcEncoder arguments;
+	std::string payload;
+	std::string threatLevel;
+	this->call(GETTHREATLEVEL, arguments, payload);
+	if (!RpcDecoder(payload.data(), payload.size()).getString(threatLevel)) {
+		throw RpcException("Could not query threat level");
+	}
+	return threatLevel;
+}
 
-	size_t oldNewlineSeparator = 0;
-	size_t newlineSeparator = 0;
+/**
+ * Decode the rpcRuntimeStatus of a module or schedule.
+ */
+static bool decodeRuntimeStatus(vmi::RpcDecoder &result, vmi::rpcRuntimeStatus &status) {
+	return result.getUInt32(status.runs) && result.getUInt32(status.failures)
+			&& result.getUInt32(status.waiting) && result.getUInt32(status.running)
+			&& result.getUInt64(status.lastRuntime) && result.getUInt64(status.averageRuntime)
+			&& result.getUInt64(status.p99Runtime) && result.getUInt64(status.lastStart)
+			&& result.getUInt64(status.lastEnd);
+}
 
-	oldNewlineSeparator = detectionModulesString.find("\n");
+void vmi::RpcClient::getStatus(rpcStatus &status) {
+	RpcEncoder arguments;
+	std::string payload;
+	this->call(GETSTATUS, arguments, payload);
 
-	std::string currentLine;
+	RpcDecoder result(payload.data(), payload.size());
+	uint32_t count;
+	bool valid = result.getUInt64(status.time) && result.getFloat(status.globalThreatLevel)
+			&& result.getUInt32(count);
+	status.schedules.clear();
+	for (uint32_t i = 0; valid && i < count; i++) {
+		status.schedules.push_back(rpcScheduleStatus());
+		rpcScheduleStatus &schedule = status.schedules.back();
+		uint32_t modules;
+		uint32_t paused = 0;
+		valid = result.getUInt32(schedule.seconds) && result.getUInt64(schedule.nextRun)
+				&& result.getFloat(schedule.threatLevel) && result.getUInt32(schedule.overruns)
+				&& result.getUInt32(paused) && decodeRuntimeStatus(result, schedule.rounds)
+				&& result.getUInt32(modules);
+		schedule.paused = paused;
+		for (uint32_t j = 0; valid && j < modules; j++) {
+			schedule.modules.push_back(std::string());
+			valid = result.getString(schedule.modules.back());
+		}
+	}
 
-	while((newlineSeparator = detectionModulesString.find("\n", oldNewlineSeparator)) != std::string::npos){
-		currentLine = detectionModulesString.substr(oldNewlineSeparator, newlineSeparator - oldNewlineSeparator);
-		stringList.push_back(currentLine);
-		oldNewlineSeparator = newlineSeparator+1;
+	valid = valid && result.getUInt32(count);
+	status.modules.clear();
+	for (uint32_t i = 0; valid && i < count; i++) {
+		status.modules.push_back(rpcModuleStatus());
+		rpcModuleStatus &module = status.modules.back();
+		uint32_t reported = 0;
+		valid = result.getString(module.name) && result.getUInt32(reported)
+				&& result.getFloat(module.threatLevel) && result.getUInt64(module.threatLevelTime)
+				&& decodeRuntimeStatus(result, module.runs);
+		module.reported = reported;
 	}
-	return stringList;
+
+	valid = valid && result.getUInt32(count);
+	status.sensors.clear();
+	for (uint32_t i = 0; valid && i < count; i++) {
+		status.sensors.push_back(std::string());
+		valid = result.getString(status.sensors.back());
+	}
+
+	if (!valid) {
+		throw RpcException("Could not query status");
+	}
+}
+
+bool vmi::RpcClient::addSchedule(uint32_t timeInSeconds, const std::vector<std::string> &detectionModules,
+		bool paused) {
+	RpcEncoder arguments;
+	arguments.putUInt32(timeInSeconds);
+	arguments.putUInt32(paused);
+	arguments.putUInt32(detectionModules.size());
+	for (size_t i = 0; i < detectionModules.size(); i++) {
+		arguments.putString(detectionModules[i]);
+	}
+	return this->callForSuccess(ADDSCHEDULE, arguments);
+}
+
+bool vmi::RpcClient::removeSchedule(uint32_t timeInSeconds) {
+	RpcEncoder arguments;
+	arguments.putUInt32(timeInSeconds);
+	return this->callForSuccess(REMOVESCHEDULE, arguments);
+}
+
+bool vmi::RpcClient::retimeSchedule(uint32_t timeInSeconds, uint32_t newTimeInSeconds) {
+	RpcEncoder arguments;
+	arguments.putUInt32(timeInSeconds);
+	arguments.putUInt32(newTimeInSeconds);
+	return this->callForSuccess(RETIMESCHEDULE, arguments);
+}
+
+bool vmi::RpcClient::pauseSchedule(uint32_t timeInSeconds, bool paused) {
+	RpcEncoder arguments;
+	arguments.putUInt32(timeInSeconds);
+	arguments.putUInt32(paused);
+	return this->callForSuccess(PAUSESCHEDULE, arguments);
+}
+
+bool vmi::RpcClient::reloadConfiguration() {
+	RpcEncoder arguments;
+	return this->callForSuccess(RELOADCONFIG, arguments);
 }
@@ -12,6 +12,8 @@
 
 #include <string>
 #include <list>
+#include <map>
+#include <vector>
 
 namespace vmi {
 
@@ -21,24 +23,75 @@ namespace vmi {
  * This class provides rpc client functionality.
  *
  * Every function is mapped to the appropriate rpc request.
- * Currently this function only supports queries on localhost.
+ *
+ * The client connects to the UNIX socket VMIIDS_RPC_SOCKET. The environment variable
+ * VMIIDS_RPC (VMIIDS_RPC_ADDRESS) overrides the address, either with the path of another
+ * UNIX socket or with host:port for a TCP connection. The connection is kept open between
+ * requests and reopened after an error.
+ *
+ * Replies are read directly into their result buffer. getJobResults() pipelines several
+ * requests on the connection.
  */
 class RpcClient {
 private:
-	CLIENT *clnt; //!< RPC internal data structure.
+	/**
+	 * Reply received while waiting for another one.
+	 */
+	struct Reply {
+		uint8_t status;        //!< Status of the reply. See eRPCStatus.
+		std::string payload;   //!< Result of the request.
+	};
+
+	int fd;                  //!< Connection to the rpc server. -1, if not connected.
+	uint32_t lastRequestId;  //!< Last request ID assigned.
+	std::map<uint32_t, Reply> replies;  //!< Replies received ahead of the awaited one.
 
 	static RpcClient *instance; //!< Instance of the RpcClient class (Singleton)
 
 	/**
-	 * Internal function to start the rpc connection.
+	 * Internal function to open the rpc connection, if it is not open.
 	 */
 	void startConnection(void);
 
 	/**
-	 * Internal function to quit the rpc connection.
+	 * Internal function to close the rpc connection.
 	 */
 	void stopConnection(void);
 
+	/**
+	 * Send a request without waiting for its reply.
+	 *
+	 * @param function Function to call.
+	 * @param arguments Arguments of the function. The frame is finished in place.
+	 * @return Request ID to pass to receiveReply().
+	 */
+	uint32_t sendRequest(eRPCFuncs function, RpcEncoder &arguments);
+	/**
+	 * Wait for the reply to a request.
+	 *
+	 * @param requestId ID returned by sendRequest().
+	 * @param payload String receiving the result of the request.
+	 */
+	void receiveReply(uint32_t requestId, std::string &payload);
+	/**
+	 * Send a request and wait for its reply.
+	 * Throws a RpcException, if the server could not be reached or rejected the request.
+	 *
+	 * @param function Function to call.
+	 * @param arguments Arguments of the function.
+	 * @param payload String receiving the result of the request.
+	 */
+	void call(eRPCFuncs function, RpcEncoder &arguments, std::string &payload);
+
+	/**
+	 * Call a function returning a success flag. Errors are printed, not thrown.
+	 *
+	 * @param function Function to call.
+	 * @param arguments Arguments of the function.
+	 * @return Success returned by the server. False, if the request failed.
+	 */
+	bool callForSuccess(eRPCFuncs function, RpcEncoder &arguments);
+
 	/**
 	 * Constructor
 	 */
@@ -62,7 +115,7 @@ public:
 	 * Note: The DetectionModule must be loaded in advance. Use the loadSharedObject() method to load a module.
 	 *
 	 * @param detectionModuleName Name of the DetectionModule.
-	 * @param timeInSeconds Time between two runs of the module.
+	 * @param timeInSeconds Time between two runs of the module. Must not be zero.
 	 * @return True, if the DetectionModule was successfully enqueued.
 	 */
 	bool enqueueDetectionModule(std::string detectionModuleName, uint32_t timeInSeconds = 0);
@@ -81,12 +134,55 @@ public:
 
 	/**
 	 * Run single DetectionModule.
+	 * The run is submitted as a job. The function polls the job until it has finished.
 	 *
 	 * @param module Name of the DetectionModule to run.
 	 * @return Output the DetectionModule produced while running.
 	 */
 	std::string runSingleDetectionModule(std::string module);
 
+	/**
+	 * Submit a single run of a DetectionModule. The function returns immediately.
+	 *
+	 * @param module Name of the DetectionModule to run.
+	 * @return Job ID of the run. Zero, if the DetectionModule is not loaded or the server
+	 *         runs too many jobs.
+	 */
+	uint32_t submitDetectionModule(std::string module);
+
+	/**
+	 * Query the state of a job and collect its output. The function returns immediately.
+	 * Each call returns the output produced since the previous call, so the output of a
+	 * running job can be streamed. A finished job is removed on the server, when its state
+	 * has been returned once.
+	 *
+	 * @param jobId ID of the job.
+	 * @param output String to append the new output of the job to.
+	 * @return State of the job. See vmi::eJobState.
+	 */
+	int getJobResult(uint32_t jobId, std::string &output);
+
+	/**
+	 * Query the states of several jobs and collect their output. The requests are pipelined,
+	 * so this takes about one round trip. See getJobResult().
+	 *
+	 * @param jobIds IDs of the jobs.
+	 * @param states Receives the state of each job.
+	 * @param outputs Receives the new output of each job.
+	 */
+	void getJobResults(const std::vector<uint32_t> &jobIds, std::vector<int> &states,
+			std::vector<std::string> &outputs);
+
+	/**
+	 * Wait for a job to finish and collect its output.
+	 *
+	 * @param jobId ID of the job.
+	 * @param output String to append the new output of the job to.
+	 * @param timeout Maximum time to wait (in ms). Zero waits until the job has finished.
+	 * @return State of the job. JOB_PENDING or JOB_RUNNING, if the timeout has expired.
+	 */
+	int waitForJob(uint32_t jobId, std::string &output, unsigned int timeout = 0);
+
 	/**
 	 * Stop the entire framework. It is not able to restart the framework with rpc.
 	 * @param signum Signal to stop the framework with.
@@ -106,6 +202,61 @@ public:
 	 * @return List of loaded DetectionModules.
 	 */
 	std::list<std::string> getListOfDetectionModules(void);
+
+	/**
+	 * Query the threat levels collected by the framework.
+	 * @sa vmi::ThreatLevelService
+	 * @return Global, per schedule and per module threat levels. One per line.
+	 */
+	std::string getThreatLevel(void);
+
+	/**
+	 * Query a snapshot of all schedules, DetectionModules and SensorModules, including their
+	 * runtimes, threat levels and error counts. Cheap enough to be polled periodically.
+	 * @param status Snapshot taken by the framework.
+	 * @throws RpcException, if the request failed.
+	 */
+	void getStatus(rpcStatus &status);
+
+	/**
+	 * Create a new schedule.
+	 * @param timeInSeconds Time between two runs of the schedule.
+	 * @param detectionModules Names of the DetectionModules to execute.
+	 * @param paused True to create the schedule suspended.
+	 * @return True, if the schedule was created.
+	 */
+	bool addSchedule(uint32_t timeInSeconds, const std::vector<std::string> &detectionModules,
+			bool paused = false);
+
+	/**
+	 * Remove a schedule. Running modules are not interrupted.
+	 * @param timeInSeconds Time between two runs of the schedule.
+	 * @return True, if the schedule was removed.
+	 */
+	bool removeSchedule(uint32_t timeInSeconds);
+
+	/**
+	 * Change the time between two runs of a schedule. Takes effect at its next run.
+	 * @param timeInSeconds Time between two runs of the schedule.
+	 * @param newTimeInSeconds New time between two runs.
+	 * @return True, if the schedule was changed.
+	 */
+	bool retimeSchedule(uint32_t timeInSeconds, uint32_t newTimeInSeconds);
+
+	/**
+	 * Suspend or resume a schedule.
+	 * @param timeInSeconds Time between two runs of the schedule.
+	 * @param paused True to suspend the schedule, false to resume it.
+	 * @return True, if the schedule exists.
+	 */
+	bool pauseSchedule(uint32_t timeInSeconds, bool paused);
+
+	/**
+	 * Reload the configuration file of the framework, like SIGHUP does.
+	 * The file is reloaded asynchronously. Errors are reported in the log of the framework.
+	 * @return True, if the reload was scheduled.
+	 */
+	bool reloadConfiguration(void);
 };
 
 }
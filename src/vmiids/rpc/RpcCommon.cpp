@@ -7,12 +7,112 @@
 
 #include "RpcCommon.h"
 
-bool_t
-vmi::xdr_rpcArgumentStringInt (XDR *xdrs, rpcArgumentStringInt *objp)
-{
-	 if (!xdr_string (xdrs, &objp->string, ~0))
-		 return FALSE;
-	 if (!xdr_int (xdrs, &objp->integer))
-		 return FALSE;
-	return TRUE;
+#include <cstring>
+#include <arpa/inet.h>
+
+vmi::RpcEncoder::RpcEncoder() :
+		frame(sizeof(rpcFrameHeader), '\0') {
+}
+
+void vmi::RpcEncoder::putUInt32(uint32_t value){
+	value = htonl(value);
+	frame.append((const char *) &value, sizeof(value));
+}
+
+void vmi::RpcEncoder::putUInt64(uint64_t value){
+	putUInt32(value >> 32);
+	putUInt32(value);
+}
+
+void vmi::RpcEncoder::putFloat(float value){
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	putUInt32(bits);
+}
+
+void vmi::RpcEncoder::putString(const std::string &value){
+	putUInt32(value.size());
+	frame.append(value);
+}
+
+size_t vmi::RpcEncoder::beginString(){
+	size_t position = frame.size();
+	putUInt32(0);
+	return position;
+}
+
+void vmi::RpcEncoder::endString(size_t position){
+	uint32_t length = htonl(frame.size() - position - sizeof(uint32_t));
+	memcpy(&frame[position], &length, sizeof(length));
+}
+
+std::string &vmi::RpcEncoder::finish(uint32_t requestId, uint16_t function, uint8_t status){
+	rpcFrameHeader header;
+	header.length = htonl(frame.size() - sizeof(rpcFrameHeader));
+	header.requestId = htonl(requestId);
+	header.function = htons(function);
+	header.version = VMIIDS_RPC_VERSION;
+	header.status = status;
+	memcpy(&frame[0], &header, sizeof(header));
+	return frame;
+}
+
+vmi::RpcDecoder::RpcDecoder(const char *data, size_t length) :
+		data(data), length(length), offset(0) {
+}
+
+bool vmi::RpcDecoder::getUInt32(uint32_t &value){
+	if (length - offset < sizeof(uint32_t)) {
+		return false;
+	}
+	memcpy(&value, data + offset, sizeof(value));
+	value = ntohl(value);
+	offset += sizeof(uint32_t);
+	return true;
+}
+
+bool vmi::RpcDecoder::getUInt64(uint64_t &value){
+	if (length - offset < sizeof(uint64_t)) {
+		return false;
+	}
+	uint32_t halves[2];
+	memcpy(halves, data + offset, sizeof(halves));
+	offset += sizeof(halves);
+	value = ((uint64_t) ntohl(halves[0]) << 32) | ntohl(halves[1]);
+	return true;
+}
+
+bool vmi::RpcDecoder::getFloat(float &value){
+	uint32_t bits;
+	if (!getUInt32(bits)) {
+		return false;
+	}
+	memcpy(&value, &bits, sizeof(value));
+	return true;
+}
+
+bool vmi::RpcDecoder::getString(const char *&value, uint32_t &valueLength){
+	size_t start = offset;
+	uint32_t stringLength;
+	if (!getUInt32(stringLength)) {
+		return false;
+	}
+	if (length - offset < stringLength) {
+		offset = start;
+		return false;
+	}
+	value = data + offset;
+	valueLength = stringLength;
+	offset += stringLength;
+	return true;
+}
+
+bool vmi::RpcDecoder::getString(std::string &value){
+	const char *string;
+	uint32_t stringLength;
+	if (!getString(string, stringLength)) {
+		return false;
+	}
+	value.assign(string, stringLength);
+	return true;
 }
@@ -8,30 +8,42 @@
 #ifndef RPCCOMMON_H_
 #define RPCCOMMON_H_
 
-#include <rpc/rpc.h>
 #include <iostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
 
 namespace vmi {
 
 /**
- * Data structure to send a string and an integer over rpc.
+ * State of a job executed by the rpc server.
  */
-typedef struct {
-	char *string;
-	int   integer;
-} rpcArgumentStringInt;
-
-/**
- * Function to check whether the rpcArgumentStringInt data structure contains valid content.
- *
- * @param xdrs RPC internal data structure
- * @param objp rpcArgumentStringInt data structure.
- * @return True, if the struct contains valid input.
- */
-bool_t xdr_rpcArgumentStringInt (XDR *xdrs, rpcArgumentStringInt *objp);
+typedef enum {
+	JOB_UNKNOWN = 0,   //!< Job ID not known (never submitted or result already fetched).
+	JOB_PENDING,       //!< Job waits for a worker.
+	JOB_RUNNING,       //!< Job is executed.
+	JOB_FINISHED,      //!< Job has finished. The output is complete.
+	JOB_FAILED,        //!< Job was aborted by an exception.
+} eJobState;
 
 /**
  * Enum defining the function called over the rpc connection.
+ *
+ * Arguments and results of the functions (see RpcEncoder for the encoding):
+ *  - ENQUEUEDETECTIONMODULE: string module, uint32 seconds -> uint32 success
+ *  - DEQUEUEDETECTIONMODULE: string module, uint32 seconds -> uint32 success
+ *  - RUNDETECTIONMODULE: string module -> uint32 job ID
+ *  - STOPIDS: uint32 signal -> uint32 success
+ *  - LOADSHAREDOBJECT: string path -> uint32 success
+ *  - GETDETECTIONMODULELIST: -> uint32 count, count * string module
+ *  - GETTHREATLEVEL: -> string report
+ *  - GETJOBRESULT: uint32 job ID -> string output, uint32 state
+ *  - GETSTATUS: -> rpcStatus
+ *  - ADDSCHEDULE: uint32 seconds, uint32 paused, uint32 count, count * string module -> uint32 success
+ *  - REMOVESCHEDULE: uint32 seconds -> uint32 success
+ *  - RETIMESCHEDULE: uint32 seconds, uint32 new seconds -> uint32 success
+ *  - PAUSESCHEDULE: uint32 seconds, uint32 paused -> uint32 success
+ *  - RELOADCONFIG: -> uint32 success (reload scheduled, applied asynchronously)
  */
 typedef enum {
 	ENQUEUEDETECTIONMODULE = 1,
@@ -40,17 +52,231 @@ typedef enum {
 	STOPIDS,
 	LOADSHAREDOBJECT,
 	GETDETECTIONMODULELIST,
+	GETTHREATLEVEL,
+	GETJOBRESULT,
+	GETSTATUS,
+	ADDSCHEDULE,
+	REMOVESCHEDULE,
+	RETIMESCHEDULE,
+	PAUSESCHEDULE,
+	RELOADCONFIG,
 } eRPCFuncs;
 
 /**
- * RPC Identifier.
+ * Status of a reply.
  */
-#define VMIIDS_RPC 			555555555
+typedef enum {
+	RPC_OK = 0,          //!< Request was executed.
+	RPC_ERROR_VERSION,   //!< Protocol version not supported.
+	RPC_ERROR_FUNCTION,  //!< Unknown function.
+	RPC_ERROR_ARGUMENT,  //!< Arguments could not be decoded.
+} eRPCStatus;
 
 /**
  * RPC API Version.
  */
-#define VMIIDS_RPC_VERSION 	1
+#define VMIIDS_RPC_VERSION 	2
+
+/**
+ * Default path of the UNIX socket of the rpc server. The server creates the directory
+ * with mode 0700, if it does not exist.
+ */
+#define VMIIDS_RPC_SOCKET   "/run/vmiids/rpc.sock"
+
+/**
+ * Environment variable overriding the address used by the RpcClient.
+ * Either the path of a UNIX socket or host:port for TCP.
+ */
+#define VMIIDS_RPC_ADDRESS  "VMIIDS_RPC"
+
+/**
+ * Maximum size of a frame (header and payload).
+ */
+#define VMIIDS_RPC_MAX_FRAME (64 * 1024 * 1024)
+
+/**
+ * Header of each request and reply frame. All fields are in network byte order.
+ *
+ * A connection carries a sequence of frames. The client may send several requests without
+ * waiting for their replies (pipelining). The server executes the requests of a connection
+ * in order and answers each request with one reply carrying the same request ID.
+ */
+typedef struct {
+	uint32_t length;     //!< Length of the payload following the header.
+	uint32_t requestId;  //!< ID chosen by the client. Echoed in the reply.
+	uint16_t function;   //!< Called function. See eRPCFuncs.
+	uint8_t version;     //!< VMIIDS_RPC_VERSION
+	uint8_t status;      //!< Status of a reply. See eRPCStatus. Zero in requests.
+} rpcFrameHeader;
+
+/**
+ * Runtime counters of a DetectionModule or a schedule. All times are in us.
+ *
+ * Encoded as uint32 runs, failures, waiting, running, followed by uint64 lastRuntime,
+ * averageRuntime, p99Runtime, lastStart, lastEnd.
+ */
+struct rpcRuntimeStatus {
+	uint32_t runs;             //!< Number of finished runs.
+	uint32_t failures;         //!< Number of runs aborted by an exception.
+	uint32_t waiting;          //!< Number of runs waiting to be executed.
+	uint32_t running;          //!< Number of runs executed right now.
+	uint64_t lastRuntime;      //!< Runtime of the last run.
+	uint64_t averageRuntime;   //!< Average runtime.
+	uint64_t p99Runtime;       //!< 99th percentile of the runtime (upper bound, +25% at most).
+	uint64_t lastStart;        //!< Start of the last run (since epoch). Zero, if never started.
+	uint64_t lastEnd;          //!< End of the last run (since epoch). Zero, if never finished.
+};
+
+/**
+ * Status of a schedule.
+ *
+ * Encoded as uint32 seconds, uint64 nextRun, float threatLevel, uint32 overruns,
+ * uint32 paused, rpcRuntimeStatus rounds, uint32 count, count * string module.
+ */
+struct rpcScheduleStatus {
+	uint32_t seconds;          //!< Time between two runs of the schedule.
+	uint64_t nextRun;          //!< Time of the next run (us since epoch).
+	float threatLevel;         //!< Decayed average threat level of the modules of the schedule.
+	uint32_t overruns;         //!< Number of rounds, which took longer than seconds.
+	bool paused;               //!< True, if the schedule is suspended.
+	rpcRuntimeStatus rounds;   //!< Runtime counters of the rounds (one run of all modules).
+	std::vector<std::string> modules;  //!< Names of the modules enqueued.
+};
+
+/**
+ * Status of a DetectionModule.
+ *
+ * Encoded as string name, uint32 reported, float threatLevel, uint64 threatLevelTime,
+ * rpcRuntimeStatus runs.
+ */
+struct rpcModuleStatus {
+	std::string name;          //!< Name of the module.
+	bool reported;             //!< False, if the module has not reported a threat level yet.
+	float threatLevel;         //!< Last reported threat level.
+	uint64_t threatLevelTime;  //!< Time of the last report (us since epoch).
+	rpcRuntimeStatus runs;     //!< Runtime counters of all runs, scheduled or requested.
+};
+
+/**
+ * Snapshot of the framework returned by GETSTATUS.
+ *
+ * Encoded as uint64 time, float globalThreatLevel, uint32 count, count * rpcScheduleStatus,
+ * uint32 count, count * rpcModuleStatus, uint32 count, count * string sensor.
+ * The server assembles the snapshot from lock-free counters. It is cheap enough to be polled
+ * periodically, but not taken atomically.
+ */
+struct rpcStatus {
+	uint64_t time;             //!< Time the snapshot was taken (us since epoch).
+	float globalThreatLevel;   //!< Global threat level.
+	std::vector<rpcScheduleStatus> schedules;  //!< Schedules, ordered by seconds.
+	std::vector<rpcModuleStatus> modules;      //!< Loaded DetectionModules, ordered by name.
+	std::vector<std::string> sensors;          //!< Loaded SensorModules, ordered by name.
+};
+
+/**
+ * @class RpcEncoder RpcCommon.h "vmiids/rpc/RpcCommon.h"
+ *
+ * Builds a frame. The header is reserved in front of the payload, so the finished
+ * frame is a single buffer, which is sent without further copies.
+ *
+ * Integers are encoded as 32 or 64 bit in network byte order, floats as the 32 bit
+ * integer of their IEEE 754 representation, strings as their length followed by their bytes.
+ */
+class RpcEncoder {
+private:
+	std::string frame;   //!< Header and payload.
+
+public:
+	/**
+	 * Constructor. Creates an empty payload.
+	 */
+	RpcEncoder();
+
+	/**
+	 * Append an integer to the payload.
+	 */
+	void putUInt32(uint32_t value);
+	/**
+	 * Append a 64 bit integer to the payload.
+	 */
+	void putUInt64(uint64_t value);
+	/**
+	 * Append a float to the payload.
+	 */
+	void putFloat(float value);
+	/**
+	 * Append a string to the payload.
+	 */
+	void putString(const std::string &value);
+	/**
+	 * Start a string, whose content is appended directly to getBuffer().
+	 * @return Position to pass to endString().
+	 */
+	size_t beginString();
+	/**
+	 * Finish a string started by beginString().
+	 */
+	void endString(size_t position);
+	/**
+	 * @return Buffer of the frame. Content appended is part of the payload.
+	 */
+	std::string &getBuffer(){ return frame; }
+
+	/**
+	 * Write the header. Afterwards getBuffer() contains the complete frame.
+	 *
+	 * @param requestId ID of the request.
+	 * @param function Called function.
+	 * @param status Status of a reply.
+	 * @return Frame.
+	 */
+	std::string &finish(uint32_t requestId, uint16_t function, uint8_t status = RPC_OK);
+};
+
+/**
+ * @class RpcDecoder RpcCommon.h "vmiids/rpc/RpcCommon.h"
+ *
+ * Reads the payload of a frame encoded by RpcEncoder. The decoder does not copy the payload.
+ * Reading beyond the payload fails and leaves the value untouched.
+ */
+class RpcDecoder {
+private:
+	const char *data;   //!< Payload.
+	size_t length;      //!< Length of the payload.
+	size_t offset;      //!< Offset of the next value.
+
+public:
+	/**
+	 * Constructor
+	 * @param data Payload. Must stay valid while the decoder is used.
+	 * @param length Length of the payload.
+	 */
+	RpcDecoder(const char *data, size_t length);
+
+	/**
+	 * @return False, if the payload does not contain another integer.
+	 */
+	bool getUInt32(uint32_t &value);
+	/**
+	 * @return False, if the payload does not contain another 64 bit integer.
+	 */
+	bool getUInt64(uint64_t &value);
+	/**
+	 * @return False, if the payload does not contain another float.
+	 */
+	bool getFloat(float &value);
+	/**
+	 * @return False, if the payload does not contain another string.
+	 */
+	bool getString(std::string &value);
+	/**
+	 * Read a string without copying it.
+	 * @param value Set to the string inside the payload. Not null terminated.
+	 * @param valueLength Length of the string.
+	 * @return False, if the payload does not contain another string.
+	 */
+	bool getString(const char *&value, uint32_t &valueLength);
+};
 
 /**
  * @class RpcException RpcCommon.h "vmiids/rpc/RpcCommon.h"
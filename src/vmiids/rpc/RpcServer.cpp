@@ -9,20 +9,150 @@
 
 #include "vmiids/VmiIDS.h"
 
-#include <rpc/pmap_clnt.h>
 #include <signal.h>
-
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
 #include <sstream>
 #include <string>
 #include <list>
+#include <set>
 
 #include "vmiids/modules/notification/BufferNotificationModule.h"
 #include "vmiids/DetectionModule.h"
+#include "vmiids/DetectionThread.h"
+#include "vmiids/SensorModule.h"
+#include "vmiids/ThreatLevelService.h"
+#include "vmiids/util/MutexLocker.h"
+#include "vmiids/util/Settings.h"
+
+#define RPC_RECEIVE_SIZE  65536  //!< Number of bytes read from a connection at once.
+#define RPC_SEND_VECTORS  16     //!< Maximum number of replies passed to sendmsg() at once.
 
 vmi::RpcServer* vmi::RpcServer::this_p = NULL;
 
-vmi::RpcServer::RpcServer() {
+/**
+ * @class vmi::RpcServer::DetectionJob
+ * @brief Single run of a DetectionModule requested over rpc.
+ *
+ * The module is resolved by the worker, so a module, which is not constructed yet, is constructed
+ * on the pool and not on the rpc thread. The job is pending meanwhile.
+ * The output of the run is captured while the module runs and can be collected in parts.
+ * Once the state is final, the worker does not access the job anymore.
+ */
+class vmi::RpcServer::DetectionJob : public vmi::ThreadPool::Task {
+private:
+	std::string moduleName;        //!< Name of the module to run.
+	vmi::Mutex mutex;              //!< Protects output and buffer.
+	std::string output;            //!< Output not yet collected.
+	BufferNotificationModule *buffer;  //!< Captures the output while the module runs.
+
+	/**
+	 * Finish the run. Must be the last access of the worker.
+	 */
+	void finish(int finalState){
+		{
+			vmi::MutexLocker lock(&mutex);
+			if (buffer != NULL) {
+				output.append(buffer->getBuffer());
+				delete buffer;
+				buffer = NULL;
+			}
+			finished = time(NULL);
+		}
+		__sync_synchronize();
+		state = finalState;
+	}
+
+public:
+	volatile int state;            //!< State of the job. See eJobState.
+	time_t finished;               //!< Time the job has finished.
+
+	DetectionJob(const std::string &moduleName) :
+			moduleName(moduleName), buffer(NULL), state(JOB_PENDING), finished(0) {}
+	virtual ~DetectionJob(){
+		delete buffer;
+	}
+
+	virtual void run(void){
+		DetectionModule *detectionModule = DetectionModule::pin(
+				DetectionModule::getDetectionModuleHandle(moduleName));
+		if (detectionModule == NULL) {
+			{
+				vmi::MutexLocker lock(&mutex);
+				output = "Detection Module not found\n";
+			}
+			finish(JOB_FAILED);
+			return;
+		}
+		uint32_t runId = Thread::createRunId();
+		{
+			vmi::MutexLocker lock(&mutex);
+			buffer = new BufferNotificationModule(runId);
+			buffer->attach();
+		}
+		state = JOB_RUNNING;
+		Thread::setCurrentRunId(runId);
+		bool success;
+		try {
+			success = detectionModule->execute();
+		} catch (std::exception &e) {
+			Thread::setCurrentRunId(0);
+			detectionModule->unpin();
+			NotificationModule::waitForDispatch();
+			finish(JOB_FAILED);
+			return;
+		}
+		Thread::setCurrentRunId(0);
+		ThreatLevelService::report(detectionModule);
+		detectionModule->unpin();
+		NotificationModule::waitForDispatch();
+		finish(success ? JOB_FINISHED : JOB_FAILED);
+	}
+
+	/**
+	 * Collect the output produced since the last call.
+	 * @param chunk String to append the output to.
+	 */
+	void collect(std::string &chunk){
+		vmi::MutexLocker lock(&mutex);
+		chunk.append(output);
+		output.clear();
+		if (buffer != NULL) {
+			chunk.append(buffer->getBuffer());
+		}
+	}
+
+	/**
+	 * @return True, if the job has finished.
+	 */
+	bool isFinished() const {
+		return state == JOB_FINISHED || state == JOB_FAILED;
+	}
+};
+
+vmi::RpcServer::RpcServer() :
+		workers(RPC_WORKER_THREADS) {
 	this_p = this;
+	lastJobId = 0;
+	running = true;
+	stopped = false;
+	pthread_mutex_init(&jobMutex, NULL);
+	if (pipe2(wakeFds, O_NONBLOCK | O_CLOEXEC) != 0) {
+		fprintf (stderr, "%s", "cannot create rpc wake pipe.");
+		exit(1);
+	}
 	pthread_create(&rpcThread, NULL, RpcServer::__runThread,
 				(void*) this);
 }
@@ -34,51 +164,400 @@ void* vmi::RpcServer::__runThread(void* ptr){
 }
 
 vmi::RpcServer::~RpcServer() {
+	this->stop();
+	close(wakeFds[0]);
+	close(wakeFds[1]);
+
+	pthread_mutex_lock(&jobMutex);
+	for (std::map<uint32_t, DetectionJob *>::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+		delete it->second;
+	}
+	jobs.clear();
+	pthread_mutex_unlock(&jobMutex);
+	pthread_mutex_destroy(&jobMutex);
 }
 
-void vmi::RpcServer::run(void) {
-	register SVCXPRT *transp;
+void vmi::RpcServer::stop() {
+	if (stopped) {
+		return;
+	}
+	running = false;
+	char wake = 0;
+	if (write(wakeFds[1], &wake, 1) < 0) {
+		// The pipe is full, the rpc thread wakes up anyway.
+	}
+	// Jobs are only submitted by the rpc thread. Once it is joined, no new jobs arrive.
+	pthread_join(rpcThread, NULL);
+	workers.waitForAll();
+	stopped = true;
+}
 
-	pmap_unset (VMIIDS_RPC, VMIIDS_RPC_VERSION);
+bool vmi::RpcServer::openListeners(){
+	std::string tcpAddress = "127.0.0.1";
+	unsigned int tcpPort = 0;
+	socketPath = VMIIDS_RPC_SOCKET;
+	try {
+		Settings::Reader reader(*Settings::getInstance());
+		const ConfigValue &setting = reader.getSetting("rpc");
+		setting.lookupValue("socketPath", socketPath);
+		setting.lookupValue("tcpAddress", tcpAddress);
+		setting.lookupValue("tcpPort", tcpPort);
+	} catch (OptionNotFoundException &e) {
+		// Use the UNIX socket at its default path.
+	}
 
-	transp = svcudp_create(RPC_ANYSOCK);
-	if (transp == NULL) {
-		fprintf (stderr, "%s", "cannot create udp service.");
-		exit(1);
+	struct sockaddr_un address;
+	if (socketPath.size() >= sizeof(address.sun_path)) {
+		return false;
 	}
-	if (!svc_register(transp, VMIIDS_RPC, VMIIDS_RPC_VERSION, vmi::RpcServer::dispatchRPC, IPPROTO_UDP)) {
-		fprintf (stderr, "%s", "unable to register (VMIIDS_RPC_PROG, VMIIDS_RPC_VERSION, udp).");
-		exit(1);
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socketPath.c_str());
+	// The socket allows to load code into the framework. Create its directory private to
+	// the user, so nobody else can connect before the socket itself is restricted below.
+	// Existing directories are left untouched.
+	size_t separator = socketPath.rfind('/');
+	if (separator != std::string::npos && separator > 0 &&
+			mkdir(socketPath.substr(0, separator).c_str(), 0700) != 0 && errno != EEXIST) {
+		fprintf (stderr, "cannot create rpc socket directory for %s.\n", socketPath.c_str());
+		return false;
+	}
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		return false;
+	}
+	// Remove the socket of a previous instance.
+	unlink(socketPath.c_str());
+	if (bind(fd, (struct sockaddr *) &address, sizeof(address)) != 0 ||
+			chmod(socketPath.c_str(), 0600) != 0 || listen(fd, SOMAXCONN) != 0) {
+		close(fd);
+		return false;
 	}
+	listenFds.push_back(fd);
 
-	transp = svctcp_create(RPC_ANYSOCK, 0, 0);
-	if (transp == NULL) {
-		fprintf (stderr, "%s", "cannot create tcp service.");
-		exit(1);
+	if (tcpPort == 0) {
+		return true;
+	}
+	struct addrinfo hints;
+	struct addrinfo *addresses;
+	char port[16];
+	snprintf(port, sizeof(port), "%u", tcpPort);
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = AI_PASSIVE | AI_NUMERICHOST | AI_NUMERICSERV;
+	if (getaddrinfo(tcpAddress.c_str(), port, &hints, &addresses) != 0) {
+		fprintf (stderr, "invalid rpc tcp address %s.\n", tcpAddress.c_str());
+		return true;
+	}
+	fd = socket(addresses->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	int reuse = 1;
+	if (fd >= 0 && (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+			bind(fd, addresses->ai_addr, addresses->ai_addrlen) != 0 || listen(fd, SOMAXCONN) != 0)) {
+		close(fd);
+		fd = -1;
 	}
-	if (!svc_register(transp, VMIIDS_RPC, VMIIDS_RPC_VERSION, vmi::RpcServer::dispatchRPC, IPPROTO_TCP)) {
-		fprintf (stderr, "%s", "unable to register (VMIIDS_RPC_PROG, VMIIDS_RPC_VERSION, tcp).");
+	freeaddrinfo(addresses);
+	if (fd < 0) {
+		fprintf (stderr, "cannot create rpc tcp service on %s:%u.\n", tcpAddress.c_str(), tcpPort);
+		return true;
+	}
+	listenFds.push_back(fd);
+	return true;
+}
+
+void vmi::RpcServer::run(void) {
+	if (!openListeners()) {
+		fprintf (stderr, "%s", "cannot create rpc service.");
 		exit(1);
 	}
 
-	svc_run ();
-	fprintf (stderr, "%s", "svc_run returned");
-	/* NOTREACHED */
+	std::vector<struct pollfd> fds;
+	std::vector<Connection *> polled;
+	while (running) {
+		fds.clear();
+		polled.clear();
+		struct pollfd fd;
+		fd.fd = wakeFds[0];
+		fd.events = POLLIN;
+		fd.revents = 0;
+		fds.push_back(fd);
+		for (size_t i = 0; i < listenFds.size(); i++) {
+			fd.fd = listenFds[i];
+			fds.push_back(fd);
+		}
+		for (std::list<Connection *>::iterator it = connections.begin(); it != connections.end(); ++it) {
+			fd.fd = (*it)->fd;
+			fd.events = 0;
+			if ((*it)->output.size() < RPC_MAX_PENDING) fd.events |= POLLIN;
+			if (!(*it)->output.empty()) fd.events |= POLLOUT;
+			fds.push_back(fd);
+			polled.push_back(*it);
+		}
+
+		if (poll(&fds[0], fds.size(), -1) <= 0) {
+			continue;
+		}
 
-	pthread_exit(NULL);
+		if (fds[0].revents & POLLIN) {
+			char buffer[64];
+			while (read(wakeFds[0], buffer, sizeof(buffer)) > 0);
+		}
+		size_t first = 1 + listenFds.size();
+		for (size_t i = 0; i < polled.size(); i++) {
+			short revents = fds[first + i].revents;
+			if ((revents & (POLLERR | POLLNVAL)) ||
+					((revents & (POLLIN | POLLHUP)) && !receive(polled[i])) ||
+					((revents & POLLOUT) && !(send(polled[i]) && execute(polled[i])))) {
+				closeConnection(polled[i]);
+			}
+		}
+		for (size_t i = 0; i < listenFds.size(); i++) {
+			if (fds[1 + i].revents & POLLIN) {
+				acceptConnections(listenFds[i]);
+			}
+		}
+	}
+
+	while (!connections.empty()) {
+		closeConnection(connections.front());
+	}
+	for (size_t i = 0; i < listenFds.size(); i++) {
+		close(listenFds[i]);
+	}
+	listenFds.clear();
+	unlink(socketPath.c_str());
 }
 
+void vmi::RpcServer::acceptConnections(int listenFd){
+	int fd;
+	while ((fd = accept4(listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+		Connection *connection = new Connection();
+		connection->fd = fd;
+		connection->outputOffset = 0;
+		connections.push_back(connection);
+	}
+}
+
+bool vmi::RpcServer::receive(Connection *connection){
+	size_t used = connection->input.size();
+	connection->input.resize(used + RPC_RECEIVE_SIZE);
+	ssize_t received = recv(connection->fd, &connection->input[used], RPC_RECEIVE_SIZE, MSG_DONTWAIT);
+	connection->input.resize(used + ((received > 0) ? received : 0));
+	if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+		return false;
+	}
+	return execute(connection);
+}
 
-std::string vmi::RpcServer::runDetectionModule(std::string detectionModuleName){
-	BufferNotificationModule buffer;
-	DetectionModule * module = DetectionModule::getDetectionModule(detectionModuleName);
-	if (module == NULL) {
-		return "Detection Module not found\n";
-	} else {
-		module->start();
-		module->join();
+bool vmi::RpcServer::execute(Connection *connection){
+	// Requests are decoded in place.
+	size_t offset = 0;
+	while (connection->input.size() - offset >= sizeof(rpcFrameHeader) &&
+			connection->output.size() < RPC_MAX_PENDING) {
+		rpcFrameHeader header;
+		memcpy(&header, connection->input.data() + offset, sizeof(header));
+		uint32_t length = ntohl(header.length);
+		if (length > VMIIDS_RPC_MAX_FRAME - sizeof(rpcFrameHeader)) {
+			return false;
+		}
+		if (connection->input.size() - offset - sizeof(rpcFrameHeader) < length) {
+			break;
+		}
+
+		RpcDecoder arguments(connection->input.data() + offset + sizeof(rpcFrameHeader), length);
+		RpcEncoder result;
+		uint16_t function = ntohs(header.function);
+		uint8_t status = (header.version == VMIIDS_RPC_VERSION) ?
+				dispatchRPC(function, arguments, result) : (uint8_t) RPC_ERROR_VERSION;
+		if (status != RPC_OK) {
+			result = RpcEncoder();
+		}
+		result.finish(ntohl(header.requestId), function, status);
+		// Hand the reply over without copying it.
+		connection->output.push_back(std::string());
+		connection->output.back().swap(result.getBuffer());
+		offset += sizeof(rpcFrameHeader) + length;
+	}
+	connection->input.erase(0, offset);
+	return send(connection);
+}
+
+bool vmi::RpcServer::send(Connection *connection){
+	while (!connection->output.empty()) {
+		struct iovec vectors[RPC_SEND_VECTORS];
+		int count = 0;
+		for (std::deque<std::string>::iterator it = connection->output.begin();
+				it != connection->output.end() && count < RPC_SEND_VECTORS; ++it, ++count) {
+			size_t skip = (count == 0) ? connection->outputOffset : 0;
+			vectors[count].iov_base = (void *) (it->data() + skip);
+			vectors[count].iov_len = it->size() - skip;
+		}
+		struct msghdr message;
+		memset(&message, 0, sizeof(message));
+		message.msg_iov = vectors;
+		message.msg_iovlen = count;
+		ssize_t sent = sendmsg(connection->fd, &message, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (sent < 0) {
+			return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+		}
+		size_t remaining = sent;
+		while (!connection->output.empty() &&
+				connection->output.front().size() - connection->outputOffset <= remaining) {
+			remaining -= connection->output.front().size() - connection->outputOffset;
+			connection->output.pop_front();
+			connection->outputOffset = 0;
+		}
+		connection->outputOffset += remaining;
+		if (remaining > 0) {
+			// The socket buffer is full.
+			return true;
+		}
+	}
+	return true;
+}
+
+void vmi::RpcServer::closeConnection(Connection *connection){
+	connections.remove(connection);
+	close(connection->fd);
+	delete connection;
+}
+
+bool vmi::RpcServer::evictJobs(){
+	time_t now = time(NULL);
+	std::map<uint32_t, DetectionJob *>::iterator oldest = jobs.end();
+	for (std::map<uint32_t, DetectionJob *>::iterator it = jobs.begin(); it != jobs.end();) {
+		if (!it->second->isFinished()) {
+			++it;
+			continue;
+		}
+		if (now - it->second->finished >= RPC_JOB_RETENTION) {
+			// Result was never fetched.
+			delete it->second;
+			jobs.erase(it++);
+			continue;
+		}
+		if (oldest == jobs.end() || it->second->finished < oldest->second->finished) {
+			oldest = it;
+		}
+		++it;
+	}
+	if (jobs.size() < RPC_MAX_JOBS) {
+		return true;
+	}
+	if (oldest == jobs.end()) {
+		return false;
+	}
+	delete oldest->second;
+	jobs.erase(oldest);
+	return true;
+}
+
+uint32_t vmi::RpcServer::submitDetectionModule(std::string detectionModuleName){
+	if (!running) {
+		return 0;
+	}
+	if (!DetectionModule::isDetectionModule(detectionModuleName)) {
+		return 0;
+	}
+	DetectionJob *job;
+	uint32_t jobId;
+	{
+		vmi::MutexLocker lock(&jobMutex);
+		if (!evictJobs()) {
+			// All jobs are pending or running.
+			return 0;
+		}
+		if (++lastJobId == 0) ++lastJobId;
+		jobId = lastJobId;
+		job = new DetectionJob(detectionModuleName);
+		jobs[jobId] = job;
+	}
+	workers.submit(job);
+	return jobId;
+}
+
+int vmi::RpcServer::getJobResult(uint32_t jobId, std::string &output){
+	vmi::MutexLocker lock(&jobMutex);
+	std::map<uint32_t, DetectionJob *>::iterator it = jobs.find(jobId);
+	if (it == jobs.end()) {
+		return JOB_UNKNOWN;
+	}
+	DetectionJob *job = it->second;
+	int state = job->state;
+	__sync_synchronize();
+	job->collect(output);
+	if (state == JOB_FINISHED || state == JOB_FAILED) {
+		jobs.erase(it);
+		delete job;
+	}
+	return state;
+}
+
+/**
+ * Encode the runtime counters of a module or schedule as rpcRuntimeStatus.
+ */
+static void encodeRuntimeStatus(vmi::RpcEncoder &result, const vmi::RuntimeStatistics &statistics) {
+	vmi::RuntimeStatistics::Snapshot snapshot;
+	statistics.getSnapshot(snapshot);
+	result.putUInt32(snapshot.runs);
+	result.putUInt32(snapshot.failures);
+	result.putUInt32(snapshot.waiting);
+	result.putUInt32(snapshot.running);
+	result.putUInt64(snapshot.last);
+	result.putUInt64(snapshot.average);
+	result.putUInt64(snapshot.p99);
+	result.putUInt64(snapshot.lastStart);
+	result.putUInt64(snapshot.lastEnd);
+}
+
+void vmi::RpcServer::getStatus(RpcEncoder &result) {
+	result.putUInt64(RuntimeStatistics::now());
+	result.putFloat(ThreatLevelService::getGlobalThreatLevel());
+
+	{
+		// Removed schedules are not deleted, while the reader exists.
+		SnapshotRegistry<uint32_t, DetectionThread>::Reader reader(VmiIDS::getSchedules());
+		const SnapshotRegistry<uint32_t, DetectionThread>::Entries &schedules = reader.getEntries();
+		result.putUInt32(schedules.size());
+		for (SnapshotRegistry<uint32_t, DetectionThread>::Entries::const_iterator it = schedules.begin();
+				it != schedules.end(); ++it) {
+			DetectionThread *schedule = it->second;
+			result.putUInt32(it->first);
+			result.putUInt64((uint64_t) schedule->getNextRun() * 1000000);
+			result.putFloat(ThreatLevelService::getScheduleThreatLevel(it->first));
+			result.putUInt32(schedule->getOverrunCount());
+			result.putUInt32(schedule->isPaused());
+			encodeRuntimeStatus(result, schedule->getStatistics());
+			std::vector<std::string> modules = schedule->getModuleNames();
+			result.putUInt32(modules.size());
+			for (size_t i = 0; i < modules.size(); i++) {
+				result.putString(modules[i]);
+			}
+		}
+	}
+
+	// Unloading a module waits for the reader to finish, so the module pointers stay valid.
+	SnapshotRegistry<std::string, DetectionModule>::Reader reader(DetectionModule::getRegistry());
+	const SnapshotRegistry<std::string, DetectionModule>::Entries &modules = reader.getEntries();
+	result.putUInt32(modules.size());
+	for (SnapshotRegistry<std::string, DetectionModule>::Entries::const_iterator it = modules.begin();
+			it != modules.end(); ++it) {
+		float threatLevel = 0;
+		uint64_t time = 0;
+		bool reported = ThreatLevelService::getModuleThreatLevel(it->second->getHandle(), threatLevel, time);
+		result.putString(it->first);
+		result.putUInt32(reported);
+		result.putFloat(threatLevel);
+		result.putUInt64(time);
+		encodeRuntimeStatus(result, it->second->getStatistics());
+	}
+
+	std::list<std::string> sensors = SensorModule::getListOfSensorModules();
+	result.putUInt32(sensors.size());
+	for (std::list<std::string>::iterator it = sensors.begin(); it != sensors.end(); ++it) {
+		result.putString(*it);
 	}
-	return buffer.getBuffer();
 }
 
 void * vmi::RpcServer::stopIDSThreadFunction(void * nothing) {
@@ -88,123 +567,122 @@ void * vmi::RpcServer::stopIDSThreadFunction(void * nothing) {
 	return NULL;
 }
 
-void vmi::RpcServer::dispatchRPC(struct svc_req *rqstp, register SVCXPRT *transp){
-	union {
-		const char *char_arg;
-		rpcArgumentStringInt argumentSI;
-	} argument;
-	char *result;
-	static bool_t retbool;
-	static char * returnStringMemory = 0;
-
+uint8_t vmi::RpcServer::dispatchRPC(uint16_t function, RpcDecoder &arguments, RpcEncoder &result){
+	std::string string;
+	uint32_t integer;
+	uint32_t value;
+	uint32_t count;
 	std::list<std::string> detectionModules;
-	std::stringstream string;
-
-	std::string returnString;
-	xdrproc_t _xdr_argument, _xdr_result;
-
-	memset ((char *)&argument, 0, sizeof (argument));
-
-	switch (rqstp->rq_proc) {
-	case NULLPROC:
-		(void) svc_sendreply (transp, (xdrproc_t) xdr_void, (char *)NULL);
-		return;
+	std::set<std::string> moduleSet;
+	size_t position;
 
+	switch (function) {
 	case ENQUEUEDETECTIONMODULE:
-		_xdr_argument = (xdrproc_t) xdr_rpcArgumentStringInt;
-		_xdr_result = (xdrproc_t) xdr_bool;
-		if (!svc_getargs (transp, (xdrproc_t) _xdr_argument, (caddr_t) &argument)) {
-			svcerr_decode (transp);
-			return;
+		if (!arguments.getString(string) || !arguments.getUInt32(integer)) {
+			return RPC_ERROR_ARGUMENT;
 		}
-		retbool	= VmiIDS::getInstance()->enqueueDetectionModule(argument.argumentSI.string, argument.argumentSI.integer);
-		result = (char*) &retbool;
+		result.putUInt32(VmiIDS::getInstance()->enqueueDetectionModule(string, integer));
 		break;
 
 	case DEQUEUEDETECTIONMODULE:
-		_xdr_argument = (xdrproc_t) xdr_rpcArgumentStringInt;
-		_xdr_result = (xdrproc_t) xdr_bool;
-		if (!svc_getargs (transp, (xdrproc_t) _xdr_argument, (caddr_t) &argument)) {
-			svcerr_decode (transp);
-			return;
+		if (!arguments.getString(string) || !arguments.getUInt32(integer)) {
+			return RPC_ERROR_ARGUMENT;
 		}
-		retbool = VmiIDS::getInstance()->dequeueDetectionModule(argument.argumentSI.string, argument.argumentSI.integer);
-		result = (char*) &retbool;
+		result.putUInt32(VmiIDS::getInstance()->dequeueDetectionModule(string, integer));
 		break;
 
 	case RUNDETECTIONMODULE:
-		_xdr_argument = (xdrproc_t) xdr_wrapstring;
-		_xdr_result = (xdrproc_t) xdr_wrapstring;
-		if (!svc_getargs (transp, (xdrproc_t) _xdr_argument, (caddr_t) &argument)) {
-			svcerr_decode (transp);
-			return;
+		if (!arguments.getString(string)) {
+			return RPC_ERROR_ARGUMENT;
 		}
-		returnString = this_p->runDetectionModule(argument.char_arg).c_str();
-		if(returnStringMemory != NULL) free(returnStringMemory);
-		returnStringMemory = (char *) malloc(returnString.length() + 1);
-		memset(returnStringMemory, 0, returnString.length() + 1);
-		memmove(returnStringMemory,returnString.c_str(), returnString.length());
-		result = (char*) &returnStringMemory;
+		result.putUInt32(submitDetectionModule(string));
+		break;
+
+	case GETJOBRESULT:
+		if (!arguments.getUInt32(integer)) {
+			return RPC_ERROR_ARGUMENT;
+		}
+		position = result.beginString();
+		// The output is appended to the reply directly.
+		integer = getJobResult(integer, result.getBuffer());
+		result.endString(position);
+		result.putUInt32(integer);
 		break;
 
 	case STOPIDS:
-		_xdr_argument = (xdrproc_t) xdr_int;
-		_xdr_result = (xdrproc_t) xdr_int;
-		if (!svc_getargs (transp, (xdrproc_t) _xdr_argument, (caddr_t) &argument)) {
-			svcerr_decode (transp);
-			return;
+		if (!arguments.getUInt32(integer)) {
+			return RPC_ERROR_ARGUMENT;
 		}
 		pthread_t killThread;
 		pthread_create(&killThread, NULL, &stopIDSThreadFunction, NULL);
-		retbool = true;
-		result = (char*) &retbool;
+		result.putUInt32(true);
 		break;
 
 	case LOADSHAREDOBJECT:
-		_xdr_argument = (xdrproc_t) xdr_wrapstring;
-		_xdr_result = (xdrproc_t) xdr_bool;
-		if (!svc_getargs (transp, (xdrproc_t) _xdr_argument, (caddr_t) &argument)) {
-			svcerr_decode (transp);
-			return;
+		if (!arguments.getString(string)) {
+			return RPC_ERROR_ARGUMENT;
 		}
-		retbool = VmiIDS::getInstance()->loadSharedObject(argument.char_arg);
-		result = (char*) &retbool;
+		result.putUInt32(VmiIDS::getInstance()->loadSharedObject(string));
 		break;
 
 	case GETDETECTIONMODULELIST:
-		_xdr_argument = (xdrproc_t) xdr_void;
-		_xdr_result = (xdrproc_t) xdr_wrapstring;
-		if (!svc_getargs (transp, (xdrproc_t) _xdr_argument, (caddr_t) &argument)) {
-			svcerr_decode (transp);
-			return;
-		}
 		detectionModules = vmi::DetectionModule::getListOfDetectionModules();
+		result.putUInt32(detectionModules.size());
 		while (!detectionModules.empty()){
-			string << detectionModules.front() << std::endl;
+			result.putString(detectionModules.front());
 			detectionModules.pop_front();
 		}
-		returnString = string.str();
-		if(returnStringMemory != NULL) free(returnStringMemory);
-		returnStringMemory = (char *) malloc(returnString.length() + 1);
-		memset(returnStringMemory, 0, returnString.length() + 1);
-		memmove(returnStringMemory,returnString.c_str(), returnString.length());
-		result = (char*) &returnStringMemory;
 		break;
 
-	default:
-		svcerr_noproc (transp);
-		return;
-	}
-	if (result != NULL && !svc_sendreply(transp, (xdrproc_t) _xdr_result, result)) {
-		svcerr_systemerr (transp);
-	}
-	if (!svc_freeargs (transp, (xdrproc_t) _xdr_argument, (caddr_t) &argument)) {
-		fprintf (stderr, "%s", "unable to free arguments");
-		return;
-	}
+	case GETTHREATLEVEL:
+		result.putString(vmi::ThreatLevelService::getReport());
+		break;
 
-	//if (!simp_prog_1_freeresult (transp, _xdr_result, (caddr_t) &result))
-	//	fprintf (stderr, "%s", "unable to free results");
+	case GETSTATUS:
+		getStatus(result);
+		break;
 
-	return;
+	case ADDSCHEDULE:
+		if (!arguments.getUInt32(integer) || !arguments.getUInt32(value) || !arguments.getUInt32(count)) {
+			return RPC_ERROR_ARGUMENT;
+		}
+		for (uint32_t i = 0; i < count; i++) {
+			if (!arguments.getString(string)) {
+				return RPC_ERROR_ARGUMENT;
+			}
+			moduleSet.insert(string);
+		}
+		result.putUInt32(VmiIDS::getInstance()->addSchedule(integer, moduleSet, value));
+		break;
+
+	case REMOVESCHEDULE:
+		if (!arguments.getUInt32(integer)) {
+			return RPC_ERROR_ARGUMENT;
+		}
+		result.putUInt32(VmiIDS::getInstance()->removeSchedule(integer));
+		break;
+
+	case RETIMESCHEDULE:
+		if (!arguments.getUInt32(integer) || !arguments.getUInt32(value)) {
+			return RPC_ERROR_ARGUMENT;
+		}
+		result.putUInt32(VmiIDS::getInstance()->retimeSchedule(integer, value));
+		break;
+
+	case PAUSESCHEDULE:
+		if (!arguments.getUInt32(integer) || !arguments.getUInt32(value)) {
+			return RPC_ERROR_ARGUMENT;
+		}
+		result.putUInt32(VmiIDS::getInstance()->pauseSchedule(integer, value));
+		break;
+
+	case RELOADCONFIG:
+		VmiIDS::requestReload();
+		result.putUInt32(true);
+		break;
+
+	default:
+		return RPC_ERROR_FUNCTION;
+	}
+	return RPC_OK;
 }
@@ -9,9 +9,21 @@
 #define RCPSERVER_H_
 
 #include "vmiids/util/Thread.h"
+#include "vmiids/util/ThreadPool.h"
 
 #include "vmiids/rpc/RpcCommon.h"
 
+#include <deque>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#define RPC_WORKER_THREADS 4  //!< Number of threads executing long running rpc requests.
+#define RPC_MAX_JOBS       64  //!< Maximum number of jobs kept by the rpc server.
+#define RPC_JOB_RETENTION  300 //!< Time (in s) the result of a finished job is kept, if it is not fetched.
+#define RPC_MAX_PENDING    64  //!< Maximum number of unsent replies per connection. Further requests are not read.
+
 namespace vmi{
 
 /**
@@ -19,25 +31,119 @@ namespace vmi{
  *
  * This class provides rpc server functionality.
  *
- * It is a independent thread handling all rpc requests.
+ * It is a independent thread handling all rpc requests. Clients connect to a UNIX socket
+ * (rpc.socketPath, default VMIIDS_RPC_SOCKET) or, if rpc.tcpPort is set, to a TCP socket.
+ * The rpc server does not depend on the portmapper. As LOADSHAREDOBJECT loads code into the
+ * framework, the UNIX socket is created with mode 0600 in a directory with mode 0700.
+ *
+ * Requests and replies are length-prefixed frames (see rpcFrameHeader). The thread multiplexes
+ * all connections with poll(). It decodes the requests directly from the receive buffer and
+ * executes the requests of a connection in order, so a client may pipeline requests. Each reply
+ * is built as a single buffer including its header and sent with sendmsg() without further copies.
+ * Pending replies of a connection are passed to one sendmsg() call (RPC_SEND_VECTORS).
+ * A client, which does not read its replies, is not read from anymore (RPC_MAX_PENDING).
  *
- * Requests are processed in the dispatchRPC() function.
+ * Requests are processed in the dispatchRPC() function. Each request uses its own result
+ * storage. Management requests are answered directly. Long running requests (detection runs)
+ * are passed as jobs to a pool of worker threads. The request returns a job ID immediately,
+ * the result is fetched with GETJOBRESULT. Thus a detection run does not block other clients.
+ *
+ * GETJOBRESULT returns the output produced since the previous call, so clients can stream
+ * the output of a running job. The job table is bounded: Results, which are not fetched,
+ * are dropped after RPC_JOB_RETENTION seconds, or earlier if the table is full.
  */
 class RpcServer{
 private:
+	/**
+	 * Client connected to the rpc server.
+	 */
+	struct Connection {
+		int fd;                          //!< Connected socket.
+		std::string input;               //!< Received data, which does not form a complete frame yet.
+		std::deque<std::string> output;  //!< Reply frames not sent yet.
+		size_t outputOffset;             //!< Bytes of the first reply frame already sent.
+	};
+
 	static RpcServer* this_p; //!< Instance of the rpc server class (Singleton)
-	pthread_t rpcThread;      //!< Mutex to exeute one request at a time.
+	pthread_t rpcThread;      //!< Thread receiving the rpc requests.
+	volatile bool running;    //!< False, when the rpc thread should stop.
+	bool stopped;             //!< True, once stop() has joined the rpc thread and the workers.
+	int wakeFds[2];           //!< Pipe waking up the rpc thread.
+	std::vector<int> listenFds;  //!< Listening sockets.
+	std::string socketPath;   //!< Path of the UNIX socket.
+	std::list<Connection *> connections;  //!< Connected clients. Only accessed by the rpc thread.
 
-	void run(void);   //!< This function containes the main function created by the "rpcgen" tool.
+	class DetectionJob;
+	vmi::ThreadPool workers;  //!< Workers executing jobs.
+	std::map<uint32_t, DetectionJob *> jobs;  //!< Submitted jobs by job ID.
+	pthread_mutex_t jobMutex; //!< Mutex protecting the jobs map.
+	uint32_t lastJobId;       //!< Last job ID assigned.
+
+	void run(void);   //!< Main loop of the rpc thread.
 	static void* __runThread(void* ptr);  //!< This function starts the thread (as pthread threads need a C function to start)
 
 	/**
-	 * Execute a DetectionModule once and return its output.
+	 * Create the listening sockets as configured in the rpc setting.
+	 * @return False, if the UNIX socket could not be created.
+	 */
+	bool openListeners();
+	/**
+	 * Accept all pending connections of a listening socket.
+	 */
+	void acceptConnections(int listenFd);
+	/**
+	 * Read from a connection and execute all complete requests.
+	 * @return False, if the connection has to be closed.
+	 */
+	bool receive(Connection *connection);
+	/**
+	 * Execute the complete requests received, as long as less than RPC_MAX_PENDING
+	 * replies are pending, and send the replies.
+	 * @return False, if the connection has to be closed.
+	 */
+	bool execute(Connection *connection);
+	/**
+	 * Send pending replies without blocking.
+	 * @return False, if the connection has to be closed.
+	 */
+	bool send(Connection *connection);
+	/**
+	 * Close and remove a connection.
+	 */
+	void closeConnection(Connection *connection);
+
+	/**
+	 * Drop finished jobs, whose results were not fetched in time.
+	 * If the table is still full, the oldest finished job is dropped.
+	 * Must be called with the jobMutex held.
+	 *
+	 * @return True, if another job can be added.
+	 */
+	bool evictJobs();
+	/**
+	 * Submit a job executing a DetectionModule once.
 	 *
 	 * @param detectionModuleName Name of the DetectionModule to execute.
-	 * @return Output of the DetectionModule run.
+	 * @return Job ID. Zero, if the DetectionModule is neither loaded nor registered or too many jobs are running.
+	 *         A registered module is constructed by the job.
+	 */
+	uint32_t submitDetectionModule(std::string detectionModuleName);
+	/**
+	 * Request the state and output of a job.
+	 * Once a finished job has been fetched, it is removed and its ID becomes unknown.
+	 *
+	 * @param jobId ID of the job.
+	 * @param output String to append the output to, which the job produced since the last request.
+	 * @return State of the job. See eJobState.
+	 */
+	int getJobResult(uint32_t jobId, std::string &output);
+	/**
+	 * Encode a snapshot of all schedules, DetectionModules and SensorModules.
+	 * Only the module list of each schedule is copied under a lock.
+	 *
+	 * @param result Encoder to append the rpcStatus to.
 	 */
-	std::string runDetectionModule(std::string detectionModuleName);
+	void getStatus(RpcEncoder &result);
 	/**
 	 * Stop the framework.
 
@@ -48,10 +154,12 @@ private:
 	/**
 	 * Dispatch rpc requests to appropriate functions within the VmiIDS framework.
 	 *
-	 * @param rqstp rpc internal data.
-	 * @param transp rpc internal data.
+	 * @param function Called function. See eRPCFuncs.
+	 * @param arguments Arguments of the request.
+	 * @param result Encoder to append the result to.
+	 * @return Status of the reply. See eRPCStatus.
 	 */
-	static void dispatchRPC(struct svc_req *rqstp, register SVCXPRT *transp);
+	uint8_t dispatchRPC(uint16_t function, RpcDecoder &arguments, RpcEncoder &result);
 
 public:
 	/**
@@ -59,9 +167,16 @@ public:
 	 */
 	RpcServer();
 	/**
-	 * Destructor
+	 * Destructor. Stops the rpc thread and closes all connections.
 	 */
 	virtual ~RpcServer();
+
+	/**
+	 * Stop accepting requests and wait for the rpc thread and all submitted jobs to finish.
+	 * Must be called before the modules are destroyed, as jobs use and construct modules.
+	 * Must not be called by the rpc thread.
+	 */
+	void stop();
 };
 
 };
@@ -0,0 +1,138 @@
+/*
+ * ConfigValue.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#include "ConfigValue.h"
+
+#include "Settings.h"
+
+#include <climits>
+
+namespace vmi {
+
+ConfigValue::ConfigValue(Type type, std::string name) :
+	type(type), name(name), integer(0), real(0) {
+}
+
+ConfigValue::~ConfigValue() {
+	for (size_t i = 0; i < this->elements.size(); i++) {
+		delete this->elements[i];
+	}
+}
+
+const ConfigValue &ConfigValue::operator[](int index) const {
+	if (index < 0 || index >= this->getLength()) {
+		std::stringstream name;
+		name << this->name << "[" << index << "]";
+		throw OptionNotFoundException(name.str());
+	}
+	return *this->elements[index];
+}
+
+const ConfigValue &ConfigValue::operator[](const std::string &name) const {
+	const ConfigValue *option = this->find(name);
+	if (option == NULL) {
+		throw OptionNotFoundException(this->name, name);
+	}
+	return *option;
+}
+
+const ConfigValue *ConfigValue::find(const std::string &name) const {
+	Members::const_iterator it = this->members.find(name);
+	return (it != this->members.end()) ? it->second : NULL;
+}
+
+bool ConfigValue::getInteger(long long &value, long long min, long long max) const {
+	if ((this->type != TypeInt && this->type != TypeInt64) ||
+			this->integer < min || this->integer > max) {
+		return false;
+	}
+	value = this->integer;
+	return true;
+}
+
+bool ConfigValue::getValue(int &value) const {
+	long long integer;
+	if (!this->getInteger(integer, INT_MIN, INT_MAX)) {
+		return false;
+	}
+	value = integer;
+	return true;
+}
+
+bool ConfigValue::getValue(unsigned int &value) const {
+	long long integer;
+	if (!this->getInteger(integer, 0, UINT_MAX)) {
+		return false;
+	}
+	value = integer;
+	return true;
+}
+
+bool ConfigValue::getValue(long long &value) const {
+	return this->getInteger(value, LLONG_MIN, LLONG_MAX);
+}
+
+bool ConfigValue::getValue(unsigned long long &value) const {
+	long long integer;
+	if (!this->getInteger(integer, 0, LLONG_MAX)) {
+		return false;
+	}
+	value = integer;
+	return true;
+}
+
+bool ConfigValue::getValue(double &value) const {
+	if (this->type == TypeFloat) {
+		value = this->real;
+	} else if (this->type == TypeInt || this->type == TypeInt64) {
+		value = this->integer;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+bool ConfigValue::getValue(float &value) const {
+	double real;
+	if (!this->getValue(real)) {
+		return false;
+	}
+	value = real;
+	return true;
+}
+
+bool ConfigValue::getValue(bool &value) const {
+	if (this->type != TypeBoolean) {
+		return false;
+	}
+	value = this->integer;
+	return true;
+}
+
+bool ConfigValue::getValue(std::string &value) const {
+	if (this->type != TypeString) {
+		return false;
+	}
+	value = this->string;
+	return true;
+}
+
+bool ConfigValue::operator==(const ConfigValue &other) const {
+	if (this->type != other.type || this->name != other.name ||
+			this->integer != other.integer || this->real != other.real ||
+			this->string != other.string || this->elements.size() != other.elements.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < this->elements.size(); i++) {
+		if (*this->elements[i] != *other.elements[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+}
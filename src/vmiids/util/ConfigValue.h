@@ -0,0 +1,142 @@
+/*
+ * ConfigValue.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef CONFIGVALUE_H_
+#define CONFIGVALUE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace vmi {
+
+/**
+ * @class ConfigValue ConfigValue.h "vmiids/util/ConfigValue.h"
+ * @brief Immutable, typed value of the configuration.
+ * @sa Settings
+ *
+ * The Settings class compiles the configuration file into a tree of ConfigValues, when the
+ * file is loaded. Afterwards the tree is never modified, so it is read from any thread without
+ * locking. Scalars are converted once, the options of a group are indexed by name.
+ *
+ * The interface follows libconfig::Setting: getValue() and lookupValue() return false, if the
+ * value is missing or has an incompatible type. Integers are converted to any integer type
+ * they fit in and to floating point types.
+ */
+class ConfigValue {
+public:
+	/**
+	 * Type of a value.
+	 */
+	typedef enum {
+		TypeNone = 0,  //!< Unknown type.
+		TypeInt,       //!< 32 bit integer.
+		TypeInt64,     //!< 64 bit integer.
+		TypeFloat,     //!< Floating point number.
+		TypeString,    //!< String.
+		TypeBoolean,   //!< Boolean.
+		TypeGroup,     //!< Named options.
+		TypeArray,     //!< Scalars of the same type.
+		TypeList,      //!< Values of any type.
+	} Type;
+
+private:
+	typedef std::map<std::string, const ConfigValue *> Members;
+
+	Type type;                                  //!< Type of the value.
+	std::string name;                           //!< Name. Empty for elements of lists and arrays.
+	long long integer;                          //!< Value of integers and booleans.
+	double real;                                //!< Value of floating point numbers.
+	std::string string;                         //!< Value of strings.
+	std::vector<const ConfigValue *> elements;  //!< Elements of aggregates, in file order.
+	Members members;                            //!< Options of a group, indexed by name.
+
+	ConfigValue(const ConfigValue&);
+	ConfigValue& operator=(const ConfigValue&);
+
+	/**
+	 * @return False, if the value is no integer or does not fit into [min, max].
+	 */
+	bool getInteger(long long &value, long long min, long long max) const;
+
+	friend class Settings;
+
+public:
+	/**
+	 * Constructor. Values are set by the Settings class only.
+	 * @param type Type of the value.
+	 * @param name Name of the value.
+	 */
+	ConfigValue(Type type = TypeGroup, std::string name = "");
+	/**
+	 * Destructor. Deletes the elements.
+	 */
+	~ConfigValue();
+
+	/**
+	 * @return Type of the value.
+	 */
+	Type getType() const { return this->type; }
+	/**
+	 * @return Name of the value. Empty for elements of lists and arrays.
+	 */
+	const std::string &getName() const { return this->name; }
+	/**
+	 * @return Number of elements of an aggregate. Zero for scalars.
+	 */
+	int getLength() const { return this->elements.size(); }
+
+	/**
+	 * Access an element of an aggregate.
+	 * Throws an OptionNotFoundException, if the index is out of range.
+	 */
+	const ConfigValue &operator[](int index) const;
+	/**
+	 * Access an option of a group.
+	 * Throws an OptionNotFoundException, if the option does not exist.
+	 */
+	const ConfigValue &operator[](const std::string &name) const;
+	/**
+	 * @return Option of a group. NULL, if the option does not exist.
+	 */
+	const ConfigValue *find(const std::string &name) const;
+	/**
+	 * @return True, if the group contains the option.
+	 */
+	bool exists(const std::string &name) const { return this->find(name) != NULL; }
+
+	bool getValue(int &value) const;                 //!< @return False, if no integer fitting into int.
+	bool getValue(unsigned int &value) const;        //!< @return False, if no integer fitting into unsigned int.
+	bool getValue(long long &value) const;           //!< @return False, if no integer.
+	bool getValue(unsigned long long &value) const;  //!< @return False, if no positive integer.
+	bool getValue(double &value) const;              //!< @return False, if no number.
+	bool getValue(float &value) const;               //!< @return False, if no number.
+	bool getValue(bool &value) const;                //!< @return False, if no boolean.
+	bool getValue(std::string &value) const;         //!< @return False, if no string.
+
+	/**
+	 * Read an option of a group.
+	 * @param name Name of the option.
+	 * @param value Receives the value. Untouched, if the option is missing or has another type.
+	 * @return True, if value was set.
+	 */
+	template <class T>
+	bool lookupValue(const std::string &name, T &value) const {
+		const ConfigValue *option = this->find(name);
+		return option != NULL && option->getValue(value);
+	}
+
+	/**
+	 * Compare two values including their elements.
+	 */
+	bool operator==(const ConfigValue &other) const;
+	bool operator!=(const ConfigValue &other) const { return !(*this == other); }
+};
+
+}
+
+#endif /* CONFIGVALUE_H_ */
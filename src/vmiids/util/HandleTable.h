@@ -0,0 +1,166 @@
+/*
+ * HandleTable.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef HANDLETABLE_H_
+#define HANDLETABLE_H_
+
+#include "Mutex.h"
+#include "MutexLocker.h"
+
+#include <stdint.h>
+#include <cstddef>
+
+#define HANDLETABLE_CAPACITY 256   //!< Default number of slots of a HandleTable.
+
+namespace vmi {
+
+/**
+ * @class Handle HandleTable.h "vmiids/util/HandleTable.h"
+ * @brief Stable reference to an object registered in a HandleTable.
+ * @sa HandleTable
+ *
+ * A handle consists of the slot of the object and the generation of the slot at the time
+ * the object was registered. When the object is released, the generation of the slot changes
+ * and all handles to it become stale. Handles are plain values and may be copied freely.
+ */
+template <class T>
+class Handle {
+public:
+	uint32_t index;       //!< Slot in the HandleTable.
+	uint32_t generation;  //!< Generation of the slot. Zero for invalid handles.
+
+	/**
+	 * Constructor. Creates an invalid handle.
+	 */
+	Handle() : index(0), generation(0) {}
+	/**
+	 * Constructor
+	 * @param index Slot in the HandleTable.
+	 * @param generation Generation of the slot.
+	 */
+	Handle(uint32_t index, uint32_t generation) : index(index), generation(generation) {}
+
+	/**
+	 * @return True, if the handle was assigned by a HandleTable. It may be stale nevertheless.
+	 */
+	bool isValid() const { return generation != 0; }
+
+	bool operator==(const Handle &other) const {
+		return index == other.index && generation == other.generation;
+	}
+	bool operator!=(const Handle &other) const {
+		return !(*this == other);
+	}
+	bool operator<(const Handle &other) const {
+		return index < other.index || (index == other.index && generation < other.generation);
+	}
+};
+
+/**
+ * @class HandleTable HandleTable.h "vmiids/util/HandleTable.h"
+ * @brief Fixed size table mapping handles to objects.
+ * @sa Handle
+ *
+ * Objects are registered with acquire() and receive a Handle. resolve() maps a handle back
+ * to the object without locking and without comparing names. It returns NULL, if the object
+ * has been released in the meantime, so stale handles are detected with a single compare.
+ * resolve() does not keep the object alive. The owner of the table must make sure an object is
+ * not deleted while it is used (see DetectionModule::pin()).
+ * A slot is reused after its object has been released, but with a new generation.
+ *
+ * acquire() and release() are serialized by a mutex.
+ */
+template <class T, size_t Capacity = HANDLETABLE_CAPACITY>
+class HandleTable {
+private:
+	/**
+	 * Slot of the table.
+	 */
+	struct Slot {
+		T * volatile object;            //!< Registered object. NULL, if the slot is free.
+		volatile uint32_t generation;   //!< Generation of the slot. Changes on every release.
+	};
+
+	Slot slots[Capacity];   //!< Slots of the table.
+	vmi::Mutex mutex;       //!< Serializes acquire() and release().
+
+	HandleTable(const HandleTable&);
+	HandleTable& operator=(const HandleTable&);
+
+	/**
+	 * @return Next generation of a slot. Never zero.
+	 */
+	static uint32_t nextGeneration(uint32_t generation){
+		return (generation + 1 != 0) ? generation + 1 : 1;
+	}
+
+public:
+	/**
+	 * Constructor. Creates an empty table.
+	 */
+	HandleTable(){
+		for (size_t i = 0; i < Capacity; i++) {
+			slots[i].object = NULL;
+			slots[i].generation = 1;
+		}
+	}
+
+	/**
+	 * Register an object.
+	 * @param object Object to register.
+	 * @return Handle of the object. Invalid, if the table is full.
+	 */
+	Handle<T> acquire(T *object){
+		vmi::MutexLocker lock(&mutex);
+		for (size_t i = 0; i < Capacity; i++) {
+			if (slots[i].object == NULL) {
+				slots[i].object = object;
+				__sync_synchronize();
+				return Handle<T>(i, slots[i].generation);
+			}
+		}
+		return Handle<T>();
+	}
+
+	/**
+	 * Unregister an object. All handles to it become stale.
+	 * @param handle Handle of the object.
+	 */
+	void release(const Handle<T> &handle){
+		vmi::MutexLocker lock(&mutex);
+		if (!handle.isValid() || handle.index >= Capacity ||
+				slots[handle.index].generation != handle.generation) {
+			return;
+		}
+		// Invalidate the handles first, readers check the generation after reading the object.
+		slots[handle.index].generation = nextGeneration(handle.generation);
+		__sync_synchronize();
+		slots[handle.index].object = NULL;
+	}
+
+	/**
+	 * Map a handle to its object. Lock-free. The object may be released right after the call.
+	 * @param handle Handle to resolve.
+	 * @return Object. NULL, if the handle is invalid or stale.
+	 */
+	T *resolve(const Handle<T> &handle) const {
+		if (handle.index >= Capacity) {
+			return NULL;
+		}
+		const Slot &slot = slots[handle.index];
+		T *object = slot.object;
+		__sync_synchronize();
+		if (slot.generation != handle.generation) {
+			return NULL;
+		}
+		return object;
+	}
+};
+
+}
+
+#endif /* HANDLETABLE_H_ */
@@ -0,0 +1,117 @@
+/*
+ * MappedFile.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace vmi {
+
+/**
+ * @class MappedFile MappedFile.h "vmiids/util/MappedFile.h"
+ * @brief Read only memory mapped file.
+ * @sa MultiPatternMatcher
+ *
+ * Convenience class for mmap. The file is mapped read only into the address space of the process.
+ * Its contents can then be scanned without copying them into a separate buffer.
+ * The mapping is automatically released when the MappedFile instance is destroyed.
+ */
+class MappedFile {
+private:
+	int fd;              //!< File descriptor of the mapped file.
+	const char * data;   //!< Start of the mapping.
+	size_t length;       //!< Length of the mapping.
+
+	/**
+	 * Private copy constructor. A mapping must only be released once.
+	 */
+	MappedFile(const MappedFile&);
+	/**
+	 * Private copy operator. A mapping must only be released once.
+	 */
+	MappedFile& operator=(const MappedFile&);
+
+public:
+	/**
+	 * Constructor. No file is mapped.
+	 */
+	MappedFile(){
+		fd = -1;
+		data = NULL;
+		length = 0;
+	}
+	/**
+	 * Destructor. Releases the mapping.
+	 */
+	virtual ~MappedFile(){
+		close();
+	}
+
+	/**
+	 * Map the file fileName into memory. A previous mapping is released.
+	 *
+	 * @param fileName File to map.
+	 * @return True, if the file could be opened. Empty files are opened, but not mapped.
+	 */
+	bool open(const std::string &fileName){
+		struct stat fileInfo;
+		close();
+		if ((fd = ::open(fileName.c_str(), O_RDONLY)) < 0) {
+			return false;
+		}
+		if (fstat(fd, &fileInfo) < 0 || !S_ISREG(fileInfo.st_mode)) {
+			close();
+			return false;
+		}
+		length = fileInfo.st_size;
+		if (length == 0) {
+			return true;
+		}
+		void * mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping == MAP_FAILED) {
+			close();
+			return false;
+		}
+		madvise(mapping, length, MADV_SEQUENTIAL);
+		data = (const char *) mapping;
+		return true;
+	}
+
+	/**
+	 * Release the mapping and close the file.
+	 */
+	void close(){
+		if (data != NULL) munmap((void *) data, length);
+		if (fd >= 0) ::close(fd);
+		fd = -1;
+		data = NULL;
+		length = 0;
+	}
+
+	/**
+	 * @return True, if a file is currently opened.
+	 */
+	bool isOpen() const { return fd >= 0; }
+	/**
+	 * @return Start of the mapped file contents. NULL, if the file is empty or not mapped.
+	 */
+	const char * getData() const { return data; }
+	/**
+	 * @return Size of the mapped file contents.
+	 */
+	size_t getSize() const { return length; }
+};
+
+}
+
+#endif /* MAPPEDFILE_H_ */
@@ -0,0 +1,105 @@
+/*
+ * MpscQueue.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef MPSCQUEUE_H_
+#define MPSCQUEUE_H_
+
+#include <cstddef>
+
+namespace vmi {
+
+/**
+ * @class MpscQueue MpscQueue.h "vmiids/util/MpscQueue.h"
+ * @brief Lock-free multiple producer, single consumer queue.
+ *
+ * Intrusive queue after Dmitry Vyukov. The queued type T must contain a member
+ * <code>T * volatile next</code>, which is owned by the queue while the element is enqueued.
+ * The queue does not take ownership of the elements.
+ *
+ * push() may be called by any number of threads concurrently and never blocks.
+ * It consists of a single atomic exchange. pop() must only be called by one thread at a time.
+ *
+ * pop() may return NULL, while a push() is in progress in another thread,
+ * even though the queue is not empty. The consumer simply retries later.
+ */
+template <class T>
+class MpscQueue {
+private:
+	T * volatile head;  //!< Last element pushed. Written by the producers.
+	T * tail;           //!< Next element to pop. Only used by the consumer.
+	T stub;             //!< Placeholder element, so the queue is never empty.
+
+	/**
+	 * Private copy constructor. Elements reference the stub.
+	 */
+	MpscQueue(const MpscQueue&);
+	/**
+	 * Private copy operator. Elements reference the stub.
+	 */
+	MpscQueue& operator=(const MpscQueue&);
+
+public:
+	/**
+	 * Constructor
+	 */
+	MpscQueue(){
+		stub.next = NULL;
+		head = &stub;
+		tail = &stub;
+	}
+	/**
+	 * Destructor
+	 */
+	virtual ~MpscQueue(){}
+
+	/**
+	 * Enqueue an element.
+	 *
+	 * @param element Element to enqueue.
+	 */
+	void push(T *element){
+		element->next = NULL;
+		__sync_synchronize();
+		T *previous = __sync_lock_test_and_set(&head, element);
+		previous->next = element;
+	}
+
+	/**
+	 * Dequeue an element. Must only be called by the consumer.
+	 *
+	 * @return Oldest element. NULL, if the queue is empty.
+	 */
+	T *pop(){
+		T *first = tail;
+		T *next = first->next;
+		if (first == &stub) {
+			if (next == NULL) return NULL;
+			tail = next;
+			first = next;
+			next = next->next;
+		}
+		if (next != NULL) {
+			tail = next;
+			return first;
+		}
+		if (first != head) {
+			// A producer is between the exchange and linking its element.
+			return NULL;
+		}
+		push(&stub);
+		next = first->next;
+		if (next != NULL) {
+			tail = next;
+			return first;
+		}
+		return NULL;
+	}
+};
+
+}
+
+#endif /* MPSCQUEUE_H_ */
@@ -0,0 +1,217 @@
+/*
+ * MultiPatternMatcher.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef MULTIPATTERNMATCHER_H_
+#define MULTIPATTERNMATCHER_H_
+
+#include "vmiids/util/Exception.h"
+
+#include <string>
+#include <vector>
+#include <queue>
+
+#include <stdint.h>
+#include <sys/time.h>
+
+namespace vmi {
+
+/**
+ * @class MultiPatternMatcher MultiPatternMatcher.h "vmiids/util/MultiPatternMatcher.h"
+ * @brief Aho-Corasick string matcher.
+ * @sa MappedFile
+ *
+ * Searches a buffer for many fixed strings at once. Instead of scanning the input once for
+ * every pattern, all patterns are compiled into a single automaton. The input is then scanned
+ * exactly once, independent of the number of patterns. Each input byte costs one table lookup.
+ *
+ * Patterns are added with addPattern(). Afterwards the automaton is built with compile().
+ * Once compiled, scan() may be called concurrently from several threads. scan() never
+ * compiles the automaton itself, it throws a vmi::Exception if compile() was not called.
+ *
+ * The matcher records the amount of data scanned and the time spent, so callers are able to
+ * report the throughput of their scans (see getThroughput()).
+ */
+class MultiPatternMatcher {
+public:
+	/**
+	 * Occurrence of a pattern within the scanned input.
+	 */
+	typedef struct{
+		size_t pattern;  //!< Index of the pattern, as returned by addPattern().
+		size_t offset;   //!< Offset of the first byte of the occurrence.
+	} Match;
+
+private:
+	static const size_t ALPHABET = 256; //!< Number of transitions per state.
+
+	std::vector<std::string> patterns;  //!< Patterns to search for.
+	std::vector<int32_t> transitions;   //!< Transition table. ALPHABET entries per state.
+	std::vector<std::vector<size_t> > outputs;  //!< Patterns ending in each state.
+	bool compiled;  //!< Flag, whether the automaton matches the current patterns.
+
+	volatile uint64_t scannedBytes;    //!< Total number of bytes scanned.
+	volatile uint64_t scanMicroseconds;   //!< Total time spent scanning.
+
+public:
+	/**
+	 * Constructor
+	 */
+	MultiPatternMatcher(){
+		compiled = false;
+		scannedBytes = 0;
+		scanMicroseconds = 0;
+	}
+	/**
+	 * Destructor
+	 */
+	virtual ~MultiPatternMatcher(){}
+
+	/**
+	 * Add a pattern to the matcher. Empty patterns are ignored.
+	 * compile() must be called before the next scan.
+	 *
+	 * @param pattern Pattern to search for.
+	 * @return Index of the pattern. Used to identify the pattern in a Match.
+	 */
+	size_t addPattern(const std::string &pattern){
+		patterns.push_back(pattern);
+		compiled = false;
+		return patterns.size() - 1;
+	}
+
+	/**
+	 * @param index Index of the pattern.
+	 * @return The pattern with the given index.
+	 */
+	const std::string &getPattern(size_t index) const { return patterns[index]; }
+
+	/**
+	 * @return Number of patterns added to the matcher.
+	 */
+	size_t getPatternCount() const { return patterns.size(); }
+
+	/**
+	 * Build the automaton from all patterns added.
+	 */
+	void compile(){
+		transitions.assign(ALPHABET, -1);
+		outputs.assign(1, std::vector<size_t>());
+
+		// Build the trie of all patterns.
+		for (size_t p = 0; p < patterns.size(); p++) {
+			if (patterns[p].empty()) continue;
+			size_t state = 0;
+			for (size_t i = 0; i < patterns[p].size(); i++) {
+				size_t symbol = (unsigned char) patterns[p][i];
+				if (transitions[state * ALPHABET + symbol] < 0) {
+					transitions[state * ALPHABET + symbol] = outputs.size();
+					transitions.resize(transitions.size() + ALPHABET, -1);
+					outputs.push_back(std::vector<size_t>());
+				}
+				state = transitions[state * ALPHABET + symbol];
+			}
+			outputs[state].push_back(p);
+		}
+
+		// Add the failure transitions breadth first. Afterwards every state has a
+		// transition for every symbol, so scanning never follows a failure link.
+		std::vector<size_t> failure(outputs.size(), 0);
+		std::queue<size_t> queue;
+		for (size_t symbol = 0; symbol < ALPHABET; symbol++) {
+			if (transitions[symbol] < 0) {
+				transitions[symbol] = 0;
+			} else {
+				queue.push(transitions[symbol]);
+			}
+		}
+		while (!queue.empty()) {
+			size_t state = queue.front();
+			queue.pop();
+			outputs[state].insert(outputs[state].end(),
+					outputs[failure[state]].begin(), outputs[failure[state]].end());
+			for (size_t symbol = 0; symbol < ALPHABET; symbol++) {
+				int32_t &next = transitions[state * ALPHABET + symbol];
+				if (next < 0) {
+					next = transitions[failure[state] * ALPHABET + symbol];
+				} else {
+					failure[next] = transitions[failure[state] * ALPHABET + symbol];
+					queue.push(next);
+				}
+			}
+		}
+		compiled = true;
+	}
+
+	/**
+	 * Scan a buffer for all patterns.
+	 * Throws a vmi::Exception, if the automaton was not compiled after the last addPattern().
+	 *
+	 * @param data Buffer to scan.
+	 * @param length Length of the buffer.
+	 * @param matches Vector to append every occurrence of a pattern to.
+	 * @return Number of occurrences found.
+	 */
+	size_t scan(const char * data, size_t length, std::vector<Match> &matches){
+		if (!compiled) {
+			throw vmi::Exception("MultiPatternMatcher: scan() called before compile()");
+		}
+
+		struct timeval start, end;
+		gettimeofday(&start, NULL);
+
+		size_t found = 0;
+		size_t state = 0;
+		const int32_t * table = &transitions[0];
+		for (size_t i = 0; i < length; i++) {
+			state = table[state * ALPHABET + (unsigned char) data[i]];
+			if (!outputs[state].empty()) {
+				for (std::vector<size_t>::const_iterator it = outputs[state].begin();
+						it != outputs[state].end(); ++it) {
+					Match match;
+					match.pattern = *it;
+					match.offset = i + 1 - patterns[*it].size();
+					matches.push_back(match);
+					found++;
+				}
+			}
+		}
+
+		gettimeofday(&end, NULL);
+		__sync_fetch_and_add(&scannedBytes, (uint64_t) length);
+		__sync_fetch_and_add(&scanMicroseconds, (uint64_t) ((end.tv_sec - start.tv_sec) * 1000000
+				+ (end.tv_usec - start.tv_usec)));
+		return found;
+	}
+
+	/**
+	 * Scan a string for all patterns.
+	 *
+	 * @param data String to scan.
+	 * @param matches Vector to append every occurrence of a pattern to.
+	 * @return Number of occurrences found.
+	 */
+	size_t scan(const std::string &data, std::vector<Match> &matches){
+		return scan(data.data(), data.size(), matches);
+	}
+
+	/**
+	 * @return Number of bytes scanned since construction.
+	 */
+	uint64_t getScannedBytes() const { return scannedBytes; }
+
+	/**
+	 * @return Throughput of all scans in MB/s. Zero, if nothing was scanned yet.
+	 */
+	double getThroughput() const {
+		if (scanMicroseconds == 0) return 0;
+		return ((double) scannedBytes / (1024 * 1024)) / ((double) scanMicroseconds / 1000000);
+	}
+};
+
+}
+
+#endif /* MULTIPATTERNMATCHER_H_ */
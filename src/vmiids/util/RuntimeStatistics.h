@@ -0,0 +1,174 @@
+/*
+ * RuntimeStatistics.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef RUNTIMESTATISTICS_H_
+#define RUNTIMESTATISTICS_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/time.h>
+
+/**
+ * Number of buckets of the runtime histogram. Four buckets per power of two cover runtimes
+ * of more than an hour (in us).
+ */
+#define RUNTIMESTATISTICS_BUCKETS 128
+
+namespace vmi {
+
+/**
+ * @class RuntimeStatistics RuntimeStatistics.h "vmiids/util/RuntimeStatistics.h"
+ * @brief Lock-free runtime counters of a repeatedly executed task.
+ *
+ * The executing threads update the counters with atomic operations only. getSnapshot()
+ * reads the counters without locking, so it is cheap enough to be polled by monitoring
+ * clients at any rate. A snapshot is not taken atomically: counters updated during the
+ * snapshot may be off by one run.
+ *
+ * Runtimes are kept in a logarithmic histogram with four buckets per power of two.
+ * The percentile of a snapshot is the upper bound of its bucket, so it overestimates the
+ * runtime by at most 25%.
+ */
+class RuntimeStatistics {
+public:
+	/**
+	 * Copy of the counters.
+	 */
+	struct Snapshot {
+		uint32_t runs;         //!< Number of finished runs.
+		uint32_t failures;     //!< Number of runs aborted by an exception.
+		uint32_t waiting;      //!< Number of runs waiting to be executed.
+		uint32_t running;      //!< Number of runs executed right now.
+		uint64_t last;         //!< Runtime of the last run (us).
+		uint64_t average;      //!< Average runtime of all runs (us).
+		uint64_t p99;          //!< 99th percentile of the runtime (us).
+		uint64_t lastStart;    //!< Start of the last run (us since epoch). Zero, if never started.
+		uint64_t lastEnd;      //!< End of the last run (us since epoch). Zero, if never finished.
+	};
+
+private:
+	volatile uint32_t runs;         //!< Number of finished runs.
+	volatile uint32_t failures;     //!< Number of failed runs.
+	volatile uint32_t waiting;      //!< Number of runs waiting to be executed.
+	volatile uint32_t running;      //!< Number of runs executed right now.
+	volatile uint64_t totalTime;    //!< Sum of all runtimes (us).
+	volatile uint64_t lastTime;     //!< Runtime of the last run (us).
+	volatile uint64_t lastStart;    //!< Start of the last run (us since epoch).
+	volatile uint64_t lastEnd;      //!< End of the last run (us since epoch).
+	volatile uint32_t buckets[RUNTIMESTATISTICS_BUCKETS];  //!< Runtime histogram.
+
+	/**
+	 * @return Histogram bucket of a runtime.
+	 */
+	static unsigned int getBucket(uint64_t time){
+		if (time < 4) {
+			return time;
+		}
+		unsigned int msb = 63 - __builtin_clzll(time);
+		unsigned int bucket = 4 + (msb - 2) * 4 + ((time >> (msb - 2)) & 3);
+		return (bucket < RUNTIMESTATISTICS_BUCKETS) ? bucket : RUNTIMESTATISTICS_BUCKETS - 1;
+	}
+
+	/**
+	 * @return Largest runtime falling into a bucket.
+	 */
+	static uint64_t getBucketLimit(unsigned int bucket){
+		if (bucket < 4) {
+			return bucket;
+		}
+		unsigned int msb = (bucket - 4) / 4 + 2;
+		return ((uint64_t) (4 + (bucket & 3) + 1) << (msb - 2)) - 1;
+	}
+
+public:
+	/**
+	 * Constructor. All counters are zero.
+	 */
+	RuntimeStatistics(){
+		memset((void *) this, 0, sizeof(*this));
+	}
+
+	/**
+	 * @return Current time (us since epoch).
+	 */
+	static uint64_t now(){
+		struct timeval time;
+		gettimeofday(&time, NULL);
+		return (uint64_t) time.tv_sec * 1000000 + time.tv_usec;
+	}
+
+	/**
+	 * A run was requested and waits to be executed.
+	 */
+	void enter(){
+		__sync_add_and_fetch(&waiting, 1);
+	}
+
+	/**
+	 * A run, which was announced by enter(), starts.
+	 * @param time Current time (us since epoch).
+	 */
+	void start(uint64_t time){
+		__sync_sub_and_fetch(&waiting, 1);
+		__sync_add_and_fetch(&running, 1);
+		lastStart = time;
+	}
+
+	/**
+	 * A run started by start() has finished.
+	 * @param startTime Time passed to start().
+	 * @param endTime Current time (us since epoch).
+	 * @param failed True, if the run was aborted.
+	 */
+	void finish(uint64_t startTime, uint64_t endTime, bool failed){
+		uint64_t time = (endTime > startTime) ? endTime - startTime : 0;
+		__sync_add_and_fetch(&buckets[getBucket(time)], 1);
+		__sync_add_and_fetch(&totalTime, time);
+		lastTime = time;
+		lastEnd = endTime;
+		if (failed) {
+			__sync_add_and_fetch(&failures, 1);
+		}
+		__sync_add_and_fetch(&runs, 1);
+		__sync_sub_and_fetch(&running, 1);
+	}
+
+	/**
+	 * Read all counters without locking.
+	 * @param snapshot Copy of the counters.
+	 */
+	void getSnapshot(Snapshot &snapshot) const {
+		snapshot.runs = runs;
+		snapshot.failures = failures;
+		snapshot.waiting = waiting;
+		snapshot.running = running;
+		snapshot.last = lastTime;
+		snapshot.lastStart = lastStart;
+		snapshot.lastEnd = lastEnd;
+		snapshot.average = (snapshot.runs > 0) ? totalTime / snapshot.runs : 0;
+
+		uint32_t counts[RUNTIMESTATISTICS_BUCKETS];
+		uint64_t total = 0;
+		for (unsigned int i = 0; i < RUNTIMESTATISTICS_BUCKETS; i++) {
+			counts[i] = buckets[i];
+			total += counts[i];
+		}
+		snapshot.p99 = 0;
+		uint64_t rank = (total * 99 + 99) / 100;
+		for (unsigned int i = 0; i < RUNTIMESTATISTICS_BUCKETS && rank > 0; i++) {
+			if (counts[i] >= rank) {
+				snapshot.p99 = getBucketLimit(i);
+				break;
+			}
+			rank -= counts[i];
+		}
+	}
+};
+
+}
+
+#endif /* RUNTIMESTATISTICS_H_ */
@@ -7,37 +7,184 @@
 
 #include "Settings.h"
 
+#include <libconfig.h++>
+
+#include <sched.h>
+
 namespace vmi {
 
 vmi::Settings* vmi::Settings::instance = NULL;
+const ConfigValue vmi::Settings::emptyGroup;
 
 Settings::Settings() {
+	this->snapshot = new ConfigValue();
+	this->epoch = 0;
+	this->readers[0] = 0;
+	this->readers[1] = 0;
 	if( this->openConfigFile("vmiids.cfg") ||
 			this->openConfigFile("/etc/vmiids.cfg") ){
 	}
 }
 
 Settings::Settings(std::string fileName) {
+	this->snapshot = new ConfigValue();
+	this->epoch = 0;
+	this->readers[0] = 0;
+	this->readers[1] = 0;
 	if(!this->openConfigFile(fileName)) throw ConfigFileException(fileName);
 }
 
 vmi::Settings::~Settings() {
-	// TODO Auto-generated destructor stub
+	delete this->snapshot;
 }
 
-bool Settings::openConfigFile(std::string filename){
+ConfigValue *Settings::compile(const libconfig::Setting &setting, ConfigValue *value){
+	switch (setting.getType()) {
+	case libconfig::Setting::TypeInt:
+		value->type = ConfigValue::TypeInt;
+		value->integer = (int) setting;
+		break;
+	case libconfig::Setting::TypeInt64:
+		value->type = ConfigValue::TypeInt64;
+		value->integer = (long long) setting;
+		break;
+	case libconfig::Setting::TypeFloat:
+		value->type = ConfigValue::TypeFloat;
+		value->real = (double) setting;
+		break;
+	case libconfig::Setting::TypeString:
+		value->type = ConfigValue::TypeString;
+		value->string = (const char *) setting;
+		break;
+	case libconfig::Setting::TypeBoolean:
+		value->type = ConfigValue::TypeBoolean;
+		value->integer = (bool) setting;
+		break;
+	case libconfig::Setting::TypeGroup:
+	case libconfig::Setting::TypeArray:
+	case libconfig::Setting::TypeList:
+		value->type = (setting.getType() == libconfig::Setting::TypeGroup) ? ConfigValue::TypeGroup :
+				(setting.getType() == libconfig::Setting::TypeArray) ? ConfigValue::TypeArray :
+				ConfigValue::TypeList;
+		for (int i = 0; i < setting.getLength(); i++) {
+			const char *name = setting[i].getName();
+			ConfigValue *element = new ConfigValue(ConfigValue::TypeNone, (name != NULL) ? name : "");
+			value->elements.push_back(element);
+			compile(setting[i], element);
+			if (name != NULL) {
+				value->members[name] = element;
+			}
+		}
+		break;
+	default:
+		value->type = ConfigValue::TypeNone;
+		break;
+	}
+	return value;
+}
+
+const ConfigValue *Settings::parseConfigFile(std::string filename){
 	FILE * configFile;
 
 	if( (configFile = fopen (filename.c_str() , "r")) != NULL ){
+		libconfig::Config config;
 		try {
 			config.read(configFile);
 			fclose (configFile);
-			return true;
 		}catch(libconfig::ParseException &e){
-			return false;
+			fclose (configFile);
+			return NULL;
+		}
+		return compile(config.getRoot(), new ConfigValue());
+	}
+	return NULL;
+}
+
+void Settings::replaceSnapshot(const ConfigValue *newSnapshot){
+	const ConfigValue *oldSnapshot = this->snapshot;
+	// The snapshot must be complete, before its pointer becomes visible.
+	__sync_synchronize();
+	this->snapshot = newSnapshot;
+	for (int flip = 0; flip < 2; flip++) {
+		unsigned int slot = this->epoch & 1;
+		__sync_add_and_fetch(&this->epoch, 1);
+		while (this->readers[slot] != 0) {
+			sched_yield();
+		}
+	}
+	delete oldSnapshot;
+}
+
+bool Settings::openConfigFile(std::string filename){
+	const ConfigValue *newSnapshot = parseConfigFile(filename);
+	if (newSnapshot == NULL) {
+		return false;
+	}
+	this->replaceSnapshot(newSnapshot);
+	this->fileName = filename;
+	return true;
+}
+
+bool Settings::reload(ChangedSettings &changes){
+	if (this->fileName.empty()) {
+		return false;
+	}
+	const ConfigValue *newSnapshot = parseConfigFile(this->fileName);
+	if (newSnapshot == NULL) {
+		return false;
+	}
+	diff(*this->snapshot, *newSnapshot, changes);
+	this->replaceSnapshot(newSnapshot);
+	return true;
+}
+
+/**
+ * Collect the names of the options of a group.
+ */
+static void getOptionNames(const ConfigValue &value, std::set<std::string> &options){
+	if (value.getType() == ConfigValue::TypeGroup) {
+		for (int i = 0; i < value.getLength(); i++) {
+			options.insert(value[i].getName());
+		}
+	}
+}
+
+void Settings::diff(const ConfigValue &oldSnapshot, const ConfigValue &newSnapshot,
+		ChangedSettings &changes){
+	for (int i = 0; i < oldSnapshot.getLength(); i++) {
+		const std::string &name = oldSnapshot[i].getName();
+		if (!newSnapshot.exists(name)) {
+			getOptionNames(oldSnapshot[i], changes[name]);
+		}
+	}
+	for (int i = 0; i < newSnapshot.getLength(); i++) {
+		const ConfigValue &newSection = newSnapshot[i];
+		const std::string &name = newSection.getName();
+		const ConfigValue *oldSection = oldSnapshot.find(name);
+		if (oldSection == NULL) {
+			getOptionNames(newSection, changes[name]);
+			continue;
+		}
+		if (*oldSection == newSection) {
+			continue;
+		}
+		std::set<std::string> &options = changes[name];
+		if (oldSection->getType() != ConfigValue::TypeGroup ||
+				newSection.getType() != ConfigValue::TypeGroup) {
+			continue;
+		}
+		// Options, which were added, removed or changed.
+		std::set<std::string> names;
+		getOptionNames(*oldSection, names);
+		getOptionNames(newSection, names);
+		for (std::set<std::string>::iterator it = names.begin(); it != names.end(); ++it) {
+			const ConfigValue *oldOption = oldSection->find(*it);
+			const ConfigValue *newOption = newSection.find(*it);
+			if (oldOption == NULL || newOption == NULL || *oldOption != *newOption) {
+				options.insert(*it);
+			}
 		}
 	}
-	return false;
 }
 
 Settings *Settings::getInstance(){
@@ -46,12 +193,17 @@ Settings *Settings::getInstance(){
 	return instance;
 }
 
-libconfig::Setting &Settings::getSetting(std::string settingName){
-	try {
-		return this->config.lookup(settingName);
-	}catch(libconfig::SettingNotFoundException &e){
-			throw OptionNotFoundException(settingName);
+const ConfigValue &Settings::Reader::getSetting(std::string settingName) const{
+	const ConfigValue *setting = this->getSnapshot().find(settingName);
+	if (setting == NULL) {
+		throw OptionNotFoundException(settingName);
 	}
+	return *setting;
+}
+
+const ConfigValue &Settings::Reader::getOptions(std::string moduleName) const{
+	const ConfigValue *options = this->getSnapshot().find(moduleName);
+	return (options != NULL) ? *options : emptyGroup;
 }
 
 }
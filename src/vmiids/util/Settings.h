@@ -8,11 +8,17 @@
 #ifndef SETTINGS_H_
 #define SETTINGS_H_
 
-#include <libconfig.h++>
+#include <map>
+#include <set>
 #include <string>
 #include <sstream>
 
 #include "vmiids/util/Exception.h"
+#include "vmiids/util/ConfigValue.h"
+
+namespace libconfig {
+class Setting;
+}
 
 namespace vmi {
 
@@ -73,18 +79,125 @@ public:
  *
  * This Macro is used to read settings from within the different modules.
  * If the requested option is not found, a vmi::OptionNotFoundException is raised.
+ * The lookup does not take a lock. It runs in a temporary read section of the settings.
  */
-#define GETOPTION(option, variable) if(!vmi::Settings::getInstance()->getSetting(this->getName()).lookupValue(QUOTE(option),variable)){ \
+#define GETOPTION(option, variable) if(!vmi::Settings::Reader(*vmi::Settings::getInstance()).getOptions(this->getName()).lookupValue(QUOTE(option),variable)){ \
 	                                     throw vmi::OptionNotFoundException(this->getName(), QUOTE(option)); }
+/**
+ * Sections of the configuration, which changed on a reload, mapped to the names of their
+ * changed options. The option set is empty for sections, which are not groups.
+ */
+typedef std::map<std::string, std::set<std::string> > ChangedSettings;
+
 /**
  * @class Settings Settings.h "vmiids/util/Settings.h"
  * @brief Settings class
+ * @sa ConfigValue
  *
  * Settings class, provided to hide the external libconfig interface. The Settings class is a Singelon.
+ *
+ * The configuration file is parsed by libconfig and compiled into an immutable snapshot, a tree
+ * of typed ConfigValues, when it is loaded. The options of each section are resolved once.
+ * The snapshot is published through an atomic pointer, so lookups from any thread do not take
+ * a lock and never see libconfig objects, which are not safe for concurrent access.
+ *
+ * The configuration file can be reloaded while the framework runs. The new file is compiled into
+ * a separate snapshot, compared to the current one and swapped in, only if it could be parsed.
+ *
+ * Values are read inside a Reader, which keeps its snapshot valid. Readers announce themselves
+ * in one of two counters selected by the current epoch, as in the SnapshotRegistry. A reload
+ * flips the epoch twice and waits for both counters to drain, before it deletes the replaced
+ * snapshot. Values must not be used after their Reader is destroyed.
  */
 class Settings {
+public:
+	/**
+	 * @class Reader Settings.h "vmiids/util/Settings.h"
+	 * @brief Read section. The snapshot stays valid while the Reader exists.
+	 *
+	 * Several values read from the same Reader are consistent, even if the configuration
+	 * is reloaded meanwhile. A Reader must not be held, while reload() is called.
+	 */
+	class Reader {
+	private:
+		const Settings *settings;      //!< Settings read from.
+		unsigned int slot;             //!< Reader counter in use.
+		const ConfigValue *snapshot;   //!< Snapshot of the section.
+
+		Reader(const Reader&);
+		Reader& operator=(const Reader&);
+	public:
+		/**
+		 * Constructor. Enter the read section.
+		 * @param settings Settings to read.
+		 */
+		Reader(const Settings &settings) : settings(&settings) {
+			slot = settings.epoch & 1;
+			__sync_add_and_fetch(&this->settings->readers[slot], 1);
+			// Readers depend on the pointer loaded, which orders their reads after the
+			// initialization of the snapshot published by replaceSnapshot().
+			snapshot = settings.snapshot;
+		}
+		/**
+		 * Destructor. Leave the read section.
+		 */
+		~Reader(){
+			__sync_sub_and_fetch(&settings->readers[slot], 1);
+		}
+		/**
+		 * @return Root group of the snapshot.
+		 */
+		const ConfigValue &getSnapshot() const { return *snapshot; }
+		/**
+		 * Query an configuration option from the settings already parsed.
+		 *
+		 * @param settingName Name of the Setting
+		 * @return Typed representation of the setting.
+		 * @throws OptionNotFoundException, if the setting does not exist.
+		 */
+		const ConfigValue &getSetting(std::string settingName) const;
+		/**
+		 * Query the options of a module. It is advisable to use the GETOPTION() macro.
+		 *
+		 * @param moduleName Name of the module.
+		 * @return Options of the module. An empty group, if the section does not exist.
+		 */
+		const ConfigValue &getOptions(std::string moduleName) const;
+	};
+	friend class Reader;
+
 private:
-	libconfig::Config config; //<! External libconfig object;
+	const ConfigValue * volatile snapshot;  //!< Current snapshot. Never NULL.
+	std::string fileName;                   //!< File the current snapshot was read from.
+	mutable volatile unsigned int epoch;      //!< Selects the reader counter of new readers.
+	mutable volatile unsigned int readers[2]; //!< Number of readers in each epoch.
+	static const ConfigValue emptyGroup;    //!< Options of sections, which do not exist.
+
+	/**
+	 * Parse a configuration file and compile it into a snapshot.
+	 * @param filename File to parse.
+	 * @return Root of the snapshot. NULL, if the file could not be read or parsed.
+	 */
+	static const ConfigValue *parseConfigFile(std::string filename);
+	/**
+	 * Convert a libconfig setting, including its children.
+	 * @param setting Setting to convert.
+	 * @param value Value receiving the type and content of the setting.
+	 * @return value
+	 */
+	static ConfigValue *compile(const libconfig::Setting &setting, ConfigValue *value);
+	/**
+	 * Compare the sections of two snapshots.
+	 * @param oldSnapshot Current snapshot.
+	 * @param newSnapshot Snapshot to compare with.
+	 * @param changes Receives the changed, added and removed sections.
+	 */
+	static void diff(const ConfigValue &oldSnapshot, const ConfigValue &newSnapshot,
+			ChangedSettings &changes);
+	/**
+	 * Publish a new snapshot and delete the old one, once no reader uses it anymore.
+	 */
+	void replaceSnapshot(const ConfigValue *newSnapshot);
 
 	/**
 	 * Default Constructor
@@ -125,19 +238,19 @@ public:
 	bool openConfigFile(std::string filename);
 
 	/**
-	 * Returns an Instance of the singleton class Settings.
-	 * @return Instance of the singleton class Settings.
+	 * Reread the configuration file and swap it in. Must not be called concurrently.
+	 * Waits for the Readers of the replaced snapshot.
+	 *
+	 * @param changes Receives the sections, which changed, and their changed options.
+	 * @return False, if the file could not be parsed. The current configuration is kept.
 	 */
-	static Settings *getInstance();
+	bool reload(ChangedSettings &changes);
 
 	/**
-	 * Query an configuration option from the settings already parsed.
-	 * It is advisable to use the GETOPTION() macro.
-	 *
-	 * @param settingName Name of the Setting
-	 * @return Libconfig representation of the setting.
+	 * Returns an Instance of the singleton class Settings.
+	 * @return Instance of the singleton class Settings.
 	 */
-	libconfig::Setting &getSetting(std::string settingName);
+	static Settings *getInstance();
 };
 
 }
@@ -0,0 +1,272 @@
+/*
+ * SnapshotRegistry.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef SNAPSHOTREGISTRY_H_
+#define SNAPSHOTREGISTRY_H_
+
+#include "Mutex.h"
+#include "MutexLocker.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <sched.h>
+
+namespace vmi {
+
+/**
+ * @class SnapshotRegistry SnapshotRegistry.h "vmiids/util/SnapshotRegistry.h"
+ * @brief Read-mostly map with lock-free lookups.
+ * @sa Mutex
+ *
+ * The registry keeps its contents in an immutable snapshot, a vector of (key, value) pairs
+ * sorted by key. Readers access the current snapshot without taking a lock. Writers copy the
+ * snapshot, modify the copy and publish it with a single pointer exchange (RCU style).
+ * The old snapshot is released once all readers, which might still use it, have left.
+ *
+ * Readers announce themselves in one of two counters selected by the current epoch. A writer
+ * flips the epoch twice and waits for both counters to drain before releasing a snapshot.
+ * Writers are serialized by a mutex and are expected to be rare (module load and unload).
+ * A Writer publishes several changes as one snapshot, e.g. to move a value to another key.
+ *
+ * Values are not owned by the registry. A read section must not modify the same registry,
+ * as the writer would wait for the section to end.
+ */
+template <class Key, class T>
+class SnapshotRegistry {
+public:
+	typedef std::pair<Key, T *> Entry;          //!< Entry of the registry.
+	typedef std::vector<Entry> Entries;         //!< Sorted entries of a snapshot.
+
+	/**
+	 * @class Reader SnapshotRegistry.h "vmiids/util/SnapshotRegistry.h"
+	 * @brief Read section. The snapshot stays valid while the Reader exists.
+	 */
+	class Reader {
+	private:
+		const SnapshotRegistry *registry;  //!< Registry read from.
+		unsigned int slot;                 //!< Reader counter in use.
+		const Entries *entries;            //!< Snapshot of the section.
+
+		Reader(const Reader&);
+		Reader& operator=(const Reader&);
+	public:
+		/**
+		 * Constructor. Enter the read section.
+		 * @param registry Registry to read.
+		 */
+		Reader(const SnapshotRegistry &registry) : registry(&registry) {
+			slot = registry.epoch & 1;
+			__sync_add_and_fetch(&this->registry->readers[slot], 1);
+			entries = registry.current;
+		}
+		/**
+		 * Destructor. Leave the read section.
+		 */
+		~Reader(){
+			__sync_sub_and_fetch(&registry->readers[slot], 1);
+		}
+		/**
+		 * @return Entries of the snapshot. Sorted by key.
+		 */
+		const Entries &getEntries() const { return *entries; }
+		/**
+		 * Lookup a value.
+		 * @param key Key to search.
+		 * @return Value. NULL, if the key is not registered.
+		 */
+		T *find(const Key &key) const { return SnapshotRegistry::find(*entries, key); }
+	};
+
+	/**
+	 * @class Writer SnapshotRegistry.h "vmiids/util/SnapshotRegistry.h"
+	 * @brief Write section. Several changes are published as one snapshot.
+	 *
+	 * The Writer copies the current snapshot and blocks other writers until it is destroyed.
+	 * Changes are made to the copy and become visible to readers all at once by commit().
+	 * Changes, which are not committed, are discarded.
+	 */
+	class Writer {
+	private:
+		SnapshotRegistry *registry;        //!< Registry written to.
+		vmi::MutexLocker lock;             //!< Lock of the writerMutex.
+		Entries *entries;                  //!< Copy of the snapshot. NULL once committed.
+
+		Writer(const Writer&);
+		Writer& operator=(const Writer&);
+	public:
+		/**
+		 * Constructor. Enter the write section.
+		 * @param registry Registry to modify.
+		 */
+		Writer(SnapshotRegistry &registry) :
+			registry(&registry), lock(&registry.writerMutex), entries(new Entries(*registry.current)) {
+		}
+		/**
+		 * Destructor. Leave the write section and discard changes, which were not committed.
+		 */
+		~Writer(){
+			delete entries;
+		}
+		/**
+		 * @return Entries of the modified snapshot. Sorted by key.
+		 */
+		const Entries &getEntries() const { return *entries; }
+		/**
+		 * Lookup a value in the modified snapshot.
+		 * @param key Key to search.
+		 * @return Value. NULL, if the key is not registered.
+		 */
+		T *find(const Key &key) const { return SnapshotRegistry::find(*entries, key); }
+		/**
+		 * Insert or replace a value.
+		 * @param key Key of the value.
+		 * @param value Value to insert.
+		 */
+		void insert(const Key &key, T *value){
+			typename Entries::iterator it = std::lower_bound(entries->begin(), entries->end(), key, lessKey);
+			if (it != entries->end() && !(key < it->first)) {
+				it->second = value;
+			} else {
+				entries->insert(it, Entry(key, value));
+			}
+		}
+		/**
+		 * Remove a value.
+		 * @param key Key of the value.
+		 * @param value If not NULL, the entry is only removed, if it still refers to this value.
+		 * @return True, if an entry was removed.
+		 */
+		bool erase(const Key &key, T *value = NULL){
+			typename Entries::iterator it = std::lower_bound(entries->begin(), entries->end(), key, lessKey);
+			if (it == entries->end() || key < it->first || (value != NULL && it->second != value)) {
+				return false;
+			}
+			entries->erase(it);
+			return true;
+		}
+		/**
+		 * Publish all changes as one snapshot.
+		 * When the function returns, no reader uses the previous snapshot anymore.
+		 * The Writer must not be used afterwards.
+		 */
+		void commit(){
+			registry->publish(entries);
+			entries = NULL;
+		}
+	};
+
+private:
+	Entries * volatile current;               //!< Current snapshot.
+	mutable volatile unsigned int epoch;      //!< Selects the reader counter of new readers.
+	mutable volatile unsigned int readers[2]; //!< Number of readers in each epoch.
+	vmi::Mutex writerMutex;                   //!< Serializes writers.
+
+	SnapshotRegistry(const SnapshotRegistry&);
+	SnapshotRegistry& operator=(const SnapshotRegistry&);
+
+	/**
+	 * Compare entries by key.
+	 */
+	static bool lessKey(const Entry &entry, const Key &key){
+		return entry.first < key;
+	}
+
+	/**
+	 * Binary search in a sorted snapshot.
+	 */
+	static T *find(const Entries &entries, const Key &key){
+		typename Entries::const_iterator it = std::lower_bound(entries.begin(), entries.end(), key, lessKey);
+		if (it == entries.end() || key < it->first) return NULL;
+		return it->second;
+	}
+
+	/**
+	 * Publish a new snapshot and release the old one, once no reader uses it anymore.
+	 * Must be called with the writerMutex held.
+	 */
+	void publish(Entries *entries){
+		Entries *old = __sync_lock_test_and_set(&current, entries);
+		for (int flip = 0; flip < 2; flip++) {
+			unsigned int slot = epoch & 1;
+			__sync_add_and_fetch(&epoch, 1);
+			while (readers[slot] != 0) {
+				sched_yield();
+			}
+		}
+		delete old;
+	}
+
+public:
+	/**
+	 * Constructor. Creates an empty registry.
+	 */
+	SnapshotRegistry(){
+		current = new Entries();
+		epoch = 0;
+		readers[0] = 0;
+		readers[1] = 0;
+	}
+	/**
+	 * Destructor. Values are not deleted.
+	 */
+	virtual ~SnapshotRegistry(){
+		delete current;
+	}
+
+	/**
+	 * Lookup a value. Lock-free.
+	 * @param key Key to search.
+	 * @return Value. NULL, if the key is not registered. The caller must make sure the
+	 *         value is not deleted while it is used.
+	 */
+	T *find(const Key &key) const {
+		Reader reader(*this);
+		return reader.find(key);
+	}
+
+	/**
+	 * @return Number of entries. Lock-free.
+	 */
+	size_t size() const {
+		Reader reader(*this);
+		return reader.getEntries().size();
+	}
+
+	/**
+	 * Insert or replace a value.
+	 * @param key Key of the value.
+	 * @param value Value to insert.
+	 */
+	void insert(const Key &key, T *value){
+		Writer writer(*this);
+		writer.insert(key, value);
+		writer.commit();
+	}
+
+	/**
+	 * Remove a value.
+	 * When the function returns, no reader uses the value anymore.
+	 *
+	 * @param key Key of the value.
+	 * @param value If not NULL, the entry is only removed, if it still refers to this value.
+	 * @return True, if an entry was removed.
+	 */
+	bool erase(const Key &key, T *value = NULL){
+		Writer writer(*this);
+		if (!writer.erase(key, value)) {
+			return false;
+		}
+		writer.commit();
+		return true;
+	}
+};
+
+}
+
+#endif /* SNAPSHOTREGISTRY_H_ */
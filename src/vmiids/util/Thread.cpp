@@ -10,5 +10,7 @@
 namespace vmi {
 
 void (*Thread::defaultExceptionHandler)(std::exception&) = NULL;
+__thread uint32_t Thread::currentRunId = 0;
+volatile uint32_t Thread::lastRunId = 0;
 
 }
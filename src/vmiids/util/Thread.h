@@ -11,6 +11,7 @@
 #include <pthread.h>
 #include <time.h>
 #include <exception>
+#include <stdint.h>
 
 namespace vmi {
 
@@ -26,6 +27,11 @@ namespace vmi {
  * started by calling the start() function.
  *
  * Equivalent to QTs QThread.
+ *
+ * Each thread carries a run ID, which tags all notifications created by the thread.
+ * A new thread inherits the run ID of the thread calling start(). A scheduler creates a
+ * fresh run ID with createRunId() before starting a detection module, so all output
+ * of one execution, including the output of its helper threads, shares one run ID.
  */
 class Thread {
 private:
@@ -35,6 +41,11 @@ private:
 	static void (*defaultExceptionHandler)(std::exception&);  //!< Default function called, when an exception within the thread is not caught.
 	void (*exceptionHandler)(std::exception&);        //!< Function called, when an exception within the thread is not caught.
 
+	uint32_t runId;  //!< Run ID passed to the thread on start().
+	volatile bool failed;  //!< True, if the last run was aborted by an exception.
+	static __thread uint32_t currentRunId;  //!< Run ID of the current thread.
+	static volatile uint32_t lastRunId;     //!< Last run ID created.
+
 	/**
 	 * Start the thread and catch any exceptions thrown.
 	 * If set, call an exception handler.
@@ -44,9 +55,11 @@ private:
 	static void* __runThread(void* ptr){
 		Thread *this_p = (Thread *) ptr;
 		pthread_mutex_lock(&this_p->__threadMutex);
+		currentRunId = this_p->runId;
 		try {
 			this_p->run();
 		} catch (std::exception &e) {
+			this_p->failed = true;
 			if(this_p->exceptionHandler != NULL){
 				this_p->exceptionHandler(e);
 			}else{
@@ -67,6 +80,8 @@ public:
 	 */
 	Thread(){
 		exceptionHandler = NULL;
+		runId = 0;
+		failed = false;
 		pthread_mutex_init(&__threadMutex, NULL);
 	}
 	/**
@@ -103,10 +118,19 @@ public:
 	 * Causes this thread to begin execution; the Thread class calls the run method of this thread.
 	 */
 	void start(void){
+		runId = currentRunId;
+		failed = false;
 		pthread_create(&__thisThread, NULL, Thread::__runThread,
 					(void*) this);
 	}
 
+	/**
+	 * @return True, if the last run was aborted by an exception, which was not caught by run().
+	 */
+	bool hasFailed() const {
+		return failed;
+	}
+
 	/**
 	 * Sleep millis milli seconds.
 	 *
@@ -123,6 +147,34 @@ public:
 		return;
 	}
 
+	/**
+	 * Create a new, unique run ID.
+	 *
+	 * @return New run ID. Never zero.
+	 */
+	static uint32_t createRunId(){
+		uint32_t id;
+		while ((id = __sync_add_and_fetch(&lastRunId, 1)) == 0)
+			continue;
+		return id;
+	}
+
+	/**
+	 * @return Run ID of the calling thread. Zero, if the thread does not belong to a run.
+	 */
+	static uint32_t getCurrentRunId(){
+		return currentRunId;
+	}
+
+	/**
+	 * Set the run ID of the calling thread. Threads started afterwards inherit it.
+	 *
+	 * @param id Run ID. Zero, if the thread does not belong to a run.
+	 */
+	static void setCurrentRunId(uint32_t id){
+		currentRunId = id;
+	}
+
 	/**
 	 * Set the default handler for uncaught exceptions.
 	 * The function is called if a thread does not catch a thrown exception and no thread specific handler was set.
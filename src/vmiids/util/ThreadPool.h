@@ -0,0 +1,201 @@
+/*
+ * ThreadPool.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: kittel
+ */
+
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include "Thread.h"
+#include "MutexLocker.h"
+
+#include <pthread.h>
+#include <exception>
+#include <deque>
+#include <vector>
+
+namespace vmi {
+
+/**
+ * @class ThreadPool ThreadPool.h "vmiids/util/ThreadPool.h"
+ * @brief Fixed size pool of worker threads.
+ * @sa Thread
+ *
+ * Convenience class to run independent pieces of work in parallel.
+ *
+ * Work is described by subclasses of ThreadPool::Task. A task is enqueued with submit()
+ * and executed by the next idle worker. The pool does not take ownership of the task,
+ * the caller must keep it alive until it has been run. waitForAll() blocks until every
+ * submitted task has finished.
+ *
+ * Exceptions thrown by a task are caught by the worker, so a single failing task does not
+ * terminate the worker. The number of failed tasks is available through getFailedTaskCount().
+ */
+class ThreadPool {
+public:
+	/**
+	 * @class Task ThreadPool.h "vmiids/util/ThreadPool.h"
+	 * @brief Unit of work executed by a ThreadPool.
+	 */
+	class Task {
+	public:
+		/**
+		 * Destructor
+		 */
+		virtual ~Task(){}
+		/**
+		 * Tasks main function. Reimplement to create own Task.
+		 */
+		virtual void run(void) = 0;
+	};
+
+private:
+	/**
+	 * Worker thread. Runs tasks until the pool is destroyed.
+	 */
+	class Worker : public Thread {
+	private:
+		ThreadPool *pool;  //!< Pool to fetch tasks from.
+	public:
+		Worker(ThreadPool *pool) : pool(pool) {}
+		virtual void run(void){
+			Task *task;
+			while ((task = pool->nextTask()) != NULL) {
+				bool failed = false;
+				try {
+					task->run();
+				} catch (std::exception &e) {
+					failed = true;
+				}
+				pool->taskFinished(failed);
+			}
+		}
+	};
+
+	std::vector<Worker *> workers;  //!< All worker threads of the pool.
+	std::deque<Task *> tasks;       //!< Tasks waiting to be executed.
+	size_t activeTasks;             //!< Number of tasks currently executed.
+	size_t failedTasks;             //!< Number of tasks that threw an exception.
+	bool stopping;                  //!< Flag, whether the pool is being destroyed.
+
+	pthread_mutex_t poolMutex;      //!< Mutex protecting the pool state.
+	pthread_cond_t taskAvailable;   //!< Signaled when a task was enqueued or the pool is stopped.
+	pthread_cond_t allTasksDone;    //!< Signaled when the last running task finished.
+
+	/**
+	 * Private copy constructor. Workers reference the pool.
+	 */
+	ThreadPool(const ThreadPool&);
+	/**
+	 * Private copy operator. Workers reference the pool.
+	 */
+	ThreadPool& operator=(const ThreadPool&);
+
+	/**
+	 * Block until a task is available.
+	 * @return Next task to run. NULL, if the pool is stopped.
+	 */
+	Task *nextTask(){
+		vmi::MutexLocker lock(&poolMutex);
+		while (tasks.empty() && !stopping) {
+			pthread_cond_wait(&taskAvailable, &poolMutex);
+		}
+		if (tasks.empty()) return NULL;
+		Task *task = tasks.front();
+		tasks.pop_front();
+		activeTasks++;
+		return task;
+	}
+
+	/**
+	 * Called by a worker after a task was run.
+	 * @param failed Flag, whether the task threw an exception.
+	 */
+	void taskFinished(bool failed){
+		vmi::MutexLocker lock(&poolMutex);
+		activeTasks--;
+		if (failed) failedTasks++;
+		if (tasks.empty() && activeTasks == 0) {
+			pthread_cond_broadcast(&allTasksDone);
+		}
+	}
+
+public:
+	/**
+	 * Constructor. Starts the worker threads.
+	 *
+	 * @param threadCount Number of worker threads. At least one worker is started.
+	 */
+	ThreadPool(size_t threadCount){
+		activeTasks = 0;
+		failedTasks = 0;
+		stopping = false;
+		pthread_mutex_init(&poolMutex, NULL);
+		pthread_cond_init(&taskAvailable, NULL);
+		pthread_cond_init(&allTasksDone, NULL);
+
+		if (threadCount == 0) threadCount = 1;
+		for (size_t i = 0; i < threadCount; i++) {
+			workers.push_back(new Worker(this));
+			workers.back()->start();
+		}
+	}
+	/**
+	 * Destructor. Waits for all tasks to finish and stops the workers.
+	 */
+	virtual ~ThreadPool(){
+		waitForAll();
+		pthread_mutex_lock(&poolMutex);
+		stopping = true;
+		pthread_cond_broadcast(&taskAvailable);
+		pthread_mutex_unlock(&poolMutex);
+
+		for (std::vector<Worker *>::iterator it = workers.begin(); it != workers.end(); ++it) {
+			(*it)->join();
+			delete *it;
+		}
+		pthread_cond_destroy(&allTasksDone);
+		pthread_cond_destroy(&taskAvailable);
+		pthread_mutex_destroy(&poolMutex);
+	}
+
+	/**
+	 * Enqueue a task. The task is run by the next idle worker.
+	 *
+	 * @param task Task to run. Must stay valid until it was run.
+	 */
+	void submit(Task *task){
+		vmi::MutexLocker lock(&poolMutex);
+		tasks.push_back(task);
+		pthread_cond_signal(&taskAvailable);
+	}
+
+	/**
+	 * Block until all submitted tasks have finished.
+	 */
+	void waitForAll(){
+		vmi::MutexLocker lock(&poolMutex);
+		while (!tasks.empty() || activeTasks > 0) {
+			pthread_cond_wait(&allTasksDone, &poolMutex);
+		}
+	}
+
+	/**
+	 * @return Number of worker threads.
+	 */
+	size_t getThreadCount() const { return workers.size(); }
+
+	/**
+	 * @return Number of tasks that threw an exception since construction.
+	 */
+	size_t getFailedTaskCount(){
+		vmi::MutexLocker lock(&poolMutex);
+		return failedTasks;
+	}
+};
+
+}
+
+#endif /* THREADPOOL_H_ */